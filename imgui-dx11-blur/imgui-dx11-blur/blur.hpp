@@ -5,10 +5,28 @@
 #include <d3dcompiler.h>
 #include <imgui.h>
 #include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
 
 #undef min
 #undef max
 
+#include "blur_atlas.hpp"
+#include "blur_device_cache.hpp"
+#include "blur_hash.hpp"
+#include "blur_kernel.hpp"
+#include "blur_pool.hpp"
+#include "blur_profiler.hpp"
+#include "blur_schedule.hpp"
+#include "blur_shader_cache.hpp"
+#include "blur_shaders.hpp"
+#include "blur_stats.hpp"
+#include "blur_tiles.hpp"
+#include "blur_trace.hpp"
+
 namespace blur {
 
     struct blur_params {
@@ -19,128 +37,553 @@ namespace blur {
         float blur_strength = 0.95f;
         float corner_radius = 6.0f;
         double delay_time = 0.15;
+        int blur_radius = default_kernel_radius;
+        float blur_sigma = 0.0f;
+        kernel_sampling sampling = kernel_sampling::discrete;
+        blur_mode mode = blur_mode::gaussian;
+        bool use_compute = false;
+        int downsample = 1;
+        bool live = false;              // recapture while blurring instead of freezing the first capture
+        int refresh_interval = 1;       // live: frames between recaptures
+        double gpu_budget_ms = 0.0;     // live: average GPU time per frame for recaptures, 0 for no limit
+        bool detect_changes = false;    // live: skip recaptures while the draw commands beneath are unchanged
+        int dirty_tile_size = 0;        // detect_changes: > 0 recaptures and reblurs only the changed tiles
+        float change_threshold = 0.0f;  // > 0: skip the blur unless a texel channel moved by more than this (0..1);
+                                        // the blur is then always whole, so dirty_tile_size only narrows the capture
+        ImGuiID region_id = 0;          // identifies the blurred region across frames, 0 to use draw_list
+        bool shared_backdrop = false;   // sample one blur of the whole display instead of blurring this window
     };
 
     struct blur_constants {
         float texture_size[2];
-        float blur_strength;
-        float padding;
+        int downsample_factor;          // downsample pass only
+        int tap_count;                  // blur passes and compute: entries of taps in use
+        kernel_tap taps[max_table_taps];
+        int region[4];                  // compute: target origin and size in the blur atlas
+        int source_origin[4];           // compute: the region's origin in the source texture
     };
 
+    static_assert(sizeof(blur_constants) == 48 + 16 * max_table_taps, "blur_constants must match the BlurConstants cbuffer");
+
     struct vertex {
         float position[3];
         float uv[2];
     };
 
+    // One region in one pass, read by shaders::vertex_source as per-instance data. The pixel shaders read the union
+    // under the name of their pass's member.
+    struct region_instance {
+        float target_rect[4];
+        float source_rect[4];
+        float uv_clamp[4];
+        union {
+            float blur_strength;        // blur, Kawase and pyramid down passes: tap spacing in source texels
+            float lod;                  // pyramid resolve: fractional level to sample
+            float threshold;            // change test: largest channel difference still counted as unchanged
+        };
+        float padding[3];
+    };
+
+    struct render_target {
+        ID3D11Texture2D* texture = nullptr;
+        ID3D11RenderTargetView* rtv = nullptr;
+        ID3D11ShaderResourceView* srv = nullptr;
+        ID3D11UnorderedAccessView* uav = nullptr;
+        int width = 0;
+        int height = 0;
+    };
+
+    // texture_pool allocator for the renderer's R8G8B8A8 targets; views are created to match the bind flags.
+    struct d3d_texture_allocator {
+        using resource = render_target;
+
+        ID3D11Device* device = nullptr;
+        stats::frame_profiler* profiler = nullptr;
+
+        bool create(int width, int height, unsigned bind_flags, render_target& out) {
+            if (!device) return false;
+
+            D3D11_TEXTURE2D_DESC desc = {};
+            desc.Width = width;
+            desc.Height = height;
+            desc.MipLevels = 1;
+            desc.ArraySize = 1;
+            desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+            desc.SampleDesc.Count = 1;
+            desc.Usage = D3D11_USAGE_DEFAULT;
+            desc.BindFlags = bind_flags;
+
+            out.width = width;
+            out.height = height;
+            if (profiler) {
+                uint64_t calls = 1 + ((bind_flags & D3D11_BIND_RENDER_TARGET) != 0) +
+                    ((bind_flags & D3D11_BIND_SHADER_RESOURCE) != 0) + ((bind_flags & D3D11_BIND_UNORDERED_ACCESS) != 0);
+                profiler->count(stats::counter::d3d_calls, calls);
+                profiler->count(stats::counter::resources_created, calls);
+            }
+            if (FAILED(device->CreateTexture2D(&desc, nullptr, &out.texture))) return false;
+            if (profiler) {
+                profiler->count(stats::counter::textures_created);
+                profiler->count(stats::counter::bytes_allocated, static_cast<uint64_t>(width) * height * 4);
+            }
+            if ((bind_flags & D3D11_BIND_RENDER_TARGET) && FAILED(device->CreateRenderTargetView(out.texture, nullptr, &out.rtv))) return false;
+            if ((bind_flags & D3D11_BIND_SHADER_RESOURCE) && FAILED(device->CreateShaderResourceView(out.texture, nullptr, &out.srv))) return false;
+            if ((bind_flags & D3D11_BIND_UNORDERED_ACCESS) && FAILED(device->CreateUnorderedAccessView(out.texture, nullptr, &out.uav))) return false;
+            return true;
+        }
+
+        void destroy(render_target& target) {
+            if (target.texture) target.texture->Release();
+            if (target.rtv) target.rtv->Release();
+            if (target.srv) target.srv->Release();
+            if (target.uav) target.uav->Release();
+            target = {};
+        }
+
+        bool same(const render_target& a, const render_target& b) const { return a.texture == b.texture; }
+    };
+
+    // stats::timestamp_ring source over D3D11 queries, created on first use and reused for as long as the device.
+    struct d3d_timestamp_source {
+        ID3D11Device* device = nullptr;
+        ID3D11DeviceContext* context = nullptr;
+        stats::frame_profiler* profiler = nullptr;
+        ID3D11Query* disjoint[stats::timestamp_frames] = {};
+        ID3D11Query* timestamps[stats::timestamp_frames][stats::max_frame_timestamps] = {};
+        bool failed = false;
+
+        bool available() const { return device && context && !failed; }
+
+        void count_call() {
+            if (profiler) profiler->count(stats::counter::d3d_calls);
+        }
+
+        bool create(D3D11_QUERY type, ID3D11Query*& query) {
+            if (query) return true;
+
+            count_call();
+            if (profiler) profiler->count(stats::counter::resources_created);
+            D3D11_QUERY_DESC desc = {};
+            desc.Query = type;
+            if (SUCCEEDED(device->CreateQuery(&desc, &query))) return true;
+            query = nullptr;
+            return false;
+        }
+
+        bool begin_frame(int slot) {
+            if (!create(D3D11_QUERY_TIMESTAMP_DISJOINT, disjoint[slot])) {
+                failed = true;
+                return false;
+            }
+            count_call();
+            context->Begin(disjoint[slot]);
+            return true;
+        }
+
+        bool timestamp(int slot, int index) {
+            ID3D11Query*& query = timestamps[slot][index];
+            if (!create(D3D11_QUERY_TIMESTAMP, query)) return false;
+            count_call();
+            context->End(query);
+            return true;
+        }
+
+        void end_frame(int slot) {
+            count_call();
+            context->End(disjoint[slot]);
+        }
+
+        // Queries that could not be created read as 0; the ring ignores their ranges.
+        bool read(int slot, int count, uint64_t* ticks, uint64_t& frequency, bool& is_disjoint) {
+            D3D11_QUERY_DATA_TIMESTAMP_DISJOINT data;
+            count_call();
+            if (context->GetData(disjoint[slot], &data, sizeof(data), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK) return false;
+
+            for (int i = 0; i < count; i++) {
+                UINT64 value = 0;
+                ID3D11Query* query = timestamps[slot][i];
+                if (query) count_call();
+                if (query && context->GetData(query, &value, sizeof(value), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK) return false;
+                ticks[i] = value;
+            }
+            frequency = data.Frequency;
+            is_disjoint = data.Disjoint != FALSE;
+            return true;
+        }
+
+        void release() {
+            for (int slot = 0; slot < stats::timestamp_frames; slot++) {
+                if (disjoint[slot]) { disjoint[slot]->Release(); disjoint[slot] = nullptr; }
+                for (ID3D11Query*& query : timestamps[slot]) {
+                    if (query) { query->Release(); query = nullptr; }
+                }
+            }
+            failed = false;
+        }
+    };
+
+    // Work done inside RenderDrawData for one frame; passes counts draws and dispatches.
+    struct frame_counters {
+        int captures = 0;
+        int passes = 0;
+    };
+
+    // Outcomes of predicated change tests, read back a frame or more late without ever waiting on the GPU.
+    struct change_test_stats {
+        uint64_t tests = 0;
+        uint64_t changed = 0;
+        uint64_t unchanged = 0;
+    };
+
+    // A full mip chain with views per level, and one SRV over every level for SampleLevel.
+    struct mip_chain {
+        ID3D11Texture2D* texture = nullptr;
+        ID3D11ShaderResourceView* srv = nullptr;
+        ID3D11RenderTargetView* level_rtvs[max_pyramid_levels] = {};
+        ID3D11ShaderResourceView* level_srvs[max_pyramid_levels] = {};
+        int width = 0;
+        int height = 0;
+        int levels = 0;
+    };
+
+    constexpr int max_blur_regions = 64;
+    constexpr int max_pass_instances = max_blur_regions * max_dirty_rects;
+    constexpr int region_idle_frames = 60;
+
+    // Everything that does not depend on window sizes, shared by the renderers on one device. The buffers are
+    // only mapped with WRITE_DISCARD right before a pass, so sharing them is safe.
+    struct pipeline {
+        ID3D11VertexShader* vertex_shader = nullptr;
+        ID3D11PixelShader* pixel_shader_horizontal = nullptr;
+        ID3D11PixelShader* pixel_shader_vertical = nullptr;
+        ID3D11PixelShader* pixel_shader_kawase_down = nullptr;
+        ID3D11PixelShader* pixel_shader_kawase_up = nullptr;
+        ID3D11PixelShader* pixel_shader_downsample = nullptr;
+        ID3D11PixelShader* pixel_shader_pyramid_down = nullptr;
+        ID3D11PixelShader* pixel_shader_pyramid_resolve = nullptr;
+        ID3D11PixelShader* pixel_shader_change_test = nullptr;
+        ID3D11ComputeShader* compute_shader_blur = nullptr;     // null below feature level 11_0
+        ID3D11Buffer* vertex_buffer = nullptr;
+        ID3D11Buffer* instance_buffer = nullptr;
+        ID3D11Buffer* constant_buffer = nullptr;
+        ID3D11InputLayout* input_layout = nullptr;
+        ID3D11SamplerState* sampler_state = nullptr;
+        ID3D11BlendState* blend_state = nullptr;
+        ID3D11BlendState* no_write_blend_state = nullptr;
+        ID3D11RasterizerState* rasterizer_state = nullptr;
+    };
+
+    class blur_renderer;
+
+    // device_cache builder for pipelines; creation goes through the renderer, which owns the shader cache.
+    struct d3d_pipeline_builder {
+        using device = ID3D11Device;
+        using value = pipeline;
+
+        blur_renderer* renderer = nullptr;
+
+        bool create(ID3D11Device* device, pipeline& out);
+
+        void destroy(pipeline& p) {
+            IUnknown* objects[] = {
+                p.vertex_shader, p.pixel_shader_horizontal, p.pixel_shader_vertical, p.pixel_shader_kawase_down,
+                p.pixel_shader_kawase_up, p.pixel_shader_downsample, p.pixel_shader_pyramid_down, p.pixel_shader_pyramid_resolve,
+                p.pixel_shader_change_test, p.compute_shader_blur, p.vertex_buffer, p.instance_buffer, p.constant_buffer,
+                p.input_layout, p.sampler_state, p.blend_state, p.no_write_blend_state, p.rasterizer_state,
+            };
+            for (IUnknown* object : objects) {
+                if (object) object->Release();
+            }
+            p = {};
+        }
+    };
+
+    using pipeline_cache = device_cache<d3d_pipeline_builder>;
+
+    // Shared by every renderer without shader defines; lives as long as the last of them.
+    inline std::shared_ptr<pipeline_cache> shared_pipelines() {
+        static std::weak_ptr<pipeline_cache> shared;
+        std::shared_ptr<pipeline_cache> cache = shared.lock();
+        if (!cache) {
+            cache = std::make_shared<pipeline_cache>();
+            shared = cache;
+        }
+        return cache;
+    }
+
+    // A blurred window. Its capture and its blurred image live at capture_rect and blur_rect of the shared atlases.
+    struct blur_region {
+        blur_renderer* renderer = nullptr;
+        uintptr_t key = 0;
+        bool active = false;
+        int last_frame = 0;
+        int width = 0;
+        int height = 0;
+        int downsample = 1;
+        int alignment = default_atlas_alignment;
+        bool placed = false;
+        atlas_rect capture_rect;
+        atlas_rect blur_rect;
+        capture_schedule schedule;
+        change_detector content;        // what lay beneath at the last capture
+        tile_tracker tiles;
+        atlas_rect dirty_rects[max_dirty_rects];
+        int dirty_count = -1;           // rects of the region recaptured by this capture, -1 for all of it
+        bool reference_valid = false;   // the reference atlas holds this region's last blurred capture
+        bool test_pending = false;      // a change test result has not been read back yet
+        blur_params params = {};
+        bool queued = false;            // captured this frame, waiting for the blur callback
+        bool blurred = false;
+        bool captures = true;           // false for pyramid windows, which only need a blur atlas slot
+        float pyramid_lod = 0.0f;
+        int resolve_frame = -1;         // pyramid windows: frame whose backdrop callback resolves them
+    };
+
     class blur_renderer {
     private:
         ID3D11Device* device_ = nullptr;
         ID3D11DeviceContext* context_ = nullptr;
 
-        ID3D11VertexShader* vertex_shader_ = nullptr;
-        ID3D11PixelShader* pixel_shader_horizontal_ = nullptr;
-        ID3D11PixelShader* pixel_shader_vertical_ = nullptr;
-        ID3D11Buffer* vertex_buffer_ = nullptr;
-        ID3D11Buffer* constant_buffer_ = nullptr;
-        ID3D11InputLayout* input_layout_ = nullptr;
-        ID3D11SamplerState* sampler_state_ = nullptr;
-        ID3D11BlendState* blend_state_ = nullptr;
-        ID3D11RasterizerState* rasterizer_state_ = nullptr;
-
-        ID3D11Texture2D* background_capture_ = nullptr;
-        ID3D11ShaderResourceView* background_srv_ = nullptr;
-        ID3D11Texture2D* temp_texture_ = nullptr;
-        ID3D11RenderTargetView* temp_rtv_ = nullptr;
-        ID3D11ShaderResourceView* temp_srv_ = nullptr;
-        ID3D11Texture2D* blur_texture_ = nullptr;
-        ID3D11RenderTargetView* blur_rtv_ = nullptr;
-        ID3D11ShaderResourceView* blur_srv_ = nullptr;
-
-        int width_ = 0;
-        int height_ = 0;
+        const pipeline* pipeline_ = nullptr;   // pipelines_' entry for device_
+        std::shared_ptr<pipeline_cache> pipelines_;
+        friend struct d3d_pipeline_builder;
+        ID3D11Predicate* change_predicates_[max_blur_regions] = {};
+        stats::timestamp_ring<d3d_timestamp_source> timestamps_;
+
+        texture_pool<d3d_texture_allocator> texture_pool_;
+        render_target capture_target_;
+        render_target reference_target_;
+        render_target temp_target_;
+        render_target blur_target_;
+        std::vector<render_target> kawase_levels_;
+        mip_chain pyramid_;
+
+        shader_cache* shader_cache_ = nullptr;
+        std::vector<shader_macro> shader_defines_;
+
+        // Captures at full size, blurred images at their reduced size; temp and Kawase levels use the blur layout.
+        blur_region regions_[max_blur_regions];
+        atlas_layout capture_layout_;
+        atlas_layout blur_layout_;
+        atlas_rect layout_sizes_[max_blur_regions];
+        atlas_rect layout_rects_[max_blur_regions];
+        int blur_queue_[max_blur_regions] = {};
+        region_instance instances_[max_pass_instances] = {};
+        int instance_count_ = 0;
+
+        int capture_width_ = 0;
+        int capture_height_ = 0;
+        int blur_width_ = 0;
+        int blur_height_ = 0;
         bool initialized_ = false;
-        bool background_captured_ = false;
-        bool blur_processed_ = false;
-        bool blur_enabled_last_frame_ = false;
-        double blur_enable_time_ = 0.0;
-        bool blur_capture_pending_ = false;
-
-        bool initialize_shaders();
-        bool initialize_render_states();
-        bool ensure_render_targets(int width, int height);
-        bool capture_background(ImVec2 window_pos, ImVec2 window_size);
-        bool process_blur(float blur_strength);
-        void reset_state();
+        bool repack_needed_ = false;
+        int current_frame_ = -1;
+        double frame_time_ = 0.0;
+        bool frame_used_ = false;       // a callback or image of this frame already refers to the atlas layout
+        int live_frame_ = -1;
+        bool live_refresh_ = false;
+        int backdrop_frame_ = -1;
+        bool backdrop_scheduled_ = false;
+        frame_counters counters_;
+        uint64_t dirty_generation_ = 0;
+        change_stats change_stats_;
+        change_test_stats change_test_stats_;
+        frame_counters last_counters_;
+        refresh_policy refresh_policy_;
+        stats::gpu_timings gpu_stats_;
+        std::vector<stats::gpu_range> gpu_ranges_;
+        stats::frame_profiler profiler_;
+        uint64_t timestamps_lost_ = 0;
+        int composite_timestamp_ = -1;
+        double gpu_time_ms_ = 0.0;
+
+        bool load_shader_bytecode(shader_id id, shader_bytecode& bytecode, ID3DBlob** compiled);
+        bool initialize_shaders(pipeline& out);
+        bool initialize_render_states(pipeline& out);
+        bool ensure_render_targets(int capture_width, int capture_height, int blur_width, int blur_height);
+        bool ensure_kawase_levels(int iterations);
+        void begin_frame(int frame);
+        blur_region* find_region(uintptr_t key);
+        void update_region(blur_region& region, int width, int height, const blur_params& params);
+        bool render_backdrop(const blur_params& params, bool should_blur);
+        bool composite_pyramid(const blur_params& params, const blur_region& backdrop);
+        void schedule_backdrop_callback();
+        bool ensure_pyramid(int width, int height);
+        void release_pyramid();
+        bool place_region(blur_region& region);
+        bool repack_regions();
+        bool pack_layout(atlas_layout& layout, int count, int alignment, int& width, int& height);
+        void invalidate_regions();
+        bool live_refresh(const blur_params& params);
+        bool capture_background(ImVec2 window_pos, ImVec2 window_size, const atlas_rect& rect);
+        bool update_constants(int texture_width, int texture_height, const kernel_table* table, int downsample_factor = 0,
+            const atlas_rect& region = {}, const atlas_rect& source = {});
+        region_instance* add_instance(const atlas_rect& target, int target_width, int target_height, const atlas_rect& source,
+            const atlas_rect& bounds, int source_width, int source_height, float blur_strength = 0.0f);
+        bool draw_pass(stats::stage stage, ID3D11PixelShader* shader, ID3D11ShaderResourceView* source, ID3D11RenderTargetView* target,
+            int width, int height);
+        bool cancel_pass() {
+            instance_count_ = 0;
+            return false;
+        }
+        void add_composite(ImDrawList* draw_list, const ImVec2& p_min, const ImVec2& p_max, const ImVec2& uv_min, const ImVec2& uv_max,
+            float corner_radius);
+        void process_blur(bool backdrop);
+        void finish_blur(const int* indices, int count, bool blurred);
+        ID3D11ShaderResourceView* reduce_regions(ID3D11RenderTargetView* target, ID3D11ShaderResourceView* target_srv,
+            const int* indices, int count);
+        bool process_gaussian(int* indices, int count);
+        int process_gaussian_compute(const kernel_table& table, int* indices, int count);
+        bool process_dual_kawase(const int* indices, int count);
+        bool process_pyramid(const blur_region& region);
+        bool begin_change_test(blur_region& region);
+        void end_change_test(blur_region& region, bool predicated);
+        void collect_change_tests();
+        void resolve_pyramid();
+        void collect_gpu_timing();
+        static void capture_callback(const ImDrawList* parent_list, const ImDrawCmd* cmd);
+        uint64_t params_hash(const blur_region& region) const;
+        bool content_hash(const blur_region& region, const ImDrawList* parent_list, const ImDrawCmd* cmd, uint64_t& hash);
+        bool content_tiles(blur_region& region, const ImDrawList* parent_list, const ImDrawCmd* cmd);
+        bool content_changed(blur_region& region, const ImDrawList* parent_list, const ImDrawCmd* cmd);
+        static void blur_callback(const ImDrawList* parent_list, const ImDrawCmd* cmd);
+        static void backdrop_callback(const ImDrawList* parent_list, const ImDrawCmd* cmd);
+        static void composite_begin_callback(const ImDrawList* parent_list, const ImDrawCmd* cmd);
+        static void composite_end_callback(const ImDrawList* parent_list, const ImDrawCmd* cmd);
         void cleanup_render_targets();
-        void cleanup_all();
-
-        static constexpr const char* vertex_shader_source_ = R"(
-        struct VS_INPUT { float3 position : POSITION; float2 uv : TEXCOORD0; };
-        struct VS_OUTPUT { float4 position : SV_POSITION; float2 uv : TEXCOORD0; };
-        VS_OUTPUT main(VS_INPUT input) {
-            VS_OUTPUT output;
-            output.position = float4(input.position, 1.0f);
-            output.uv = input.uv;
-            return output;
-        })";
-
-        static constexpr const char* horizontal_blur_source_ = R"(
-        cbuffer BlurConstants : register(b0) { float2 texture_size; float blur_strength; float padding; };
-        Texture2D source_texture : register(t0);
-        SamplerState texture_sampler : register(s0);
-        struct PS_INPUT { float4 position : SV_POSITION; float2 uv : TEXCOORD0; };
-        float4 main(PS_INPUT input) : SV_Target {
-            float4 color = float4(0.0f, 0.0f, 0.0f, 0.0f);
-            float pixel_size = 1.0f / texture_size.x;
-            float total_weight = 0.0f;
-            int radius = 4;
-            for (int i = -radius; i <= radius; i++) {
-                float2 sample_uv = input.uv + float2(pixel_size * i * blur_strength, 0.0f);
-                sample_uv = clamp(sample_uv, float2(0.0f, 0.0f), float2(1.0f, 1.0f));
-                float weight = exp(-0.5f * (i * i) / (radius * radius * 0.5f));
-                color += source_texture.Sample(texture_sampler, sample_uv) * weight;
-                total_weight += weight;
-            }
-            return color / total_weight;
-        })";
-
-        static constexpr const char* vertical_blur_source_ = R"(
-        cbuffer BlurConstants : register(b0) { float2 texture_size; float blur_strength; float padding; };
-        Texture2D source_texture : register(t0);
-        SamplerState texture_sampler : register(s0);
-        struct PS_INPUT { float4 position : SV_POSITION; float2 uv : TEXCOORD0; };
-        float4 main(PS_INPUT input) : SV_Target {
-            float4 color = float4(0.0f, 0.0f, 0.0f, 0.0f);
-            float pixel_size = 1.0f / texture_size.y;
-            float total_weight = 0.0f;
-            int radius = 4;
-            for (int i = -radius; i <= radius; i++) {
-                float2 sample_uv = input.uv + float2(0.0f, pixel_size * i * blur_strength);
-                sample_uv = clamp(sample_uv, float2(0.0f, 0.0f), float2(1.0f, 1.0f));
-                float weight = exp(-0.5f * (i * i) / (radius * radius * 0.5f));
-                color += source_texture.Sample(texture_sampler, sample_uv) * weight;
-                total_weight += weight;
-            }
-            return color / total_weight;
-        })";
+        void cleanup_device();
+
+        // Every device and context call goes through these, so the profiler counts what a frame issues.
+        ID3D11Device* device() {
+            profiler_.count(stats::counter::d3d_calls);
+            return device_;
+        }
+
+        ID3D11DeviceContext* context() {
+            profiler_.count(stats::counter::d3d_calls);
+            return context_;
+        }
+
+        // device() for Create calls, which are also counted as resources created.
+        ID3D11Device* factory() {
+            profiler_.count(stats::counter::resources_created);
+            return device();
+        }
+
+        // A region's blur input: the capture itself, or its reduction at blur_rect when downsampling.
+        const atlas_rect& source_rect(const blur_region& region) const {
+            return region.downsample == 1 ? region.capture_rect : region.blur_rect;
+        }
+
+        // The blur slot must hold exactly the blur of the previous capture.
+        static bool partial_blur(const blur_region& region) {
+            return region.dirty_count > 0 && region.downsample == 1 && region.params.change_threshold <= 0.0f;
+        }
+
+        // rect is relative to the slot.
+        static atlas_rect sub_rect(const atlas_rect& slot, const atlas_rect& rect) {
+            return { slot.x + rect.x, slot.y + rect.y, rect.width, rect.height };
+        }
+
+        // region_id 0 always maps to the draw list, so key 0 is free for the shared backdrop.
+        static constexpr uintptr_t backdrop_key = 0;
+
+        static uintptr_t region_key(const blur_params& params) {
+            return params.region_id ? static_cast<uintptr_t>(params.region_id) : reinterpret_cast<uintptr_t>(params.draw_list);
+        }
+
+        // Regions with a change test are blurred on their own: predication skips whole draw calls.
+        static bool same_kernel(const blur_region& a, const blur_region& b) {
+            return a.params.change_threshold <= 0.0f && b.params.change_threshold <= 0.0f &&
+                a.params.mode == b.params.mode && a.downsample == b.downsample &&
+                a.params.blur_radius == b.params.blur_radius && a.params.blur_sigma == b.params.blur_sigma &&
+                a.params.sampling == b.params.sampling && a.params.use_compute == b.params.use_compute &&
+                (a.params.mode != blur_mode::dual_kawase || kawase_iterations(a.params.blur_radius * a.params.blur_strength / a.downsample) ==
+                    kawase_iterations(b.params.blur_radius * b.params.blur_strength / b.downsample));
+        }
 
     public:
-        ~blur_renderer() { cleanup_all(); }
+        blur_renderer() : pipelines_(shared_pipelines()) {}
+        ~blur_renderer() { release_device(device_); }
         bool render(const blur_params& params, bool should_blur);
+
+        // cache must outlive the renderer or be reset to nullptr.
+        void set_shader_cache(shader_cache* cache) { shader_cache_ = cache; }
+
+        // Takes effect on the next render(). A renderer with defines does not share its pipelines.
+        void set_shader_defines(std::vector<shader_macro> defines) {
+            cleanup_device();
+            shader_defines_ = std::move(defines);
+            pipelines_ = shader_defines_.empty() ? shared_pipelines() : std::make_shared<pipeline_cache>();
+        }
+
+        // Live-mode refreshes performed and skipped, and the GPU time of the last measured capture and blur.
+        const refresh_stats& live_stats() const { return refresh_policy_.stats(); }
+        void reset_live_stats() { refresh_policy_.reset_stats(); }
+        double gpu_time_ms() const { return gpu_time_ms_; }
+
+        // Rolling GPU time per stage, from timestamp queries read back a few frames late without waiting on the GPU.
+        const stats::gpu_timings& gpu_stats() const { return gpu_stats_; }
+        void reset_gpu_stats() { gpu_stats_.clear(); }
+
+        // Pooled textures are destroyed after being idle for this many seconds.
+        void set_texture_idle_timeout(double seconds) { texture_pool_.set_idle_timeout(seconds); }
+        const texture_pool_stats& texture_stats() const { return texture_pool_.stats(); }
+        void reset_texture_stats() { texture_pool_.reset_stats(); }
+
+        // Change detection only sees ImGui draw commands; call this when anything else beneath the windows changes.
+        void mark_dirty() { dirty_generation_++; }
+
+        // Live refreshes checked against the content beneath and skipped because it was unchanged.
+        const change_stats& change_detection_stats() const { return change_stats_; }
+        void reset_change_detection_stats() { change_stats_ = {}; }
+
+        // blur_params::change_threshold: blurs the GPU skipped because the capture had not changed.
+        const change_test_stats& gpu_change_stats() const { return change_test_stats_; }
+        void reset_gpu_change_stats() { change_test_stats_ = {}; }
+
+        // Captures and blur passes of the last rendered frame.
+        const frame_counters& last_frame_counters() const { return last_counters_; }
+
+        // Cached pipelines hold a reference on their device: every renderer that drew with a device must call
+        // release_device() before it is released. Returns false while another renderer still uses it.
+        void set_pipeline_idle_timeout(double seconds) { pipelines_->set_idle_timeout(seconds); }
+        bool release_device(ID3D11Device* device);
+        const device_cache_stats& pipeline_stats() const { return pipelines_->stats(); }
+        void reset_pipeline_stats() { pipelines_->reset_stats(); }
+
+        // CPU timers and counters per frame; the history may be read from any thread.
+        const stats::frame_profiler& profiler() const { return profiler_; }
+
+        // Limits on the counters of every frame from now on, counted by profiler().frames_over_budget().
+        void set_frame_budget(const stats::frame_budget& budget) { profiler_.set_budget(budget); }
     };
 
+    // Once per blurred window and frame. The capture and blur run in the window's own draw list, before its image.
     bool blur_renderer::render(const blur_params& params, bool should_blur) {
         if (!params.device || !params.draw_list) return false;
 
+        stats::scoped_timer timer(profiler_, stats::cpu_timer::render);
+        BLUR_TRACE_SCOPE("render");
+
+        // A device seen before finds its shaders and states in the pipeline cache.
         if (!initialized_ || device_ != params.device) {
-            cleanup_all();
+            BLUR_TRACE_SCOPE("initialize");
+            cleanup_device();
             device_ = params.device;
-            device_->GetImmediateContext(&context_);
-
-            if (!initialize_shaders() || !initialize_render_states()) {
-                return false;
-            }
+            device()->GetImmediateContext(&context_);
+            texture_pool_.allocator().device = device_;
+            texture_pool_.allocator().profiler = &profiler_;
+            timestamps_.source().device = device_;
+            timestamps_.source().context = context_;
+            timestamps_.source().profiler = &profiler_;
+
+            pipelines_->builder().renderer = this;
+            pipeline_ = pipelines_->acquire(device_, ImGui::GetTime());
+            pipelines_->builder().renderer = nullptr;
+            if (!pipeline_) return false;
             initialized_ = true;
+            invalidate_regions();
         }
 
         int window_width = static_cast<int>(params.window_size.x);
@@ -148,97 +591,317 @@ namespace blur {
 
         if (window_width <= 0 || window_height <= 0) return false;
 
+        begin_frame(ImGui::GetFrameCount());
+
+        if (params.shared_backdrop) return render_backdrop(params, should_blur);
+
+        blur_region* region = find_region(region_key(params));
+        if (!region) return false;
+
+        region->last_frame = current_frame_;
+        update_region(*region, window_width, window_height, params);
+        int downsample = region->downsample;
+
+        if (!should_blur) region->blurred = false;
+
         double current_time = ImGui::GetTime();
 
-        if (width_ != window_width || height_ != window_height) {
-            cleanup_render_targets();
-            reset_state();
-            width_ = window_width;
-            height_ = window_height;
+        bool capture = region->schedule.begin_frame(should_blur, current_time, params.delay_time);
+        if (!capture && params.live && region->schedule.captured() && !region->schedule.scheduled() && live_refresh(params)) {
+            capture = region->schedule.refresh();
         }
 
-        if (should_blur && !blur_enabled_last_frame_) {
-            reset_state();
-            blur_capture_pending_ = true;
-            blur_enable_time_ = current_time;
+        // A capture that cannot be queued now stays scheduled for the next frame.
+        if (capture && region->placed) {
+            region->params = params;
+            params.draw_list->AddCallback(&blur_renderer::capture_callback, region);
+            params.draw_list->AddCallback(&blur_renderer::blur_callback, this);
+            params.draw_list->AddCallback(ImDrawCallback_ResetRenderState, nullptr);
+            frame_used_ = true;
         }
-        else if (!should_blur && blur_enabled_last_frame_) {
-            reset_state();
+
+        if (should_blur && region->blurred && region->placed && blur_target_.srv) {
+            // A reduced image may overhang the window by up to downsample - 1 pixels; only map the covered part.
+            const atlas_rect& rect = region->blur_rect;
+            ImVec2 uv_min(static_cast<float>(rect.x) / blur_width_, static_cast<float>(rect.y) / blur_height_);
+            ImVec2 uv_max((rect.x + static_cast<float>(window_width) / downsample) / blur_width_,
+                (rect.y + static_cast<float>(window_height) / downsample) / blur_height_);
+
+            add_composite(params.draw_list, params.window_pos,
+                ImVec2(params.window_pos.x + params.window_size.x, params.window_pos.y + params.window_size.y),
+                uv_min, uv_max, params.corner_radius);
         }
 
-        if (should_blur && blur_capture_pending_ && !blur_processed_) {
-            if (current_time - blur_enable_time_ >= params.delay_time) {
-                blur_capture_pending_ = false;
+        return true;
+    }
 
-                if (ensure_render_targets(window_width, window_height)) {
-                    if (capture_background(params.window_pos, params.window_size)) {
-                        process_blur(params.blur_strength);
-                    }
-                }
+    // One display-sized region blurred in the background draw list; the first window of a frame drives it and every
+    // window composites its part.
+    bool blur_renderer::render_backdrop(const blur_params& params, bool should_blur) {
+        ImVec2 display_size = ImGui::GetIO().DisplaySize;
+        int display_width = static_cast<int>(display_size.x);
+        int display_height = static_cast<int>(display_size.y);
+
+        if (display_width <= 0 || display_height <= 0) return false;
+
+        blur_region* region = find_region(backdrop_key);
+        if (!region) return false;
+
+        if (should_blur && backdrop_frame_ != current_frame_) {
+            backdrop_frame_ = current_frame_;
+            region->last_frame = current_frame_;
+            update_region(*region, display_width, display_height, params);
+            bool ready = region->placed &&
+                (params.mode != blur_mode::pyramid || ensure_pyramid(region->blur_rect.width, region->blur_rect.height));
+            if (region->schedule.captured() && (params.mode == blur_mode::pyramid) != (region->params.mode == blur_mode::pyramid)) {
+                region->schedule.invalidate();
+            }
+
+            bool capture = region->schedule.begin_frame(true, ImGui::GetTime(), params.delay_time);
+            if (!capture && params.live && region->schedule.captured() && !region->schedule.scheduled() && live_refresh(params)) {
+                capture = region->schedule.refresh();
+            }
+
+            if (capture && ready) {
+                region->params = params;
+                region->params.window_pos = ImVec2(0.0f, 0.0f);
+                region->params.window_size = display_size;
+
+                ImGui::GetBackgroundDrawList()->AddCallback(&blur_renderer::capture_callback, region);
+                schedule_backdrop_callback();
             }
         }
 
-        blur_enabled_last_frame_ = should_blur;
+        if (!should_blur || !region->placed || !region->schedule.has_image() || !blur_target_.srv) return true;
+        if (params.mode == blur_mode::pyramid && region->params.mode == blur_mode::pyramid) return composite_pyramid(params, *region);
+
+        ImVec2 clip_min(std::max(params.window_pos.x, 0.0f), std::max(params.window_pos.y, 0.0f));
+        ImVec2 clip_max(std::min(params.window_pos.x + params.window_size.x, display_size.x),
+            std::min(params.window_pos.y + params.window_size.y, display_size.y));
+        if (clip_min.x >= clip_max.x || clip_min.y >= clip_max.y) return true;
+
+        const atlas_rect& rect = region->blur_rect;
+        float scale = 1.0f / region->downsample;
+        add_composite(params.draw_list, clip_min, clip_max,
+            ImVec2((rect.x + clip_min.x * scale) / blur_width_, (rect.y + clip_min.y * scale) / blur_height_),
+            ImVec2((rect.x + clip_max.x * scale) / blur_width_, (rect.y + clip_max.y * scale) / blur_height_),
+            params.corner_radius);
+        return true;
+    }
+
+    // Pyramid windows get a blur atlas slot, filled every frame by one SampleLevel pass over all of them.
+    bool blur_renderer::composite_pyramid(const blur_params& params, const blur_region& backdrop) {
+        int window_width = static_cast<int>(params.window_size.x);
+        int window_height = static_cast<int>(params.window_size.y);
+
+        blur_region* region = find_region(region_key(params));
+        if (!region) return false;
+
+        region->last_frame = current_frame_;
+        update_region(*region, window_width, window_height, params);
+        if (!region->placed || !pyramid_.srv) return true;
+
+        float sigma = kernel_sigma({ params.blur_radius, params.blur_sigma, params.sampling }) * params.blur_strength /
+            backdrop.downsample;
+        region->params = params;
+        region->pyramid_lod = std::min(pyramid_lod(sigma), static_cast<float>(pyramid_.levels - 1));
+        region->resolve_frame = current_frame_;
+        schedule_backdrop_callback();
+
+        const atlas_rect& rect = region->blur_rect;
+        add_composite(params.draw_list, params.window_pos,
+            ImVec2(params.window_pos.x + params.window_size.x, params.window_pos.y + params.window_size.y),
+            ImVec2(static_cast<float>(rect.x) / blur_width_, static_cast<float>(rect.y) / blur_height_),
+            ImVec2((rect.x + static_cast<float>(window_width) / region->downsample) / blur_width_,
+                (rect.y + static_cast<float>(window_height) / region->downsample) / blur_height_),
+            params.corner_radius);
+        return true;
+    }
 
-        if (should_blur && blur_processed_ && blur_srv_) {
-            params.draw_list->AddImageRounded(
-                (void*)blur_srv_,
-                params.window_pos,
-                ImVec2(params.window_pos.x + params.window_size.x,
-                    params.window_pos.y + params.window_size.y),
-                ImVec2(0, 0), ImVec2(1, 1),
-                IM_COL32(255, 255, 255, 255),
-                params.corner_radius
-            );
+    // Timestamps around the ImGui backend's draw of the image; they leave its render state alone.
+    void blur_renderer::add_composite(ImDrawList* draw_list, const ImVec2& p_min, const ImVec2& p_max, const ImVec2& uv_min,
+        const ImVec2& uv_max, float corner_radius) {
+        BLUR_TRACE_SCOPE("composite");
+        bool timed = timestamps_.source().available();
+        if (timed) draw_list->AddCallback(&blur_renderer::composite_begin_callback, this);
+        draw_list->AddImageRounded((ImTextureID)(uintptr_t)blur_target_.srv, p_min, p_max, uv_min, uv_max, IM_COL32(255, 255, 255, 255), corner_radius);
+        if (timed) draw_list->AddCallback(&blur_renderer::composite_end_callback, this);
+        frame_used_ = true;
+    }
+
+    // Once per frame, after the backdrop capture if there is one: builds the backdrop blur and resolves pyramid windows.
+    void blur_renderer::schedule_backdrop_callback() {
+        if (backdrop_scheduled_) return;
+
+        ImDrawList* background = ImGui::GetBackgroundDrawList();
+        background->AddCallback(&blur_renderer::backdrop_callback, this);
+        background->AddCallback(ImDrawCallback_ResetRenderState, nullptr);
+        backdrop_scheduled_ = true;
+        frame_used_ = true;
+    }
+
+    bool blur_renderer::ensure_pyramid(int width, int height) {
+        if (pyramid_.texture && pyramid_.width == width && pyramid_.height == height) return true;
+
+        stats::scoped_timer timer(profiler_, stats::cpu_timer::create);
+        BLUR_TRACE_SCOPE("allocate pyramid");
+        release_pyramid();
+
+        D3D11_TEXTURE2D_DESC desc = {};
+        desc.Width = width;
+        desc.Height = height;
+        desc.MipLevels = pyramid_levels(width, height);
+        desc.ArraySize = 1;
+        desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        desc.SampleDesc.Count = 1;
+        desc.Usage = D3D11_USAGE_DEFAULT;
+        desc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+
+        if (FAILED(factory()->CreateTexture2D(&desc, nullptr, &pyramid_.texture)) ||
+            FAILED(factory()->CreateShaderResourceView(pyramid_.texture, nullptr, &pyramid_.srv))) {
+            release_pyramid();
+            return false;
+        }
+
+        pyramid_.width = width;
+        pyramid_.height = height;
+        pyramid_.levels = static_cast<int>(desc.MipLevels);
+        profiler_.count(stats::counter::textures_created);
+        for (int level = 0; level < pyramid_.levels; level++) {
+            profiler_.count(stats::counter::bytes_allocated,
+                static_cast<uint64_t>(std::max(1, width >> level)) * std::max(1, height >> level) * 4);
         }
 
+        for (int level = 0; level < pyramid_.levels; level++) {
+            D3D11_RENDER_TARGET_VIEW_DESC rtv_desc = {};
+            rtv_desc.Format = desc.Format;
+            rtv_desc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2D;
+            rtv_desc.Texture2D.MipSlice = level;
+
+            D3D11_SHADER_RESOURCE_VIEW_DESC srv_desc = {};
+            srv_desc.Format = desc.Format;
+            srv_desc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+            srv_desc.Texture2D.MostDetailedMip = level;
+            srv_desc.Texture2D.MipLevels = 1;
+
+            if (FAILED(factory()->CreateRenderTargetView(pyramid_.texture, &rtv_desc, &pyramid_.level_rtvs[level])) ||
+                FAILED(factory()->CreateShaderResourceView(pyramid_.texture, &srv_desc, &pyramid_.level_srvs[level]))) {
+                release_pyramid();
+                return false;
+            }
+        }
         return true;
     }
 
-    bool blur_renderer::initialize_shaders() {
-        auto compile_shader = [](const char* source, const char* target) -> ID3DBlob* {
-            ID3DBlob* blob = nullptr;
-            ID3DBlob* error = nullptr;
+    void blur_renderer::release_pyramid() {
+        for (int level = 0; level < max_pyramid_levels; level++) {
+            if (pyramid_.level_rtvs[level]) pyramid_.level_rtvs[level]->Release();
+            if (pyramid_.level_srvs[level]) pyramid_.level_srvs[level]->Release();
+        }
+        if (pyramid_.srv) pyramid_.srv->Release();
+        if (pyramid_.texture) pyramid_.texture->Release();
+        pyramid_ = {};
+    }
 
-            HRESULT hr = D3DCompile(source, strlen(source), nullptr, nullptr, nullptr,
-                "main", target, D3DCOMPILE_ENABLE_STRICTNESS, 0, &blob, &error);
+    // Embedded bytecode, then the shader cache, then D3DCompile, whose blob the caller releases in *compiled.
+    bool blur_renderer::load_shader_bytecode(shader_id id, shader_bytecode& bytecode, ID3DBlob** compiled) {
+        *compiled = nullptr;
+        if (shader_defines_.empty()) {
+            bytecode = precompiled_shader(id);
+            if (bytecode.data && bytecode.size) return true;
+        }
 
-            if (error) { error->Release(); }
-            return SUCCEEDED(hr) ? blob : nullptr;
-            };
+        const shader_source& shader = get_shader_source(id);
+        uint64_t cache_key = 0;
+        if (shader_cache_) {
+            cache_key = shader_cache_key(shader.source, "main", shader.target, shader_defines_);
+            bytecode = shader_cache_->find(cache_key);
+            if (bytecode.data && bytecode.size) return true;
+        }
 
-        ID3DBlob* vs_blob = compile_shader(vertex_shader_source_, "vs_5_0");
-        ID3DBlob* ps_h_blob = compile_shader(horizontal_blur_source_, "ps_5_0");
-        ID3DBlob* ps_v_blob = compile_shader(vertical_blur_source_, "ps_5_0");
+        BLUR_TRACE_SCOPE("compile shader");
+        BLUR_TRACE_SCOPE(shader.name);
+        std::vector<D3D_SHADER_MACRO> macros;
+        for (const shader_macro& macro : shader_defines_) macros.push_back({ macro.name.c_str(), macro.definition.c_str() });
+        macros.push_back({ nullptr, nullptr });
 
-        if (!vs_blob || !ps_h_blob || !ps_v_blob) {
-            if (vs_blob) vs_blob->Release();
-            if (ps_h_blob) ps_h_blob->Release();
-            if (ps_v_blob) ps_v_blob->Release();
+        ID3DBlob* error = nullptr;
+
+        HRESULT hr = D3DCompile(shader.source, strlen(shader.source), shader.name, macros.data(), nullptr,
+            "main", shader.target, D3DCOMPILE_ENABLE_STRICTNESS, 0, compiled, &error);
+
+        if (error) { error->Release(); }
+        if (FAILED(hr) || !*compiled) {
+            *compiled = nullptr;
             return false;
         }
 
+        bytecode.data = static_cast<const unsigned char*>((*compiled)->GetBufferPointer());
+        bytecode.size = (*compiled)->GetBufferSize();
+        if (shader_cache_) shader_cache_->insert(cache_key, bytecode.data, bytecode.size);
+        return true;
+    }
+
+    bool blur_renderer::initialize_shaders(pipeline& out) {
+        stats::scoped_timer timer(profiler_, stats::cpu_timer::create);
+
+        struct pixel_shader_slot {
+            shader_id id;
+            ID3D11PixelShader** shader;
+        };
+
+        const pixel_shader_slot pixel_shaders[] = {
+            { shader_id::horizontal_blur, &out.pixel_shader_horizontal },
+            { shader_id::vertical_blur, &out.pixel_shader_vertical },
+            { shader_id::kawase_down, &out.pixel_shader_kawase_down },
+            { shader_id::kawase_up, &out.pixel_shader_kawase_up },
+            { shader_id::downsample, &out.pixel_shader_downsample },
+            { shader_id::pyramid_down, &out.pixel_shader_pyramid_down },
+            { shader_id::pyramid_resolve, &out.pixel_shader_pyramid_resolve },
+            { shader_id::change_test, &out.pixel_shader_change_test },
+        };
+
+        shader_bytecode bytecode;
+        ID3DBlob* compiled = nullptr;
+
+        if (!load_shader_bytecode(shader_id::vertex, bytecode, &compiled)) return false;
+
+        D3D11_INPUT_ELEMENT_DESC layout[] = {
+            {"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0},
+            {"TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0},
+            {"TEXCOORD", 1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 0, D3D11_INPUT_PER_INSTANCE_DATA, 1},
+            {"TEXCOORD", 2, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 16, D3D11_INPUT_PER_INSTANCE_DATA, 1},
+            {"TEXCOORD", 3, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 32, D3D11_INPUT_PER_INSTANCE_DATA, 1},
+            {"TEXCOORD", 4, DXGI_FORMAT_R32_FLOAT, 1, 48, D3D11_INPUT_PER_INSTANCE_DATA, 1}
+        };
+
         bool success =
-            SUCCEEDED(device_->CreateVertexShader(vs_blob->GetBufferPointer(), vs_blob->GetBufferSize(), nullptr, &vertex_shader_)) &&
-            SUCCEEDED(device_->CreatePixelShader(ps_h_blob->GetBufferPointer(), ps_h_blob->GetBufferSize(), nullptr, &pixel_shader_horizontal_)) &&
-            SUCCEEDED(device_->CreatePixelShader(ps_v_blob->GetBufferPointer(), ps_v_blob->GetBufferSize(), nullptr, &pixel_shader_vertical_));
-
-        if (success) {
-            D3D11_INPUT_ELEMENT_DESC layout[] = {
-                {"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0},
-                {"TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0}
-            };
-            success = SUCCEEDED(device_->CreateInputLayout(layout, 2, vs_blob->GetBufferPointer(), vs_blob->GetBufferSize(), &input_layout_));
+            SUCCEEDED(factory()->CreateVertexShader(bytecode.data, bytecode.size, nullptr, &out.vertex_shader)) &&
+            SUCCEEDED(factory()->CreateInputLayout(layout, 6, bytecode.data, bytecode.size, &out.input_layout));
+        if (compiled) { compiled->Release(); compiled = nullptr; }
+
+        for (const pixel_shader_slot& slot : pixel_shaders) {
+            if (!success) break;
+            success = load_shader_bytecode(slot.id, bytecode, &compiled) &&
+                SUCCEEDED(factory()->CreatePixelShader(bytecode.data, bytecode.size, nullptr, slot.shader));
+            if (compiled) { compiled->Release(); compiled = nullptr; }
         }
 
-        vs_blob->Release();
-        ps_h_blob->Release();
-        ps_v_blob->Release();
+        if (success && device()->GetFeatureLevel() >= D3D_FEATURE_LEVEL_11_0 &&
+            load_shader_bytecode(shader_id::compute_blur, bytecode, &compiled)) {
+            if (FAILED(factory()->CreateComputeShader(bytecode.data, bytecode.size, nullptr, &out.compute_shader_blur))) {
+                out.compute_shader_blur = nullptr;
+            }
+            if (compiled) { compiled->Release(); compiled = nullptr; }
+        }
 
+        if (shader_cache_) shader_cache_->save();
         return success;
     }
 
-    bool blur_renderer::initialize_render_states() {
+    bool blur_renderer::initialize_render_states(pipeline& out) {
+        stats::scoped_timer timer(profiler_, stats::cpu_timer::create);
+
         vertex vertices[] = {
             {{-1.0f, -1.0f, 0.0f}, {0.0f, 1.0f}},
             {{-1.0f,  1.0f, 0.0f}, {0.0f, 0.0f}},
@@ -254,16 +917,22 @@ namespace blur {
         D3D11_SUBRESOURCE_DATA init_data = {};
         init_data.pSysMem = vertices;
 
-        if (FAILED(device_->CreateBuffer(&buffer_desc, &init_data, &vertex_buffer_))) {
+        if (FAILED(factory()->CreateBuffer(&buffer_desc, &init_data, &out.vertex_buffer))) {
             return false;
         }
 
-        buffer_desc.ByteWidth = sizeof(blur_constants);
-        buffer_desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        buffer_desc.ByteWidth = sizeof(instances_);
         buffer_desc.Usage = D3D11_USAGE_DYNAMIC;
         buffer_desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
 
-        if (FAILED(device_->CreateBuffer(&buffer_desc, nullptr, &constant_buffer_))) {
+        if (FAILED(factory()->CreateBuffer(&buffer_desc, nullptr, &out.instance_buffer))) {
+            return false;
+        }
+
+        buffer_desc.ByteWidth = sizeof(blur_constants);
+        buffer_desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+
+        if (FAILED(factory()->CreateBuffer(&buffer_desc, nullptr, &out.constant_buffer))) {
             return false;
         }
 
@@ -274,7 +943,7 @@ namespace blur {
         sampler_desc.MaxLOD = D3D11_FLOAT32_MAX;
         sampler_desc.MaxAnisotropy = 1;
 
-        if (FAILED(device_->CreateSamplerState(&sampler_desc, &sampler_state_))) {
+        if (FAILED(factory()->CreateSamplerState(&sampler_desc, &out.sampler_state))) {
             return false;
         }
 
@@ -288,7 +957,14 @@ namespace blur {
         blend_desc.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP_ADD;
         blend_desc.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
 
-        if (FAILED(device_->CreateBlendState(&blend_desc, &blend_state_))) {
+        if (FAILED(factory()->CreateBlendState(&blend_desc, &out.blend_state))) {
+            return false;
+        }
+
+        blend_desc.RenderTarget[0].BlendEnable = FALSE;
+        blend_desc.RenderTarget[0].RenderTargetWriteMask = 0;
+
+        if (FAILED(factory()->CreateBlendState(&blend_desc, &out.no_write_blend_state))) {
             return false;
         }
 
@@ -297,43 +973,234 @@ namespace blur {
         raster_desc.CullMode = D3D11_CULL_NONE;
         raster_desc.DepthClipEnable = TRUE;
 
-        return SUCCEEDED(device_->CreateRasterizerState(&raster_desc, &rasterizer_state_));
+        if (FAILED(factory()->CreateRasterizerState(&raster_desc, &out.rasterizer_state))) {
+            return false;
+        }
+
+        return true;
     }
 
-    bool blur_renderer::ensure_render_targets(int width, int height) {
-        if (background_capture_ && width_ == width && height_ == height) {
+    // Sizes come from pack_layout and are already bucketed, so the pooled textures match them exactly.
+    bool blur_renderer::ensure_render_targets(int capture_width, int capture_height, int blur_width, int blur_height) {
+        if (capture_target_.texture && capture_width_ == capture_width && capture_height_ == capture_height &&
+            blur_width_ == blur_width && blur_height_ == blur_height) {
             return true;
         }
 
+        stats::scoped_timer timer(profiler_, stats::cpu_timer::create);
+        BLUR_TRACE_SCOPE("allocate targets");
         cleanup_render_targets();
 
-        auto create_texture = [this](int w, int h, UINT bind_flags, ID3D11Texture2D** texture,
-            ID3D11RenderTargetView** rtv = nullptr, ID3D11ShaderResourceView** srv = nullptr) -> bool {
-                D3D11_TEXTURE2D_DESC desc = {};
-                desc.Width = w;
-                desc.Height = h;
-                desc.MipLevels = 1;
-                desc.ArraySize = 1;
-                desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-                desc.SampleDesc.Count = 1;
-                desc.Usage = D3D11_USAGE_DEFAULT;
-                desc.BindFlags = bind_flags;
-
-                if (FAILED(device_->CreateTexture2D(&desc, nullptr, texture))) return false;
-                if (rtv && FAILED(device_->CreateRenderTargetView(*texture, nullptr, rtv))) return false;
-                if (srv && FAILED(device_->CreateShaderResourceView(*texture, nullptr, srv))) return false;
-                return true;
-            };
+        UINT blur_bind_flags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+        if (pipeline_->compute_shader_blur) blur_bind_flags |= D3D11_BIND_UNORDERED_ACCESS;
 
-        return create_texture(width, height, D3D11_BIND_SHADER_RESOURCE, &background_capture_, nullptr, &background_srv_) &&
-            create_texture(width, height, D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE, &temp_texture_, &temp_rtv_, &temp_srv_) &&
-            create_texture(width, height, D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE, &blur_texture_, &blur_rtv_, &blur_srv_);
+        bool created = texture_pool_.acquire(capture_width, capture_height, D3D11_BIND_SHADER_RESOURCE, capture_target_) &&
+            texture_pool_.acquire(blur_width, blur_height, D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE, temp_target_) &&
+            texture_pool_.acquire(blur_width, blur_height, blur_bind_flags, blur_target_);
+        if (!created) {
+            cleanup_render_targets();
+            return false;
+        }
+
+        capture_width_ = capture_target_.width;
+        capture_height_ = capture_target_.height;
+        blur_width_ = blur_target_.width;
+        blur_height_ = blur_target_.height;
+        return true;
     }
 
-    bool blur_renderer::capture_background(ImVec2 window_pos, ImVec2 window_size) {
+    // Level textures may come back larger than asked for; passes address them through their real size.
+    bool blur_renderer::ensure_kawase_levels(int iterations) {
+        int level_width = blur_width_;
+        int level_height = blur_height_;
+
+        for (int i = 0; i < iterations; i++) {
+            level_width = std::max(1, level_width / 2);
+            level_height = std::max(1, level_height / 2);
+
+            if (i < static_cast<int>(kawase_levels_.size())) continue;
+
+            stats::scoped_timer timer(profiler_, stats::cpu_timer::create);
+            BLUR_TRACE_SCOPE("allocate kawase level");
+            render_target level;
+            if (!texture_pool_.acquire(level_width, level_height, D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE, level)) return false;
+            kawase_levels_.push_back(level);
+        }
+
+        return true;
+    }
+
+    // Regions idle for region_idle_frames give up their slot; the atlas space is reclaimed at the next repack.
+    void blur_renderer::begin_frame(int frame) {
+        if (frame == current_frame_) return;
+
+        current_frame_ = frame;
+        frame_time_ = ImGui::GetTime();
+        last_counters_ = counters_;
+        profiler_.count(stats::counter::captures, counters_.captures);
+        profiler_.count(stats::counter::passes, counters_.passes);
+        profiler_.end_frame(frame);
+        counters_ = {};
+        frame_used_ = false;
+        backdrop_scheduled_ = false;
+        collect_gpu_timing();
+        collect_change_tests();
+        texture_pool_.trim(frame_time_);
+        pipelines_->trim(frame_time_);
+
+        for (blur_region& region : regions_) {
+            if (region.active && frame - region.last_frame > region_idle_frames) {
+                region = blur_region{};
+            }
+        }
+
+        if (repack_needed_) repack_regions();
+    }
+
+    blur_region* blur_renderer::find_region(uintptr_t key) {
+        blur_region* free_region = nullptr;
+        for (blur_region& region : regions_) {
+            if (region.active && region.key == key) return &region;
+            if (!region.active && !free_region) free_region = &region;
+        }
+        if (!free_region) return nullptr;
+
+        *free_region = blur_region{};
+        free_region->renderer = this;
+        free_region->key = key;
+        free_region->active = true;
+        free_region->last_frame = current_frame_;
+        return free_region;
+    }
+
+    // Moves the region to a new slot when its size, reduction or alignment needs changed.
+    void blur_renderer::update_region(blur_region& region, int width, int height, const blur_params& params) {
+        int downsample = downsample_factor(params.downsample);
+        int alignment = params.mode == blur_mode::dual_kawase ? 1 << max_kawase_iterations : default_atlas_alignment;
+        bool captures = region.key == backdrop_key || !params.shared_backdrop;
+
+        if (region.placed && region.width == width && region.height == height && region.downsample == downsample &&
+            region.alignment >= alignment && region.captures == captures) {
+            return;
+        }
+
+        region.captures = captures;
+        region.width = width;
+        region.height = height;
+        region.downsample = downsample;
+        region.alignment = alignment;
+        region.schedule.invalidate();
+        region.blurred = false;
+        region.placed = place_region(region);
+    }
+
+    // Into free atlas space if possible, otherwise the layout is rebuilt once nothing queued refers to it.
+    bool blur_renderer::place_region(blur_region& region) {
+        // Both slots or neither: the packers cannot give one back.
+        int blur_width = downsampled_size(region.width, region.downsample);
+        int blur_height = downsampled_size(region.height, region.downsample);
+        if (capture_target_.texture && region.alignment <= blur_layout_.alignment() &&
+            (!region.captures || capture_layout_.fits(region.width, region.height)) && blur_layout_.fits(blur_width, blur_height)) {
+            if (region.captures) capture_layout_.insert(region.width, region.height, region.capture_rect);
+            blur_layout_.insert(blur_width, blur_height, region.blur_rect);
+            return true;
+        }
+
+        repack_needed_ = true;
+        if (frame_used_) return false;
+
+        return repack_regions() && region.placed;
+    }
+
+    // The atlases only grow here, so windows that come and go do not keep reallocating them.
+    bool blur_renderer::repack_regions() {
+        repack_needed_ = false;
+        invalidate_regions();
+
+        int count = 0;
+        int alignment = default_atlas_alignment;
+        bool any_active = false;
+        for (const blur_region& region : regions_) {
+            if (!region.active) continue;
+            any_active = true;
+            alignment = std::max(alignment, region.alignment);
+            if (region.captures) layout_sizes_[count++] = { 0, 0, region.width, region.height };
+        }
+
+        if (!any_active) {
+            cleanup_render_targets();
+            return true;
+        }
+
+        int capture_width = capture_width_;
+        int capture_height = capture_height_;
+        if (!pack_layout(capture_layout_, count, 1, capture_width, capture_height)) return false;
+
+        int index = 0;
+        for (blur_region& region : regions_) {
+            if (region.active) region.capture_rect = region.captures ? layout_rects_[index++] : atlas_rect{};
+        }
+
+        count = 0;
+        for (const blur_region& region : regions_) {
+            if (!region.active) continue;
+            layout_sizes_[count++] = { 0, 0, downsampled_size(region.width, region.downsample),
+                downsampled_size(region.height, region.downsample) };
+        }
+
+        int blur_width = blur_width_;
+        int blur_height = blur_height_;
+        if (!pack_layout(blur_layout_, count, alignment, blur_width, blur_height) ||
+            !ensure_render_targets(capture_width, capture_height, blur_width, blur_height)) {
+            return false;
+        }
+
+        index = 0;
+        for (blur_region& region : regions_) {
+            if (!region.active) continue;
+            region.blur_rect = layout_rects_[index++];
+            region.placed = true;
+        }
+        return true;
+    }
+
+    // The atlas size is a pool bucket; its slack is left to later inserts.
+    bool blur_renderer::pack_layout(atlas_layout& layout, int count, int alignment, int& width, int& height) {
+        for (;;) {
+            if (!layout.pack(layout_sizes_, layout_rects_, count, alignment, width, height)) return false;
+
+            int bucket_width = pool_bucket_size(width);
+            int bucket_height = pool_bucket_size(height);
+            if (bucket_width == width && bucket_height == height) return true;
+            width = bucket_width;
+            height = bucket_height;
+        }
+    }
+
+    // Forget every capture, e.g. after the atlases were recreated or repacked.
+    void blur_renderer::invalidate_regions() {
+        for (blur_region& region : regions_) {
+            region.placed = false;
+            region.queued = false;
+            region.blurred = false;
+            region.schedule.invalidate();
+            region.reference_valid = false;
+        }
+    }
+
+    // The first live region of a frame decides for all of them.
+    bool blur_renderer::live_refresh(const blur_params& params) {
+        if (live_frame_ != current_frame_) {
+            live_frame_ = current_frame_;
+            live_refresh_ = refresh_policy_.should_refresh(params.refresh_interval, params.gpu_budget_ms);
+        }
+        return live_refresh_;
+    }
+
+    bool blur_renderer::capture_background(ImVec2 window_pos, ImVec2 window_size, const atlas_rect& rect) {
         ID3D11RenderTargetView* current_rtv = nullptr;
         ID3D11DepthStencilView* current_dsv = nullptr;
-        context_->OMGetRenderTargets(1, &current_rtv, &current_dsv);
+        context()->OMGetRenderTargets(1, &current_rtv, &current_dsv);
 
         if (!current_rtv) return false;
 
@@ -342,17 +1209,24 @@ namespace blur {
 
         bool success = false;
         if (back_buffer) {
+            // A window hanging over the left or top edge keeps its visible part at the matching offset in its slot.
             D3D11_BOX src_box = {};
             src_box.left = static_cast<UINT>(std::max(0.0f, window_pos.x));
             src_box.top = static_cast<UINT>(std::max(0.0f, window_pos.y));
-            src_box.right = static_cast<UINT>(window_pos.x + window_size.x);
-            src_box.bottom = static_cast<UINT>(window_pos.y + window_size.y);
+            src_box.right = static_cast<UINT>(std::max(0.0f, window_pos.x + window_size.x));
+            src_box.bottom = static_cast<UINT>(std::max(0.0f, window_pos.y + window_size.y));
             src_box.front = 0;
             src_box.back = 1;
 
-            context_->CopySubresourceRegion(background_capture_, 0, 0, 0, 0, back_buffer, 0, &src_box);
-            background_captured_ = true;
-            success = true;
+            UINT dst_x = rect.x + static_cast<UINT>(std::max(0.0f, -window_pos.x));
+            UINT dst_y = rect.y + static_cast<UINT>(std::max(0.0f, -window_pos.y));
+            src_box.right = std::min<UINT>(src_box.right, src_box.left + (rect.x + rect.width - dst_x));
+            src_box.bottom = std::min<UINT>(src_box.bottom, src_box.top + (rect.y + rect.height - dst_y));
+
+            if (src_box.right > src_box.left && src_box.bottom > src_box.top) {
+                context()->CopySubresourceRegion(capture_target_.texture, 0, dst_x, dst_y, 0, back_buffer, 0, &src_box);
+                success = true;
+            }
             back_buffer->Release();
         }
 
@@ -361,103 +1235,729 @@ namespace blur {
         return success;
     }
 
-    bool blur_renderer::process_blur(float blur_strength) {
-        if (!background_captured_) return false;
+    bool blur_renderer::update_constants(int texture_width, int texture_height, const kernel_table* table, int downsample_factor,
+        const atlas_rect& region, const atlas_rect& source) {
+        stats::scoped_timer timer(profiler_, stats::cpu_timer::map);
+        D3D11_MAPPED_SUBRESOURCE mapped;
+        if (FAILED(context()->Map(pipeline_->constant_buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped))) {
+            return false;
+        }
 
-        ID3D11RenderTargetView* original_rtv = nullptr;
-        ID3D11DepthStencilView* original_dsv = nullptr;
-        context_->OMGetRenderTargets(1, &original_rtv, &original_dsv);
+        blur_constants* constants = static_cast<blur_constants*>(mapped.pData);
+        constants->texture_size[0] = static_cast<float>(texture_width);
+        constants->texture_size[1] = static_cast<float>(texture_height);
+        constants->downsample_factor = downsample_factor;
+        constants->tap_count = table ? table->tap_count : 0;
+        if (table) std::copy(table->taps, table->taps + max_table_taps, constants->taps);
+        constants->region[0] = region.x;
+        constants->region[1] = region.y;
+        constants->region[2] = region.width;
+        constants->region[3] = region.height;
+        constants->source_origin[0] = source.x;
+        constants->source_origin[1] = source.y;
+
+        context()->Unmap(pipeline_->constant_buffer, 0);
+        return true;
+    }
 
-        D3D11_VIEWPORT original_viewport;
-        UINT num_viewports = 1;
-        context_->RSGetViewports(&num_viewports, &original_viewport);
+    // Queues one region for the next draw_pass; rects are in texels, taps are clamped to bounds. Passes that read lod
+    // or threshold set them on the returned instance, which is null once the pass is full.
+    region_instance* blur_renderer::add_instance(const atlas_rect& target, int target_width, int target_height,
+        const atlas_rect& source, const atlas_rect& bounds, int source_width, int source_height, float blur_strength) {
+        if (instance_count_ >= max_pass_instances) return nullptr;
+
+        region_instance& instance = instances_[instance_count_++];
+        instance.target_rect[0] = 2.0f * target.x / target_width - 1.0f;
+        instance.target_rect[1] = 1.0f - 2.0f * target.y / target_height;
+        instance.target_rect[2] = 2.0f * (target.x + target.width) / target_width - 1.0f;
+        instance.target_rect[3] = 1.0f - 2.0f * (target.y + target.height) / target_height;
+        instance.source_rect[0] = static_cast<float>(source.x) / source_width;
+        instance.source_rect[1] = static_cast<float>(source.y) / source_height;
+        instance.source_rect[2] = static_cast<float>(source.x + source.width) / source_width;
+        instance.source_rect[3] = static_cast<float>(source.y + source.height) / source_height;
+        instance.uv_clamp[0] = (bounds.x + 0.5f) / source_width;
+        instance.uv_clamp[1] = (bounds.y + 0.5f) / source_height;
+        instance.uv_clamp[2] = (bounds.x + bounds.width - 0.5f) / source_width;
+        instance.uv_clamp[3] = (bounds.y + bounds.height - 0.5f) / source_height;
+        instance.blur_strength = blur_strength;
+        return &instance;
+    }
 
-        D3D11_MAPPED_SUBRESOURCE mapped;
-        if (SUCCEEDED(context_->Map(constant_buffer_, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped))) {
-            blur_constants* constants = static_cast<blur_constants*>(mapped.pData);
-            constants->texture_size[0] = static_cast<float>(width_);
-            constants->texture_size[1] = static_cast<float>(height_);
-            constants->blur_strength = blur_strength;
-            constants->padding = 0.0f;
-            context_->Unmap(constant_buffer_, 0);
-        }
-
-        UINT stride = sizeof(vertex);
-        UINT offset = 0;
-        context_->IASetVertexBuffers(0, 1, &vertex_buffer_, &stride, &offset);
-        context_->IASetInputLayout(input_layout_);
-        context_->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
-        context_->VSSetShader(vertex_shader_, nullptr, 0);
-        context_->PSSetConstantBuffers(0, 1, &constant_buffer_);
-        context_->PSSetSamplers(0, 1, &sampler_state_);
-        context_->RSSetState(rasterizer_state_);
-        context_->OMSetBlendState(blend_state_, nullptr, 0xFFFFFFFF);
+    // Draws the queued instances in one call; the viewport covers the whole target and each instance its own rect.
+    bool blur_renderer::draw_pass(stats::stage stage, ID3D11PixelShader* shader, ID3D11ShaderResourceView* source,
+        ID3D11RenderTargetView* target, int width, int height) {
+        int count = instance_count_;
+        instance_count_ = 0;
+
+        if (count == 0) return true;
+        BLUR_TRACE_SCOPE(stats::stage_name(stage));
+        {
+            stats::scoped_timer timer(profiler_, stats::cpu_timer::map);
+            D3D11_MAPPED_SUBRESOURCE mapped;
+            if (FAILED(context()->Map(pipeline_->instance_buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped))) return false;
+            std::copy(instances_, instances_ + count, static_cast<region_instance*>(mapped.pData));
+            context()->Unmap(pipeline_->instance_buffer, 0);
+        }
 
         D3D11_VIEWPORT viewport = {};
-        viewport.Width = static_cast<float>(width_);
-        viewport.Height = static_cast<float>(height_);
+        viewport.Width = static_cast<float>(width);
+        viewport.Height = static_cast<float>(height);
         viewport.MaxDepth = 1.0f;
-        context_->RSSetViewports(1, &viewport);
+        context()->RSSetViewports(1, &viewport);
 
-        context_->OMSetRenderTargets(1, &temp_rtv_, nullptr);
-        context_->PSSetShader(pixel_shader_horizontal_, nullptr, 0);
-        context_->PSSetShaderResources(0, 1, &background_srv_);
-        context_->Draw(4, 0);
+        context()->OMSetRenderTargets(1, &target, nullptr);
+        context()->PSSetShader(shader, nullptr, 0);
+        context()->PSSetShaderResources(0, 1, &source);
+        int timestamp = timestamps_.begin(stage);
+        context()->DrawInstanced(4, count, 0, 0);
+        timestamps_.end(timestamp);
+        counters_.passes++;
 
-        context_->OMSetRenderTargets(1, &blur_rtv_, nullptr);
-        context_->PSSetShader(pixel_shader_vertical_, nullptr, 0);
-        context_->PSSetShaderResources(0, 1, &temp_srv_);
-        context_->Draw(4, 0);
+        ID3D11ShaderResourceView* null_srvs[1] = { nullptr };
+        context()->PSSetShaderResources(0, 1, null_srvs);
+        return true;
+    }
 
-        context_->OMSetRenderTargets(1, &original_rtv, original_dsv);
-        context_->RSSetViewports(1, &original_viewport);
+    // Regions sharing a kernel are drawn together, one instance each.
+    void blur_renderer::process_blur(bool backdrop) {
+        int count = 0;
+        for (int i = 0; i < max_blur_regions; i++) {
+            blur_region& region = regions_[i];
+            if (!region.active || !region.queued || (region.key == backdrop_key) != backdrop) continue;
+            region.queued = false;
+            if (!region.placed) continue;
+            blur_queue_[count++] = i;
+        }
+        if (count == 0 && !backdrop) return;
+        if (!blur_target_.rtv) {
+            finish_blur(blur_queue_, count, false);
+            return;
+        }
 
-        ID3D11ShaderResourceView* null_srvs[1] = { nullptr };
-        context_->PSSetShaderResources(0, 1, null_srvs);
+        std::sort(blur_queue_, blur_queue_ + count, [this](int a, int b) {
+            const blur_params& pa = regions_[a].params;
+            const blur_params& pb = regions_[b].params;
+            if (pa.mode != pb.mode) return pa.mode < pb.mode;
+            if (regions_[a].downsample != regions_[b].downsample) return regions_[a].downsample < regions_[b].downsample;
+            if (pa.blur_radius != pb.blur_radius) return pa.blur_radius < pb.blur_radius;
+            if (pa.blur_sigma != pb.blur_sigma) return pa.blur_sigma < pb.blur_sigma;
+            if (pa.sampling != pb.sampling) return pa.sampling < pb.sampling;
+            if (pa.use_compute != pb.use_compute) return pa.use_compute < pb.use_compute;
+            return pa.blur_radius * pa.blur_strength < pb.blur_radius * pb.blur_strength;
+        });
+
+        auto state_start = stats::frame_profiler::clock::now();
+        ID3D11RenderTargetView* original_rtv = nullptr;
+        ID3D11DepthStencilView* original_dsv = nullptr;
+        context()->OMGetRenderTargets(1, &original_rtv, &original_dsv);
+
+        D3D11_VIEWPORT original_viewport;
+        UINT num_viewports = 1;
+        context()->RSGetViewports(&num_viewports, &original_viewport);
+        profiler_.add_time(stats::cpu_timer::state, stats::frame_profiler::clock::now() - state_start);
+
+        ID3D11Buffer* buffers[2] = { pipeline_->vertex_buffer, pipeline_->instance_buffer };
+        UINT strides[2] = { sizeof(vertex), sizeof(region_instance) };
+        UINT offsets[2] = { 0, 0 };
+        context()->IASetVertexBuffers(0, 2, buffers, strides, offsets);
+        context()->IASetInputLayout(pipeline_->input_layout);
+        context()->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+        context()->VSSetShader(pipeline_->vertex_shader, nullptr, 0);
+        context()->PSSetConstantBuffers(0, 1, &pipeline_->constant_buffer);
+        context()->PSSetSamplers(0, 1, &pipeline_->sampler_state);
+        context()->RSSetState(pipeline_->rasterizer_state);
+        context()->OMSetBlendState(pipeline_->blend_state, nullptr, 0xFFFFFFFF);
+
+        for (int first = 0; first < count;) {
+            int last = first + 1;
+            while (last < count && same_kernel(regions_[blur_queue_[first]], regions_[blur_queue_[last]])) last++;
+
+            blur_region& head = regions_[blur_queue_[first]];
+            const blur_params& params = head.params;
+            bool predicated = params.change_threshold > 0.0f && begin_change_test(head);
+
+            bool blurred;
+            if (backdrop && params.mode == blur_mode::pyramid) {
+                blurred = process_pyramid(head);
+            }
+            else if (params.mode == blur_mode::dual_kawase) {
+                blurred = process_dual_kawase(blur_queue_ + first, last - first);
+            }
+            else {
+                blurred = process_gaussian(blur_queue_ + first, last - first);
+            }
+
+            if (params.change_threshold > 0.0f) end_change_test(head, predicated);
+            finish_blur(blur_queue_ + first, last - first, blurred);
+            first = last;
+        }
+
+        if (backdrop) resolve_pyramid();
+
+        state_start = stats::frame_profiler::clock::now();
+        context()->OMSetRenderTargets(1, &original_rtv, original_dsv);
+        context()->RSSetViewports(1, &original_viewport);
 
         if (original_rtv) original_rtv->Release();
         if (original_dsv) original_dsv->Release();
+        profiler_.add_time(stats::cpu_timer::state, stats::frame_profiler::clock::now() - state_start);
+    }
+
+    // Regions whose passes failed show nothing until a full capture is blurred; the schedule asks for one right away.
+    void blur_renderer::finish_blur(const int* indices, int count, bool blurred) {
+        for (int i = 0; i < count; i++) {
+            blur_region& region = regions_[indices[i]];
+            region.blurred = blurred;
+            if (!blurred) region.schedule.invalidate();
+        }
+    }
+
+    void blur_renderer::capture_callback(const ImDrawList* parent_list, const ImDrawCmd* cmd) {
+        blur_region* region = static_cast<blur_region*>(cmd->UserCallbackData);
+        blur_renderer* renderer = region->renderer;
+        stats::scoped_timer timer(renderer->profiler_, stats::cpu_timer::capture);
+        BLUR_TRACE_SCOPE("capture");
+
+        // A live refresh over an unchanged backdrop keeps the blurred image it already has.
+        if (!renderer->content_changed(*region, parent_list, cmd)) {
+            region->schedule.on_capture(true);
+            return;
+        }
+
+        bool success = false;
+        int timestamp = renderer->timestamps_.begin(stats::stage::capture);
+        if (region->placed && renderer->capture_target_.texture && region->dirty_count > 0) {
+            // Changed tiles only; a rect entirely off screen has nothing to copy and nothing visible to update.
+            for (int i = 0; i < region->dirty_count; i++) {
+                const atlas_rect& rect = region->dirty_rects[i];
+                ImVec2 pos(region->params.window_pos.x + rect.x, region->params.window_pos.y + rect.y);
+                ImVec2 size(static_cast<float>(rect.width), static_cast<float>(rect.height));
+                success = renderer->capture_background(pos, size, sub_rect(region->capture_rect, rect)) || success;
+            }
+        }
+        else if (region->placed && renderer->capture_target_.texture) {
+            success = renderer->capture_background(region->params.window_pos, region->params.window_size, region->capture_rect);
+        }
+        renderer->timestamps_.end(timestamp);
+        region->queued = success || region->queued;
+        region->schedule.on_capture(success);
+        if (!success) {
+            region->content.reset();
+            region->tiles.invalidate();
+        }
+        if (success) renderer->counters_.captures++;
+    }
+
+    // Everything drawn before the capture callback. False if the list is not in the current draw data.
+    bool blur_renderer::content_hash(const blur_region& region, const ImDrawList* parent_list, const ImDrawCmd* cmd, uint64_t& hash) {
+        const ImDrawData* draw_data = ImGui::GetDrawData();
+        if (!draw_data) return false;
+
+        hash = params_hash(region);
+        for (int i = 0; i < draw_data->CmdListsCount; i++) {
+            const ImDrawList* list = draw_data->CmdLists[i];
+            if (list == parent_list) {
+                hash = hash_draw_commands(*list, static_cast<int>(cmd - list->CmdBuffer.Data), hash, &change_stats_.hashed_bytes);
+                return true;
+            }
+            hash = hash_draw_commands(*list, list->CmdBuffer.Size, hash, &change_stats_.hashed_bytes);
+        }
+        return false;
+    }
+
+    // What changes every texel at once: the window rect, the kernel and mark_dirty().
+    uint64_t blur_renderer::params_hash(const blur_region& region) const {
+        const blur_params& params = region.params;
+        uint64_t hash = hash_value(dirty_generation_, 0);
+        hash = hash_value(params.window_pos, hash);
+        hash = hash_value(params.window_size, hash);
+        hash = hash_value(params.blur_strength, hash);
+        hash = hash_value(params.blur_radius, hash);
+        hash = hash_value(params.blur_sigma, hash);
+        hash = hash_value(params.sampling, hash);
+        hash = hash_value(params.mode, hash);
+        return hash_value(params.downsample, hash);
+    }
+
+    // The same draw commands as content_hash, binned into the region's tiles by triangle bounds.
+    bool blur_renderer::content_tiles(blur_region& region, const ImDrawList* parent_list, const ImDrawCmd* cmd) {
+        const ImDrawData* draw_data = ImGui::GetDrawData();
+        if (!draw_data) return false;
+
+        int tile_size = region.params.dirty_tile_size;
+        if (region.tiles.width() != region.width || region.tiles.height() != region.height || region.tiles.tile_size() != tile_size) {
+            region.tiles.reset(region.width, region.height, tile_size);
+        }
+
+        region.tiles.begin(params_hash(region));
+        ImVec2 origin = region.params.window_pos;
+        for (int i = 0; i < draw_data->CmdListsCount; i++) {
+            const ImDrawList* list = draw_data->CmdLists[i];
+            bool parent = list == parent_list;
+            int cmd_end = parent ? static_cast<int>(cmd - list->CmdBuffer.Data) : list->CmdBuffer.Size;
+            region.tiles.add_draw_commands(*list, cmd_end, origin.x, origin.y);
+            change_stats_.hashed_bytes += list->VtxBuffer.Size * sizeof(ImDrawVert) + list->IdxBuffer.Size * sizeof(ImDrawIdx);
+            if (parent) return true;
+        }
+        return false;
+    }
 
-        blur_processed_ = true;
+    // Only live refreshes with detect_changes are skipped or, with tiles, narrowed to dirty_rects.
+    bool blur_renderer::content_changed(blur_region& region, const ImDrawList* parent_list, const ImDrawCmd* cmd) {
+        region.dirty_count = -1;
+        if (!region.params.live || !region.params.detect_changes) {
+            region.content.reset();
+            region.tiles.invalidate();
+            return true;
+        }
+
+        bool refresh = region.schedule.captured() && region.blurred;
+        auto start = std::chrono::steady_clock::now();
+        bool changed = true;
+
+        if (region.params.dirty_tile_size > 0) {
+            bool binned = content_tiles(region, parent_list, cmd);
+            int count = region.tiles.finish(kernel_apron({ region.params.blur_radius, region.params.blur_sigma, region.params.sampling },
+                region.params.blur_strength), region.dirty_rects, max_dirty_rects);
+
+            if (!binned) {
+                region.tiles.invalidate();
+            }
+            else if (refresh) {
+                changed = count > 0;
+                int64_t area = 0;
+                for (int i = 0; i < count; i++) area += rect_area(region.dirty_rects[i]);
+                if (changed && area < static_cast<int64_t>(region.width) * region.height) {
+                    region.dirty_count = count;
+                    change_stats_.partial++;
+                }
+                change_stats_.dirty_tiles += region.tiles.dirty_tiles();
+                change_stats_.tiles += region.tiles.tiles_x() * region.tiles.tiles_y();
+            }
+            region.content.reset();
+        }
+        else {
+            uint64_t hash = 0;
+            if (content_hash(region, parent_list, cmd, hash)) {
+                changed = region.content.update(hash) || !refresh;
+            }
+            else {
+                region.content.reset();
+            }
+        }
+
+        change_stats_.hash_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (refresh) {
+            change_stats_.checks++;
+            if (!changed) change_stats_.skipped++;
+        }
+        return changed;
+    }
+
+    void blur_renderer::blur_callback(const ImDrawList*, const ImDrawCmd* cmd) {
+        blur_renderer* renderer = static_cast<blur_renderer*>(cmd->UserCallbackData);
+        stats::scoped_timer timer(renderer->profiler_, stats::cpu_timer::blur);
+        BLUR_TRACE_SCOPE("blur");
+        renderer->process_blur(false);
+    }
+
+    void blur_renderer::backdrop_callback(const ImDrawList*, const ImDrawCmd* cmd) {
+        blur_renderer* renderer = static_cast<blur_renderer*>(cmd->UserCallbackData);
+        stats::scoped_timer timer(renderer->profiler_, stats::cpu_timer::blur);
+        BLUR_TRACE_SCOPE("backdrop blur");
+        renderer->process_blur(true);
+    }
+
+    void blur_renderer::composite_begin_callback(const ImDrawList*, const ImDrawCmd* cmd) {
+        blur_renderer* renderer = static_cast<blur_renderer*>(cmd->UserCallbackData);
+        renderer->composite_timestamp_ = renderer->timestamps_.begin(stats::stage::composite);
+    }
+
+    void blur_renderer::composite_end_callback(const ImDrawList*, const ImDrawCmd* cmd) {
+        blur_renderer* renderer = static_cast<blur_renderer*>(cmd->UserCallbackData);
+        renderer->timestamps_.end(renderer->composite_timestamp_);
+        renderer->composite_timestamp_ = -1;
+    }
+
+    // Reads every finished frame, then closes the previous one. Only capture and blur passes charge the live budget.
+    void blur_renderer::collect_gpu_timing() {
+        stats::frame_timing frame;
+        std::vector<stats::gpu_range>* ranges = trace::enabled() ? &gpu_ranges_ : nullptr;
+        while (timestamps_.collect(frame, ranges)) {
+            gpu_stats_.add(frame);
+            if (ranges) {
+                // The clocks are not correlated: a frame's ranges start where its first timestamp was issued.
+                for (const stats::gpu_range& range : gpu_ranges_) {
+                    trace::record_gpu(stats::stage_name(range.kind), frame.cpu_ns + static_cast<int64_t>(range.begin_ms * 1e6),
+                        frame.cpu_ns + static_cast<int64_t>(range.end_ms * 1e6));
+                }
+            }
+            if (frame.runs[static_cast<int>(stats::stage::capture)] == 0) continue;
+
+            gpu_time_ms_ = frame.total_ms - frame.stage_ms[static_cast<int>(stats::stage::resolve)] -
+                frame.stage_ms[static_cast<int>(stats::stage::composite)];
+            refresh_policy_.record_cost(gpu_time_ms_);
+        }
+
+        timestamps_.next_frame();
+
+        uint64_t lost = timestamps_.dropped() + timestamps_.disjoint();
+        gpu_stats_.add_lost_frames(lost - timestamps_lost_);
+        timestamps_lost_ = lost;
+    }
+
+    // The capture atlas itself, or every region reduced into target at its blur atlas rect.
+    ID3D11ShaderResourceView* blur_renderer::reduce_regions(ID3D11RenderTargetView* target, ID3D11ShaderResourceView* target_srv,
+        const int* indices, int count) {
+        int factor = regions_[indices[0]].downsample;
+        if (factor == 1) return capture_target_.srv;
+
+        for (int i = 0; i < count; i++) {
+            const blur_region& region = regions_[indices[i]];
+            const atlas_rect& rect = region.blur_rect;
+            atlas_rect blocks = { region.capture_rect.x, region.capture_rect.y, rect.width * factor, rect.height * factor };
+            add_instance(rect, blur_width_, blur_height_, blocks, region.capture_rect, capture_width_, capture_height_);
+        }
+        if (!update_constants(capture_width_, capture_height_, nullptr, factor)) {
+            cancel_pass();
+            return nullptr;
+        }
+        bool drawn = draw_pass(stats::stage::reduce, pipeline_->pixel_shader_downsample, capture_target_.srv, target, blur_width_, blur_height_);
+        return drawn ? target_srv : nullptr;
+    }
+
+    // Tap offsets are in texels of the texture being blurred, so reduced textures take shorter steps.
+    bool blur_renderer::process_gaussian(int* indices, int count) {
+        const blur_region& first = regions_[indices[0]];
+        int factor = first.downsample;
+        kernel_table table = make_kernel_table({ first.params.blur_radius, first.params.blur_sigma, first.params.sampling });
+
+        if (first.params.use_compute) {
+            count = process_gaussian_compute(table, indices, count);
+            if (count == 0) return true;
+        }
+
+        ID3D11ShaderResourceView* source = reduce_regions(blur_target_.rtv, blur_target_.srv, indices, count);
+        if (!source) return false;
+        int source_width = factor == 1 ? capture_width_ : blur_width_;
+        int source_height = factor == 1 ? capture_height_ : blur_height_;
+
+        // Dirty rects include the apron; the horizontal pass also covers the rows the vertical pass reads.
+        for (int i = 0; i < count; i++) {
+            const blur_region& region = regions_[indices[i]];
+            float strength = region.params.blur_strength / factor;
+            if (!partial_blur(region)) {
+                add_instance(region.blur_rect, blur_width_, blur_height_, source_rect(region), source_rect(region),
+                    source_width, source_height, strength);
+                continue;
+            }
+
+            int apron = kernel_apron({ region.params.blur_radius, region.params.blur_sigma, region.params.sampling }, strength);
+            for (int r = 0; r < region.dirty_count; r++) {
+                atlas_rect rows = expand_rect(region.dirty_rects[r], apron, region.width, region.height);
+                rows.x = region.dirty_rects[r].x;
+                rows.width = region.dirty_rects[r].width;
+                add_instance(sub_rect(region.blur_rect, rows), blur_width_, blur_height_, sub_rect(source_rect(region), rows),
+                    source_rect(region), source_width, source_height, strength);
+            }
+        }
+        if (!update_constants(source_width, source_height, &table)) return cancel_pass();
+        if (!draw_pass(stats::stage::horizontal, pipeline_->pixel_shader_horizontal, source, temp_target_.rtv, blur_width_, blur_height_)) {
+            return false;
+        }
+
+        for (int i = 0; i < count; i++) {
+            const blur_region& region = regions_[indices[i]];
+            float strength = region.params.blur_strength / factor;
+            if (!partial_blur(region)) {
+                add_instance(region.blur_rect, blur_width_, blur_height_, region.blur_rect, region.blur_rect,
+                    blur_width_, blur_height_, strength);
+                continue;
+            }
+
+            for (int r = 0; r < region.dirty_count; r++) {
+                atlas_rect rect = sub_rect(region.blur_rect, region.dirty_rects[r]);
+                add_instance(rect, blur_width_, blur_height_, rect, region.blur_rect, blur_width_, blur_height_, strength);
+            }
+        }
+        if (!update_constants(blur_width_, blur_height_, &table)) return cancel_pass();
+        return draw_pass(stats::stage::vertical, pipeline_->pixel_shader_vertical, temp_target_.srv, blur_target_.rtv, blur_width_, blur_height_);
+    }
+
+    // Regions whose kernel does not fit the apron are moved to the front of indices and their count returned.
+    int blur_renderer::process_gaussian_compute(const kernel_table& table, int* indices, int count) {
+        if (!pipeline_->compute_shader_blur || !blur_target_.uav) return count;
+
+        int factor = regions_[indices[0]].downsample;
+        ID3D11ShaderResourceView* source = reduce_regions(temp_target_.rtv, temp_target_.srv, indices, count);
+        int source_width = factor == 1 ? capture_width_ : blur_width_;
+        int source_height = factor == 1 ? capture_height_ : blur_height_;
+
+        ID3D11RenderTargetView* null_rtv = nullptr;
+        context()->OMSetRenderTargets(1, &null_rtv, nullptr);
+
+        context()->CSSetShader(pipeline_->compute_shader_blur, nullptr, 0);
+        context()->CSSetConstantBuffers(0, 1, &pipeline_->constant_buffer);
+        context()->CSSetShaderResources(0, 1, &source);
+        context()->CSSetUnorderedAccessViews(0, 1, &blur_target_.uav, nullptr);
+
+        int remaining = 0;
+        for (int i = 0; i < count; i++) {
+            const blur_region& region = regions_[indices[i]];
+            pixel_kernel kernel = make_pixel_kernel(table, region.params.blur_strength / factor);
+
+            kernel_table pixel_table;
+            pixel_table.tap_count = static_cast<int>(kernel.offsets.size());
+            bool dispatched = fits_compute_apron(kernel) && kernel.offsets.size() <= max_table_taps;
+            if (dispatched) {
+                for (int tap = 0; tap < pixel_table.tap_count; tap++) {
+                    pixel_table.taps[tap] = { static_cast<float>(kernel.offsets[tap]), kernel.weights[tap], { 0.0f, 0.0f } };
+                }
+                dispatched = update_constants(source_width, source_height, &pixel_table, 0, region.blur_rect, source_rect(region));
+            }
+
+            if (!dispatched) {
+                std::swap(indices[remaining++], indices[i]);
+                continue;
+            }
+
+            const atlas_rect& rect = region.blur_rect;
+            BLUR_TRACE_SCOPE("compute");
+            int timestamp = timestamps_.begin(stats::stage::compute);
+            context()->Dispatch((rect.width + compute_tile_size - 1) / compute_tile_size, (rect.height + compute_tile_size - 1) / compute_tile_size, 1);
+            timestamps_.end(timestamp);
+            counters_.passes++;
+        }
+
+        ID3D11ShaderResourceView* null_srv = nullptr;
+        ID3D11UnorderedAccessView* null_uav = nullptr;
+        context()->CSSetShaderResources(0, 1, &null_srv);
+        context()->CSSetUnorderedAccessViews(0, 1, &null_uav, nullptr);
+        context()->CSSetShader(nullptr, nullptr, 0);
+        return remaining;
+    }
+
+    // Level k holds every region at level_rect(blur_rect, k).
+    bool blur_renderer::process_dual_kawase(const int* indices, int count) {
+        const blur_region& first = regions_[indices[0]];
+        int factor = first.downsample;
+        int iterations = kawase_iterations(first.params.blur_radius * first.params.blur_strength / factor);
+        if (!ensure_kawase_levels(iterations)) return false;
+
+        ID3D11ShaderResourceView* source = reduce_regions(temp_target_.rtv, temp_target_.srv, indices, count);
+        if (!source) return false;
+        int source_width = factor == 1 ? capture_width_ : blur_width_;
+        int source_height = factor == 1 ? capture_height_ : blur_height_;
+
+        for (int i = 0; i < iterations; i++) {
+            const render_target& level = kawase_levels_[i];
+            for (int j = 0; j < count; j++) {
+                const blur_region& region = regions_[indices[j]];
+                atlas_rect from = i == 0 ? source_rect(region) : level_rect(region.blur_rect, i);
+                add_instance(level_rect(region.blur_rect, i + 1), level.width, level.height, from, from, source_width, source_height, 1.0f);
+            }
+            if (!update_constants(source_width, source_height, nullptr)) return cancel_pass();
+            if (!draw_pass(stats::stage::kawase, pipeline_->pixel_shader_kawase_down, source, level.rtv, level.width, level.height)) return false;
+            source = level.srv;
+            source_width = level.width;
+            source_height = level.height;
+        }
+
+        for (int i = iterations - 2; i >= -1; i--) {
+            ID3D11RenderTargetView* target = i >= 0 ? kawase_levels_[i].rtv : blur_target_.rtv;
+            int target_width = i >= 0 ? kawase_levels_[i].width : blur_width_;
+            int target_height = i >= 0 ? kawase_levels_[i].height : blur_height_;
+
+            for (int j = 0; j < count; j++) {
+                const blur_region& region = regions_[indices[j]];
+                atlas_rect from = level_rect(region.blur_rect, i + 2);
+                add_instance(level_rect(region.blur_rect, i + 1), target_width, target_height, from, from, source_width, source_height, 1.0f);
+            }
+            if (!update_constants(source_width, source_height, nullptr)) return cancel_pass();
+            if (!draw_pass(stats::stage::kawase, pipeline_->pixel_shader_kawase_up, source, target, target_width, target_height)) return false;
+            source = i >= 0 ? kawase_levels_[i].srv : blur_target_.srv;
+            source_width = target_width;
+            source_height = target_height;
+        }
+        return true;
+    }
+
+    // Level 0 is the (reduced) backdrop itself, every further level pyramid_down of the one above.
+    bool blur_renderer::process_pyramid(const blur_region& region) {
+        if (!pyramid_.texture || pyramid_.width != region.blur_rect.width || pyramid_.height != region.blur_rect.height) return false;
+
+        int index = static_cast<int>(&region - regions_);
+        if (!reduce_regions(blur_target_.rtv, blur_target_.srv, &index, 1)) return false;
+
+        const atlas_rect& rect = source_rect(region);
+        ID3D11Resource* source = region.downsample == 1 ? capture_target_.texture : blur_target_.texture;
+        D3D11_BOX box = { static_cast<UINT>(rect.x), static_cast<UINT>(rect.y), 0,
+            static_cast<UINT>(rect.x + rect.width), static_cast<UINT>(rect.y + rect.height), 1 };
+        int timestamp = timestamps_.begin(stats::stage::pyramid);
+        context()->CopySubresourceRegion(pyramid_.texture, 0, 0, 0, 0, source, 0, &box);
+        timestamps_.end(timestamp);
+
+        int source_width = pyramid_.width;
+        int source_height = pyramid_.height;
+        for (int level = 1; level < pyramid_.levels; level++) {
+            int level_width = std::max(1, pyramid_.width >> level);
+            int level_height = std::max(1, pyramid_.height >> level);
+
+            add_instance({ 0, 0, level_width, level_height }, level_width, level_height, { 0, 0, source_width, source_height },
+                { 0, 0, source_width, source_height }, source_width, source_height, 0.75f);
+            if (!update_constants(source_width, source_height, nullptr)) return cancel_pass();
+            if (!draw_pass(stats::stage::pyramid, pipeline_->pixel_shader_pyramid_down, pyramid_.level_srvs[level - 1],
+                    pyramid_.level_rtvs[level], level_width, level_height)) {
+                return false;
+            }
+            source_width = level_width;
+            source_height = level_height;
+        }
         return true;
     }
 
-    void blur_renderer::reset_state() {
-        background_captured_ = false;
-        blur_processed_ = false;
-        blur_capture_pending_ = false;
+    // Fills the blur atlas slot of every pyramid window drawn this frame from the part of the pyramid under it.
+    void blur_renderer::resolve_pyramid() {
+        const blur_region* backdrop = nullptr;
+        for (const blur_region& region : regions_) {
+            if (region.active && region.key == backdrop_key) backdrop = &region;
+        }
+        if (!pyramid_.srv || !backdrop || !backdrop->placed) return;
+
+        float scale = 1.0f / backdrop->downsample;
+        atlas_rect bounds = { 0, 0, pyramid_.width, pyramid_.height };
+        for (const blur_region& region : regions_) {
+            if (!region.active || !region.placed || region.key == backdrop_key || region.resolve_frame != current_frame_) continue;
+
+            const blur_params& params = region.params;
+            atlas_rect source = {
+                static_cast<int>(params.window_pos.x * scale), static_cast<int>(params.window_pos.y * scale),
+                std::max(1, static_cast<int>(params.window_size.x * scale)),
+                std::max(1, static_cast<int>(params.window_size.y * scale)) };
+            region_instance* instance = add_instance(region.blur_rect, blur_width_, blur_height_, source, bounds, pyramid_.width,
+                pyramid_.height);
+            if (instance) instance->lod = region.pyramid_lod;
+        }
+        draw_pass(stats::stage::resolve, pipeline_->pixel_shader_pyramid_resolve, pyramid_.srv, blur_target_.rtv, blur_width_, blur_height_);
     }
 
+    // Everything up to end_change_test runs only if the change test found a texel that differed.
+    bool blur_renderer::begin_change_test(blur_region& region) {
+        if (!region.reference_valid || !reference_target_.srv || !pipeline_->pixel_shader_change_test || !pipeline_->no_write_blend_state) return false;
+
+        int index = static_cast<int>(&region - regions_);
+        ID3D11Predicate*& predicate = change_predicates_[index];
+        if (!predicate) {
+            stats::scoped_timer timer(profiler_, stats::cpu_timer::create);
+            D3D11_QUERY_DESC desc = {};
+            desc.Query = D3D11_QUERY_OCCLUSION_PREDICATE;
+            if (FAILED(factory()->CreatePredicate(&desc, &predicate))) {
+                predicate = nullptr;
+                return false;
+            }
+        }
+
+        region_instance* instance = add_instance(region.blur_rect, blur_width_, blur_height_, region.capture_rect,
+            region.capture_rect, capture_width_, capture_height_);
+        if (instance) instance->threshold = region.params.change_threshold;
+        context()->PSSetShaderResources(1, 1, &reference_target_.srv);
+        context()->OMSetBlendState(pipeline_->no_write_blend_state, nullptr, 0xFFFFFFFF);
+        context()->Begin(predicate);
+        draw_pass(stats::stage::change_test, pipeline_->pixel_shader_change_test, capture_target_.srv, temp_target_.rtv, blur_width_, blur_height_);
+        context()->End(predicate);
+        context()->OMSetBlendState(pipeline_->blend_state, nullptr, 0xFFFFFFFF);
+
+        ID3D11ShaderResourceView* null_srv = nullptr;
+        context()->PSSetShaderResources(1, 1, &null_srv);
+
+        context()->SetPredication(predicate, FALSE);
+        region.test_pending = true;
+        change_test_stats_.tests++;
+        return true;
+    }
+
+    // Only a capture that was blurred becomes the reference, so creeping changes still add up.
+    void blur_renderer::end_change_test(blur_region& region, bool predicated) {
+        if (!reference_target_.texture &&
+            !texture_pool_.acquire(capture_width_, capture_height_, D3D11_BIND_SHADER_RESOURCE, reference_target_)) {
+            reference_target_ = {};
+        }
+
+        if (reference_target_.texture && region.captures) {
+            const atlas_rect& rect = region.capture_rect;
+            D3D11_BOX box = { static_cast<UINT>(rect.x), static_cast<UINT>(rect.y), 0,
+                static_cast<UINT>(rect.x + rect.width), static_cast<UINT>(rect.y + rect.height), 1 };
+            context()->CopySubresourceRegion(reference_target_.texture, 0, rect.x, rect.y, 0, capture_target_.texture, 0, &box);
+            region.reference_valid = true;
+        }
+
+        if (predicated) context()->SetPredication(nullptr, FALSE);
+    }
+
+    // Polls finished predicates for the statistics only; a result that is not ready yet is simply tried again later.
+    void blur_renderer::collect_change_tests() {
+        for (int i = 0; i < max_blur_regions; i++) {
+            blur_region& region = regions_[i];
+            if (!region.test_pending || !change_predicates_[i]) continue;
+
+            BOOL changed = FALSE;
+            if (context()->GetData(change_predicates_[i], &changed, sizeof(changed), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK) continue;
+
+            region.test_pending = false;
+            if (changed) change_test_stats_.changed++;
+            else change_test_stats_.unchanged++;
+        }
+    }
+
+    // Hands every target back to the pool; they are destroyed once idle for the pool's timeout.
     void blur_renderer::cleanup_render_targets() {
-        if (background_capture_) { background_capture_->Release(); background_capture_ = nullptr; }
-        if (background_srv_) { background_srv_->Release(); background_srv_ = nullptr; }
-        if (temp_texture_) { temp_texture_->Release(); temp_texture_ = nullptr; }
-        if (temp_rtv_) { temp_rtv_->Release(); temp_rtv_ = nullptr; }
-        if (temp_srv_) { temp_srv_->Release(); temp_srv_ = nullptr; }
-        if (blur_texture_) { blur_texture_->Release(); blur_texture_ = nullptr; }
-        if (blur_rtv_) { blur_rtv_->Release(); blur_rtv_ = nullptr; }
-        if (blur_srv_) { blur_srv_->Release(); blur_srv_ = nullptr; }
+        texture_pool_.release(capture_target_, frame_time_);
+        texture_pool_.release(reference_target_, frame_time_);
+        texture_pool_.release(temp_target_, frame_time_);
+        texture_pool_.release(blur_target_, frame_time_);
+        for (const render_target& level : kawase_levels_) texture_pool_.release(level, frame_time_);
+
+        capture_target_ = {};
+        reference_target_ = {};
+        temp_target_ = {};
+        blur_target_ = {};
+        kawase_levels_.clear();
+        capture_width_ = capture_height_ = blur_width_ = blur_height_ = 0;
     }
 
-    void blur_renderer::cleanup_all() {
+    // Everything bound to device_; its pipeline stays cached.
+    void blur_renderer::cleanup_device() {
         cleanup_render_targets();
+        texture_pool_.clear();
+        release_pyramid();
 
-        if (vertex_shader_) { vertex_shader_->Release(); vertex_shader_ = nullptr; }
-        if (pixel_shader_horizontal_) { pixel_shader_horizontal_->Release(); pixel_shader_horizontal_ = nullptr; }
-        if (pixel_shader_vertical_) { pixel_shader_vertical_->Release(); pixel_shader_vertical_ = nullptr; }
-        if (vertex_buffer_) { vertex_buffer_->Release(); vertex_buffer_ = nullptr; }
-        if (constant_buffer_) { constant_buffer_->Release(); constant_buffer_ = nullptr; }
-        if (input_layout_) { input_layout_->Release(); input_layout_ = nullptr; }
-        if (sampler_state_) { sampler_state_->Release(); sampler_state_ = nullptr; }
-        if (blend_state_) { blend_state_->Release(); blend_state_ = nullptr; }
-        if (rasterizer_state_) { rasterizer_state_->Release(); rasterizer_state_ = nullptr; }
+        for (ID3D11Predicate*& predicate : change_predicates_) {
+            if (predicate) { predicate->Release(); predicate = nullptr; }
+        }
+        timestamps_.reset();
+        timestamps_.source().release();
+        timestamps_.source().device = nullptr;
+        timestamps_.source().context = nullptr;
+        composite_timestamp_ = -1;
 
         if (context_) { context_->Release(); context_ = nullptr; }
 
+        if (pipeline_) pipelines_->release(device_, frame_time_);
+
         initialized_ = false;
+        pipeline_ = nullptr;
         device_ = nullptr;
     }
 
+    bool blur_renderer::release_device(ID3D11Device* device) {
+        if (device && device == device_) cleanup_device();
+        return pipelines_->evict(device);
+    }
+
+    bool d3d_pipeline_builder::create(ID3D11Device* device, pipeline& out) {
+        return renderer && device == renderer->device_ && renderer->initialize_shaders(out) && renderer->initialize_render_states(out);
+    }
+
     inline blur_renderer g_blur_renderer;
 
     inline bool render_blur_overlay(const blur_params& params, bool should_blur) {
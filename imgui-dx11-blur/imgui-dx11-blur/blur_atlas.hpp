@@ -0,0 +1,187 @@
+#ifndef BLUR_ATLAS_HPP
+#define BLUR_ATLAS_HPP
+
+#include <algorithm>
+#include <climits>
+#include <vector>
+
+namespace blur {
+
+    struct atlas_rect {
+        int x = 0;
+        int y = 0;
+        int width = 0;
+        int height = 0;
+    };
+
+    // Bottom-left skyline packer: a rect goes where its top ends lowest, leftmost on ties. Only reset() frees space.
+    class skyline_packer {
+    private:
+        struct segment {
+            int x;
+            int y;
+            int width;
+        };
+
+        std::vector<segment> skyline_;
+        int width_ = 0;
+        int height_ = 0;
+        int used_height_ = 0;
+
+        bool fit(size_t index, int width, int height, int& y) const {
+            int x = skyline_[index].x;
+            if (x + width > width_) return false;
+
+            y = 0;
+            int remaining = width;
+            for (size_t i = index; remaining > 0 && i < skyline_.size(); i++) {
+                y = std::max(y, skyline_[i].y);
+                if (y + height > height_) return false;
+                remaining -= skyline_[i].width;
+            }
+            return true;
+        }
+
+        // The segment a width x height rect would sit on, and its top edge; false if it fits nowhere.
+        bool find(int width, int height, size_t& best, int& best_top) const {
+            if (width <= 0 || height <= 0 || skyline_.empty()) return false;
+
+            best = skyline_.size();
+            best_top = INT_MAX;
+            for (size_t i = 0; i < skyline_.size(); i++) {
+                int y = 0;
+                if (fit(i, width, height, y) && y + height < best_top) {
+                    best = i;
+                    best_top = y + height;
+                }
+            }
+            return best != skyline_.size();
+        }
+
+    public:
+        void reset(int width, int height) {
+            width_ = width;
+            height_ = height;
+            used_height_ = 0;
+            skyline_.clear();
+            skyline_.push_back({ 0, 0, width });
+        }
+
+        bool fits(int width, int height) const {
+            size_t best;
+            int best_top;
+            return find(width, height, best, best_top);
+        }
+
+        bool pack(int width, int height, atlas_rect& rect) {
+            size_t best;
+            int best_top;
+            if (!find(width, height, best, best_top)) return false;
+
+            rect = { skyline_[best].x, best_top - height, width, height };
+            skyline_.insert(skyline_.begin() + best, segment{ rect.x, best_top, width });
+
+            // Trim the segments the new one now covers.
+            for (size_t i = best + 1; i < skyline_.size();) {
+                int overlap = skyline_[i - 1].x + skyline_[i - 1].width - skyline_[i].x;
+                if (overlap <= 0) break;
+                skyline_[i].x += overlap;
+                skyline_[i].width -= overlap;
+                if (skyline_[i].width > 0) break;
+                skyline_.erase(skyline_.begin() + i);
+            }
+
+            for (size_t i = 0; i + 1 < skyline_.size();) {
+                if (skyline_[i].y == skyline_[i + 1].y) {
+                    skyline_[i].width += skyline_[i + 1].width;
+                    skyline_.erase(skyline_.begin() + i + 1);
+                }
+                else {
+                    i++;
+                }
+            }
+
+            used_height_ = std::max(used_height_, best_top);
+            return true;
+        }
+
+        int width() const { return width_; }
+        int height() const { return height_; }
+        int used_height() const { return used_height_; }
+    };
+
+    // The rect covering `rect` in a texture halved `level` times; exact when the origin is a multiple of 1 << level.
+    inline atlas_rect level_rect(const atlas_rect& rect, int level) {
+        return { rect.x >> level, rect.y >> level, std::max(1, rect.width >> level), std::max(1, rect.height >> level) };
+    }
+
+    constexpr int default_atlas_alignment = 8;
+    constexpr int max_atlas_size = 8192;
+
+    // Slots are padded by one texel and aligned so bilinear taps and reductions never reach a neighbour.
+    class atlas_layout {
+    private:
+        skyline_packer packer_;
+        std::vector<int> order_;
+        int alignment_ = default_atlas_alignment;
+
+        int slot_size(int size) const { return (size + 1 + alignment_ - 1) / alignment_ * alignment_; }
+
+    public:
+        // rects[i] receives the origin and size of sizes[i]; width / height grow until everything fits.
+        bool pack(const atlas_rect* sizes, atlas_rect* rects, int count, int alignment, int& width, int& height) {
+            alignment_ = std::max(alignment, 1);
+            order_.resize(count);
+            for (int i = 0; i < count; i++) order_[i] = i;
+            std::sort(order_.begin(), order_.end(), [&](int a, int b) {
+                return sizes[a].height != sizes[b].height ? sizes[a].height > sizes[b].height : sizes[a].width > sizes[b].width;
+            });
+
+            int widest = alignment_;
+            int tallest = alignment_;
+            for (int i = 0; i < count; i++) {
+                widest = std::max(widest, slot_size(sizes[i].width));
+                tallest = std::max(tallest, slot_size(sizes[i].height));
+            }
+            width = std::max(width, widest);
+            height = std::max(height, tallest);
+            width = (width + alignment_ - 1) / alignment_ * alignment_;
+            height = (height + alignment_ - 1) / alignment_ * alignment_;
+
+            for (;;) {
+                packer_.reset(width, height);
+                bool packed = true;
+                for (int index : order_) {
+                    atlas_rect slot;
+                    if (!packer_.pack(slot_size(sizes[index].width), slot_size(sizes[index].height), slot)) {
+                        packed = false;
+                        break;
+                    }
+                    rects[index] = { slot.x, slot.y, sizes[index].width, sizes[index].height };
+                }
+                if (packed) return true;
+
+                if (width >= max_atlas_size && height >= max_atlas_size) return false;
+                if (width <= height && width < max_atlas_size) width = std::min(width * 2, max_atlas_size);
+                else height = std::min(height * 2, max_atlas_size);
+            }
+        }
+
+        // Whether insert() would succeed, without placing anything.
+        bool fits(int width, int height) const { return packer_.fits(slot_size(width), slot_size(height)); }
+
+        // Adds one region to the current layout without moving the others; false when it needs a full pack().
+        bool insert(int width, int height, atlas_rect& rect) {
+            atlas_rect slot;
+            if (!packer_.pack(slot_size(width), slot_size(height), slot)) return false;
+            rect = { slot.x, slot.y, width, height };
+            return true;
+        }
+
+        int alignment() const { return alignment_; }
+        int used_height() const { return packer_.used_height(); }
+    };
+
+}
+
+#endif
@@ -0,0 +1,690 @@
+#ifndef BLUR_CPU_HPP
+#define BLUR_CPU_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "blur_cpu_simd.hpp"
+#include "blur_kernel.hpp"
+#include "blur_thread_pool.hpp"
+
+namespace blur {
+namespace cpu {
+
+    // RGBA8 image, rows `stride` bytes apart. Mirrors the R8G8B8A8_UNORM textures blur_renderer works on.
+    struct image_view {
+        uint8_t* data = nullptr;
+        int width = 0;
+        int height = 0;
+        int stride = 0;
+    };
+
+    struct const_image_view {
+        const uint8_t* data = nullptr;
+        int width = 0;
+        int height = 0;
+        int stride = 0;
+
+        const_image_view() = default;
+        const_image_view(const uint8_t* data, int width, int height, int stride)
+            : data(data), width(width), height(height), stride(stride) {}
+        const_image_view(const image_view& view)
+            : data(view.data), width(view.width), height(view.height), stride(view.stride) {}
+    };
+
+    inline uint8_t to_unorm8(float value) {
+        value = std::min(std::max(value, 0.0f), 1.0f);
+        return static_cast<uint8_t>(value * 255.0f + 0.5f);
+    }
+
+    // Texture2D::Sample with MIN_MAG_MIP_LINEAR filtering and CLAMP addressing.
+    inline void sample_bilinear(const const_image_view& src, float u, float v, float out[4]) {
+        float x = u * src.width - 0.5f;
+        float y = v * src.height - 0.5f;
+        float x_floor = std::floor(x);
+        float y_floor = std::floor(y);
+        float fx = x - x_floor;
+        float fy = y - y_floor;
+
+        int x0 = std::min(std::max(static_cast<int>(x_floor), 0), src.width - 1);
+        int x1 = std::min(std::max(static_cast<int>(x_floor) + 1, 0), src.width - 1);
+        int y0 = std::min(std::max(static_cast<int>(y_floor), 0), src.height - 1);
+        int y1 = std::min(std::max(static_cast<int>(y_floor) + 1, 0), src.height - 1);
+
+        const uint8_t* row0 = src.data + static_cast<size_t>(y0) * src.stride;
+        const uint8_t* row1 = src.data + static_cast<size_t>(y1) * src.stride;
+
+        for (int c = 0; c < 4; c++) {
+            float top = row0[x0 * 4 + c] + (row0[x1 * 4 + c] - row0[x0 * 4 + c]) * fx;
+            float bottom = row1[x0 * 4 + c] + (row1[x1 * 4 + c] - row1[x0 * 4 + c]) * fx;
+            out[c] = (top + (bottom - top) * fy) * (1.0f / 255.0f);
+        }
+    }
+
+    // One horizontal (dx = 1) or vertical (dy = 1) blur pass per pixel: the reference the passes below must match to
+    // within one UNORM step.
+    inline bool reference_pass(const const_image_view& src, const image_view& dst, const kernel_table& table,
+        float blur_strength, int dx, int dy) {
+        if (!src.data || !dst.data || src.width <= 0 || src.height <= 0) return false;
+        if (src.width != dst.width || src.height != dst.height) return false;
+
+        float step_x = blur_strength / src.width * dx;
+        float step_y = blur_strength / src.height * dy;
+
+        for (int y = 0; y < dst.height; y++) {
+            uint8_t* out = dst.data + static_cast<size_t>(y) * dst.stride;
+            float v = (y + 0.5f) / src.height;
+
+            for (int x = 0; x < dst.width; x++) {
+                float u = (x + 0.5f) / src.width;
+                float color[4];
+                sample_bilinear(src, u, v, color);
+                for (int c = 0; c < 4; c++) color[c] *= table.taps[0].weight;
+
+                for (int i = 1; i < table.tap_count; i++) {
+                    float offset_u = step_x * table.taps[i].offset;
+                    float offset_v = step_y * table.taps[i].offset;
+                    float positive[4];
+                    float negative[4];
+                    sample_bilinear(src, std::min(std::max(u + offset_u, 0.0f), 1.0f), std::min(std::max(v + offset_v, 0.0f), 1.0f), positive);
+                    sample_bilinear(src, std::min(std::max(u - offset_u, 0.0f), 1.0f), std::min(std::max(v - offset_v, 0.0f), 1.0f), negative);
+                    for (int c = 0; c < 4; c++) color[c] += (positive[c] + negative[c]) * table.taps[i].weight;
+                }
+
+                for (int c = 0; c < 4; c++) out[x * 4 + c] = to_unorm8(color[c]);
+            }
+        }
+
+        return true;
+    }
+
+    inline bool reference_horizontal_pass(const const_image_view& src, const image_view& dst, float blur_strength,
+        const kernel_desc& desc = {}) {
+        return reference_pass(src, dst, make_kernel_table(desc), blur_strength, 1, 0);
+    }
+
+    inline bool reference_vertical_pass(const const_image_view& src, const image_view& dst, float blur_strength,
+        const kernel_desc& desc = {}) {
+        return reference_pass(src, dst, make_kernel_table(desc), blur_strength, 0, 1);
+    }
+
+    // Horizontal pass over columns [col_begin, col_end) of rows [row_begin, row_end). Row y is written to
+    // out + (y - row_begin) * out_stride; source columns past the image edge clamp to the edge pixel.
+    inline void horizontal_span(const const_image_view& src, const pixel_kernel& kernel, const row_kernels& kernels,
+        int col_begin, int col_end, int row_begin, int row_end, uint8_t* out, int out_stride, std::vector<float>& scratch) {
+        int lo = col_begin + std::min(kernel.min_offset, 0);
+        int hi = col_end + std::max(kernel.max_offset, 0);
+        int valid_lo = std::max(lo, 0);
+        int valid_hi = std::min(hi, src.width);
+        scratch.resize(static_cast<size_t>(hi - lo) * 4);
+
+        for (int y = row_begin; y < row_end; y++) {
+            const uint8_t* in = src.data + static_cast<size_t>(y) * src.stride;
+            float* padded = scratch.data();
+
+            kernels.widen(in + valid_lo * 4, padded + (valid_lo - lo) * 4, (valid_hi - valid_lo) * 4);
+            for (int x = lo; x < valid_lo; x++) std::copy_n(padded + (valid_lo - lo) * 4, 4, padded + (x - lo) * 4);
+            for (int x = valid_hi; x < hi; x++) std::copy_n(padded + (valid_hi - 1 - lo) * 4, 4, padded + (x - lo) * 4);
+
+            kernels.horizontal(padded + (col_begin - lo) * 4, out + static_cast<size_t>(y - row_begin) * out_stride,
+                col_end - col_begin, kernel.offsets.data(), kernel.weights.data(), static_cast<int>(kernel.offsets.size()));
+        }
+    }
+
+    // Vertical pass for rows [row_begin, row_end) of an image `image_height` rows tall. `band` holds the source
+    // rows starting at image row `band_top` and must cover every clamped tap; row y is written like horizontal_span.
+    inline void vertical_span(const const_image_view& band, int band_top, int image_height, const pixel_kernel& kernel,
+        const row_kernels& kernels, int row_begin, int row_end, uint8_t* out, int out_stride) {
+        const uint8_t* rows[max_kernel_taps];
+        int taps = static_cast<int>(kernel.offsets.size());
+
+        for (int y = row_begin; y < row_end; y++) {
+            for (int k = 0; k < taps; k++) {
+                int source_y = std::min(std::max(y + kernel.offsets[k], 0), image_height - 1);
+                rows[k] = band.data + static_cast<size_t>(source_y - band_top) * band.stride;
+            }
+            kernels.vertical(rows, out + static_cast<size_t>(y - row_begin) * out_stride, band.width * 4, kernel.weights.data(), taps);
+        }
+    }
+
+    inline bool horizontal_pass(const const_image_view& src, const image_view& dst, float blur_strength,
+        const kernel_desc& desc = {}) {
+        if (!src.data || !dst.data || src.width <= 0 || src.height <= 0) return false;
+        if (src.width != dst.width || src.height != dst.height) return false;
+
+        pixel_kernel kernel = make_pixel_kernel(blur_strength, desc);
+        if (kernel.offsets.size() > max_kernel_taps) return false;
+
+        std::vector<float> scratch;
+        horizontal_span(src, kernel, get_row_kernels(), 0, src.width, 0, src.height, dst.data, dst.stride, scratch);
+        return true;
+    }
+
+    inline bool vertical_pass(const const_image_view& src, const image_view& dst, float blur_strength,
+        const kernel_desc& desc = {}) {
+        if (!src.data || !dst.data || src.width <= 0 || src.height <= 0) return false;
+        if (src.width != dst.width || src.height != dst.height) return false;
+
+        pixel_kernel kernel = make_pixel_kernel(blur_strength, desc);
+        if (kernel.offsets.size() > max_kernel_taps) return false;
+
+        vertical_span(src, 0, src.height, kernel, get_row_kernels(), 0, src.height, dst.data, dst.stride);
+        return true;
+    }
+
+    // shaders::blur_compute_source group by group, in float like groupshared memory. Fails if the kernel reaches
+    // past the apron.
+    inline bool emulate_compute_blur(const const_image_view& src, const image_view& dst, const pixel_kernel& kernel) {
+        if (!src.data || !dst.data || src.width <= 0 || src.height <= 0) return false;
+        if (src.width != dst.width || src.height != dst.height) return false;
+        if (!fits_compute_apron(kernel)) return false;
+
+        constexpr int span = compute_tile_size + 2 * compute_apron;
+        std::vector<float> input_tile(span * span * 4);
+        std::vector<float> row_tile(span * compute_tile_size * 4);
+        int taps = static_cast<int>(kernel.offsets.size());
+
+        int groups_x = (src.width + compute_tile_size - 1) / compute_tile_size;
+        int groups_y = (src.height + compute_tile_size - 1) / compute_tile_size;
+
+        for (int group_y = 0; group_y < groups_y; group_y++) {
+            for (int group_x = 0; group_x < groups_x; group_x++) {
+                int origin_x = group_x * compute_tile_size - compute_apron;
+                int origin_y = group_y * compute_tile_size - compute_apron;
+
+                for (int y = 0; y < span; y++) {
+                    int source_y = std::min(std::max(origin_y + y, 0), src.height - 1);
+                    for (int x = 0; x < span; x++) {
+                        int source_x = std::min(std::max(origin_x + x, 0), src.width - 1);
+                        const uint8_t* texel = src.data + static_cast<size_t>(source_y) * src.stride + source_x * 4;
+                        for (int c = 0; c < 4; c++) input_tile[(y * span + x) * 4 + c] = texel[c] * (1.0f / 255.0f);
+                    }
+                }
+
+                for (int y = 0; y < span; y++) {
+                    for (int x = 0; x < compute_tile_size; x++) {
+                        float color[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+                        for (int k = 0; k < taps; k++) {
+                            const float* texel = &input_tile[(y * span + x + compute_apron + kernel.offsets[k]) * 4];
+                            for (int c = 0; c < 4; c++) color[c] += texel[c] * kernel.weights[k];
+                        }
+                        std::copy(color, color + 4, &row_tile[(y * compute_tile_size + x) * 4]);
+                    }
+                }
+
+                for (int y = 0; y < compute_tile_size; y++) {
+                    int out_y = group_y * compute_tile_size + y;
+                    if (out_y >= dst.height) break;
+
+                    for (int x = 0; x < compute_tile_size; x++) {
+                        int out_x = group_x * compute_tile_size + x;
+                        if (out_x >= dst.width) break;
+
+                        float color[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+                        for (int k = 0; k < taps; k++) {
+                            const float* texel = &row_tile[((y + compute_apron + kernel.offsets[k]) * compute_tile_size + x) * 4];
+                            for (int c = 0; c < 4; c++) color[c] += texel[c] * kernel.weights[k];
+                        }
+                        uint8_t* out = dst.data + static_cast<size_t>(out_y) * dst.stride + out_x * 4;
+                        for (int c = 0; c < 4; c++) out[c] = to_unorm8(color[c]);
+                    }
+                }
+            }
+        }
+
+        return true;
+    }
+
+    // shaders::kawase_down_source or kawase_up_source for rows [row_begin, row_end) of dst; offset is in source
+    // texels.
+    inline void kawase_rows(const const_image_view& src, const image_view& dst, bool up, float offset, int row_begin, int row_end) {
+        static const float down_taps[5][3] = { { 0.0f, 0.0f, 4.0f }, { -1.0f, -1.0f, 1.0f }, { 1.0f, 1.0f, 1.0f }, { 1.0f, -1.0f, 1.0f }, { -1.0f, 1.0f, 1.0f } };
+        static const float up_taps[8][3] = { { -1.0f, 0.0f, 1.0f }, { 1.0f, 0.0f, 1.0f }, { 0.0f, -1.0f, 1.0f }, { 0.0f, 1.0f, 1.0f },
+            { -0.5f, -0.5f, 2.0f }, { 0.5f, -0.5f, 2.0f }, { -0.5f, 0.5f, 2.0f }, { 0.5f, 0.5f, 2.0f } };
+        const float (*taps)[3] = up ? up_taps : down_taps;
+        int tap_count = up ? 8 : 5;
+        float divisor = up ? 12.0f : 8.0f;
+
+        float step_u = offset / src.width;
+        float step_v = offset / src.height;
+
+        for (int y = row_begin; y < row_end; y++) {
+            uint8_t* out = dst.data + static_cast<size_t>(y) * dst.stride;
+            float v = (y + 0.5f) / dst.height;
+
+            for (int x = 0; x < dst.width; x++) {
+                float u = (x + 0.5f) / dst.width;
+                float color[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+                for (int k = 0; k < tap_count; k++) {
+                    float texel[4];
+                    sample_bilinear(src, u + taps[k][0] * step_u, v + taps[k][1] * step_v, texel);
+                    for (int c = 0; c < 4; c++) color[c] += texel[c] * taps[k][2];
+                }
+
+                for (int c = 0; c < 4; c++) out[x * 4 + c] = to_unorm8(color[c] / divisor);
+            }
+        }
+    }
+
+    inline bool kawase_down_pass(const const_image_view& src, const image_view& dst, float offset = 1.0f) {
+        if (!src.data || !dst.data || src.width <= 0 || src.height <= 0 || dst.width <= 0 || dst.height <= 0) return false;
+        kawase_rows(src, dst, false, offset, 0, dst.height);
+        return true;
+    }
+
+    inline bool kawase_up_pass(const const_image_view& src, const image_view& dst, float offset = 1.0f) {
+        if (!src.data || !dst.data || src.width <= 0 || src.height <= 0 || dst.width <= 0 || dst.height <= 0) return false;
+        kawase_rows(src, dst, true, offset, 0, dst.height);
+        return true;
+    }
+
+    // shaders::downsample_source: each dst texel averages a factor x factor block of src, fetched as (factor / 2)^2
+    // bilinear samples between texel pairs. Blocks hanging over the right or bottom edge repeat the last texel (clamp).
+    inline bool downsample_box(const const_image_view& src, const image_view& dst, int factor) {
+        if (!src.data || !dst.data || src.width <= 0 || src.height <= 0) return false;
+        factor = downsample_factor(factor);
+        if (dst.width != downsampled_size(src.width, factor) || dst.height != downsampled_size(src.height, factor)) return false;
+
+        int half_factor = factor / 2;
+        for (int y = 0; y < dst.height; y++) {
+            uint8_t* out = dst.data + static_cast<size_t>(y) * dst.stride;
+
+            for (int x = 0; x < dst.width; x++) {
+                if (factor == 1) {
+                    std::copy_n(src.data + static_cast<size_t>(y) * src.stride + x * 4, 4, out + x * 4);
+                    continue;
+                }
+
+                float color[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+                for (int j = 0; j < half_factor; j++) {
+                    for (int i = 0; i < half_factor; i++) {
+                        float texel[4];
+                        sample_bilinear(src, ((x + 0.5f) * factor + 2 * i + 1 - half_factor) / src.width,
+                            ((y + 0.5f) * factor + 2 * j + 1 - half_factor) / src.height, texel);
+                        for (int c = 0; c < 4; c++) color[c] += texel[c];
+                    }
+                }
+
+                for (int c = 0; c < 4; c++) out[x * 4 + c] = to_unorm8(color[c] / (half_factor * half_factor));
+            }
+        }
+        return true;
+    }
+
+    // The composite in blur_renderer::render: AddImageRounded stretches the reduced texture over the window with the
+    // linear sampler, using only the part of it that covers whole source pixels.
+    inline bool upsample_bilinear(const const_image_view& src, const image_view& dst, int factor) {
+        if (!src.data || !dst.data || src.width <= 0 || src.height <= 0 || dst.width <= 0 || dst.height <= 0) return false;
+        factor = downsample_factor(factor);
+
+        float scale_u = 1.0f / (static_cast<float>(src.width) * factor);
+        float scale_v = 1.0f / (static_cast<float>(src.height) * factor);
+
+        for (int y = 0; y < dst.height; y++) {
+            uint8_t* out = dst.data + static_cast<size_t>(y) * dst.stride;
+            for (int x = 0; x < dst.width; x++) {
+                float texel[4];
+                sample_bilinear(src, (x + 0.5f) * scale_u, (y + 0.5f) * scale_v, texel);
+                for (int c = 0; c < 4; c++) out[x * 4 + c] = to_unorm8(texel[c]);
+            }
+        }
+        return true;
+    }
+
+    // shaders::pyramid_down_source for rows [row_begin, row_end) of dst: four bilinear taps at +-offset source texels
+    // around each dst texel centre, averaged.
+    inline void pyramid_down_rows(const const_image_view& src, const image_view& dst, float offset, int row_begin, int row_end) {
+        float step_u = offset / src.width;
+        float step_v = offset / src.height;
+
+        for (int y = row_begin; y < row_end; y++) {
+            uint8_t* out = dst.data + static_cast<size_t>(y) * dst.stride;
+            float v = (y + 0.5f) / dst.height;
+
+            for (int x = 0; x < dst.width; x++) {
+                float u = (x + 0.5f) / dst.width;
+                float color[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+                for (int k = 0; k < 4; k++) {
+                    float texel[4];
+                    sample_bilinear(src, u + (k & 1 ? step_u : -step_u), v + (k & 2 ? step_v : -step_v), texel);
+                    for (int c = 0; c < 4; c++) color[c] += texel[c];
+                }
+                for (int c = 0; c < 4; c++) out[x * 4 + c] = to_unorm8(color[c] * 0.25f);
+            }
+        }
+    }
+
+    inline bool pyramid_down_pass(const const_image_view& src, const image_view& dst, float offset = 0.75f) {
+        if (!src.data || !dst.data || src.width <= 0 || src.height <= 0) return false;
+        if (dst.width != std::max(1, src.width / 2) || dst.height != std::max(1, src.height / 2)) return false;
+        pyramid_down_rows(src, dst, offset, 0, dst.height);
+        return true;
+    }
+
+    // shaders::pyramid_resolve_source for rows [row_begin, row_end) of dst, which covers the whole of levels[0]:
+    // SampleLevel with MIN_MAG_MIP_LINEAR, i.e. bilinear in the two levels around lod and linear between them.
+    inline void pyramid_resolve_rows(const const_image_view* levels, int level_count, const image_view& dst, float lod,
+        int row_begin, int row_end) {
+        lod = std::min(std::max(lod, 0.0f), static_cast<float>(level_count - 1));
+        int fine = static_cast<int>(lod);
+        int coarse = std::min(fine + 1, level_count - 1);
+        float blend = lod - fine;
+
+        for (int y = row_begin; y < row_end; y++) {
+            uint8_t* out = dst.data + static_cast<size_t>(y) * dst.stride;
+            float v = (y + 0.5f) / dst.height;
+
+            for (int x = 0; x < dst.width; x++) {
+                float u = (x + 0.5f) / dst.width;
+                float a[4];
+                float b[4];
+                sample_bilinear(levels[fine], u, v, a);
+                sample_bilinear(levels[coarse], u, v, b);
+                for (int c = 0; c < 4; c++) out[x * 4 + c] = to_unorm8(a[c] + (b[c] - a[c]) * blend);
+            }
+        }
+    }
+
+    // shaders::change_test_source over a grid_width x grid_height target: the sample count the predicate sees.
+    inline uint64_t changed_texels(const const_image_view& current, const const_image_view& reference, int grid_width,
+        int grid_height, float threshold) {
+        if (!current.data || !reference.data || current.width != reference.width || current.height != reference.height) return 0;
+
+        uint64_t count = 0;
+        for (int y = 0; y < grid_height; y++) {
+            float v = (y + 0.5f) / grid_height;
+            for (int x = 0; x < grid_width; x++) {
+                float u = (x + 0.5f) / grid_width;
+                float a[4];
+                float b[4];
+                sample_bilinear(current, u, v, a);
+                sample_bilinear(reference, u, v, b);
+                float difference = std::max(std::fabs(a[0] - b[0]), std::max(std::fabs(a[1] - b[1]), std::fabs(a[2] - b[2])));
+                if (difference > threshold) count++;
+            }
+        }
+        return count;
+    }
+
+    // blur_renderer's change test for one region: the first capture always blurs, later ones only when they differ
+    // from the reference, and the reference is replaced only by captures that were blurred.
+    class change_tester {
+    private:
+        std::vector<uint8_t> reference_;
+        int width_ = 0;
+        int height_ = 0;
+
+    public:
+        bool test(const const_image_view& capture, int grid_width, int grid_height, float threshold) {
+            if (!capture.data || capture.width <= 0 || capture.height <= 0) return false;
+
+            bool valid = width_ == capture.width && height_ == capture.height;
+            const_image_view reference(reference_.data(), width_, height_, width_ * 4);
+            if (valid && threshold > 0.0f && changed_texels(capture, reference, grid_width, grid_height, threshold) == 0) return false;
+
+            width_ = capture.width;
+            height_ = capture.height;
+            reference_.resize(static_cast<size_t>(width_) * height_ * 4);
+            for (int y = 0; y < height_; y++) {
+                std::copy_n(capture.data + static_cast<size_t>(y) * capture.stride, width_ * 4,
+                    reference_.data() + static_cast<size_t>(y) * width_ * 4);
+            }
+            return true;
+        }
+
+        void reset() { width_ = height_ = 0; }
+    };
+
+    // Peak signal-to-noise ratio over all four channels in dB; infinity for identical images, 0 on a size mismatch.
+    inline double psnr(const const_image_view& a, const const_image_view& b) {
+        if (!a.data || !b.data || a.width != b.width || a.height != b.height || a.width <= 0 || a.height <= 0) return 0.0;
+
+        double squared_error = 0.0;
+        for (int y = 0; y < a.height; y++) {
+            const uint8_t* row_a = a.data + static_cast<size_t>(y) * a.stride;
+            const uint8_t* row_b = b.data + static_cast<size_t>(y) * b.stride;
+            for (int x = 0; x < a.width * 4; x++) {
+                double diff = static_cast<double>(row_a[x]) - row_b[x];
+                squared_error += diff * diff;
+            }
+        }
+
+        if (squared_error == 0.0) return std::numeric_limits<double>::infinity();
+        double mse = squared_error / (static_cast<double>(a.width) * a.height * 4);
+        return 10.0 * std::log10(255.0 * 255.0 / mse);
+    }
+
+    struct kawase_level_timing {
+        int width = 0;
+        int height = 0;
+        double down_seconds = 0.0;
+        double up_seconds = 0.0;
+    };
+
+    // CPU counterpart of blur_renderer::process_blur. Each tile runs the horizontal pass over its rows plus a
+    // kernel-radius halo, then the vertical pass, so tiles are independent and spread over a thread_pool.
+    class cpu_blur_renderer {
+    private:
+        struct tile_scratch {
+            std::vector<float> row;
+            std::vector<uint8_t> band;
+        };
+
+        std::unique_ptr<thread_pool> pool_;
+        std::vector<tile_scratch> scratch_;
+        std::vector<uint8_t> temp_;
+        std::vector<uint8_t> reduced_;
+        std::vector<uint8_t> reduced_blur_;
+        std::vector<std::vector<uint8_t>> kawase_levels_;
+        std::vector<kawase_level_timing> kawase_timings_;
+        std::vector<std::vector<uint8_t>> pyramid_storage_;
+        std::vector<const_image_view> pyramid_levels_;
+        int thread_count_ = 0;
+        int tile_size_ = 256;
+
+        thread_pool& pool() {
+            if (!pool_) {
+                pool_ = std::make_unique<thread_pool>(thread_count_);
+                scratch_.resize(pool_->thread_count());
+            }
+            return *pool_;
+        }
+
+    public:
+        explicit cpu_blur_renderer(int thread_count = 0, int tile_size = 256)
+            : thread_count_(thread_count), tile_size_(std::max(tile_size, 16)) {}
+
+        // 0 sizes the pool to std::thread::hardware_concurrency().
+        void set_thread_count(int thread_count) {
+            if (thread_count == thread_count_) return;
+            thread_count_ = thread_count;
+            pool_.reset();
+            scratch_.clear();
+        }
+
+        void set_tile_size(int tile_size) { tile_size_ = std::max(tile_size, 16); }
+
+        int thread_count() { return pool().thread_count(); }
+        int tile_size() const { return tile_size_; }
+
+        const std::vector<worker_stats>& thread_stats() { return pool().stats(); }
+        std::vector<double> thread_utilization() { return pool().utilization(); }
+        void reset_thread_stats() { pool().reset_stats(); }
+
+        bool process(const const_image_view& src, const image_view& dst, float blur_strength,
+            const kernel_desc& desc = {}) {
+            if (!src.data || !dst.data || src.width <= 0 || src.height <= 0) return false;
+            if (src.width != dst.width || src.height != dst.height) return false;
+
+            pixel_kernel kernel = make_pixel_kernel(blur_strength, desc);
+            if (kernel.offsets.size() > max_kernel_taps) return false;
+
+            row_kernels kernels = get_row_kernels();
+            int tiles_x = (src.width + tile_size_ - 1) / tile_size_;
+            int tiles_y = (src.height + tile_size_ - 1) / tile_size_;
+
+            pool().parallel_for(tiles_x * tiles_y, [&](int index, int slot) {
+                int x0 = (index % tiles_x) * tile_size_;
+                int y0 = (index / tiles_x) * tile_size_;
+                int x1 = std::min(x0 + tile_size_, src.width);
+                int y1 = std::min(y0 + tile_size_, src.height);
+                int band_top = std::max(y0 + std::min(kernel.min_offset, 0), 0);
+                int band_bottom = std::min(y1 + std::max(kernel.max_offset, 0), src.height);
+
+                tile_scratch& scratch = scratch_[slot];
+                int band_stride = (x1 - x0) * 4;
+                scratch.band.resize(static_cast<size_t>(band_bottom - band_top) * band_stride);
+
+                horizontal_span(src, kernel, kernels, x0, x1, band_top, band_bottom, scratch.band.data(), band_stride, scratch.row);
+
+                const_image_view band(scratch.band.data(), x1 - x0, band_bottom - band_top, band_stride);
+                vertical_span(band, band_top, src.height, kernel, kernels, y0, y1,
+                    dst.data + static_cast<size_t>(y0) * dst.stride + x0 * 4, dst.stride);
+            });
+
+            return true;
+        }
+
+        // blur_params::downsample: reduce by factor, blur with the tap spacing scaled down to match, stretch back.
+        // Compare against process() at factor 1 with psnr() to judge the quality cost of a factor.
+        bool process_downsampled(const const_image_view& src, const image_view& dst, float blur_strength, int factor,
+            const kernel_desc& desc = {}) {
+            if (!src.data || !dst.data || src.width <= 0 || src.height <= 0) return false;
+            if (src.width != dst.width || src.height != dst.height) return false;
+
+            factor = downsample_factor(factor);
+            if (factor == 1) return process(src, dst, blur_strength, desc);
+
+            int width = downsampled_size(src.width, factor);
+            int height = downsampled_size(src.height, factor);
+            reduced_.resize(static_cast<size_t>(width) * height * 4);
+            reduced_blur_.resize(reduced_.size());
+            image_view reduced = { reduced_.data(), width, height, width * 4 };
+            image_view reduced_blur = { reduced_blur_.data(), width, height, width * 4 };
+
+            return downsample_box(src, reduced, factor) &&
+                process(reduced, reduced_blur, blur_strength / factor, desc) &&
+                upsample_bilinear(reduced_blur, dst, factor);
+        }
+
+        // Same chain as blur_renderer::process_dual_kawase; pass kawase_iterations(radius) to match the GPU.
+        bool process_dual_kawase(const const_image_view& src, const image_view& dst, int iterations, float offset = 1.0f) {
+            if (!src.data || !dst.data || src.width <= 0 || src.height <= 0) return false;
+            if (src.width != dst.width || src.height != dst.height) return false;
+
+            iterations = std::min(std::max(iterations, 1), max_kawase_iterations);
+            kawase_levels_.resize(iterations);
+            kawase_timings_.assign(iterations, kawase_level_timing{});
+
+            std::vector<image_view> levels(iterations);
+            int level_width = src.width;
+            int level_height = src.height;
+            for (int i = 0; i < iterations; i++) {
+                level_width = std::max(1, level_width / 2);
+                level_height = std::max(1, level_height / 2);
+                kawase_levels_[i].resize(static_cast<size_t>(level_width) * level_height * 4);
+                levels[i] = { kawase_levels_[i].data(), level_width, level_height, level_width * 4 };
+                kawase_timings_[i].width = level_width;
+                kawase_timings_[i].height = level_height;
+            }
+
+            auto run = [&](const const_image_view& from, const image_view& to, bool up) {
+                auto start = std::chrono::steady_clock::now();
+                int bands = (to.height + tile_size_ - 1) / tile_size_;
+                pool().parallel_for(bands, [&](int band, int) {
+                    kawase_rows(from, to, up, offset, band * tile_size_, std::min((band + 1) * tile_size_, to.height));
+                });
+                return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            };
+
+            const_image_view source = src;
+            for (int i = 0; i < iterations; i++) {
+                kawase_timings_[i].down_seconds = run(source, levels[i], false);
+                source = levels[i];
+            }
+            for (int i = iterations - 2; i >= -1; i--) {
+                const image_view& target = i >= 0 ? levels[i] : dst;
+                kawase_timings_[i + 1].up_seconds = run(source, target, true);
+                source = target;
+            }
+
+            return true;
+        }
+
+        // Same chain as blur_renderer::process_pyramid: level 0 is a copy of src, each further level pyramid_down_pass
+        // of the one above. Built once, then resolve_pyramid serves any number of strengths from it.
+        bool build_pyramid(const const_image_view& src, int levels = max_pyramid_levels) {
+            if (!src.data || src.width <= 0 || src.height <= 0) return false;
+
+            levels = std::min(std::max(levels, 1), pyramid_levels(src.width, src.height));
+            pyramid_storage_.resize(levels);
+            pyramid_levels_.resize(levels);
+
+            int level_width = src.width;
+            int level_height = src.height;
+            for (int i = 0; i < levels; i++) {
+                pyramid_storage_[i].resize(static_cast<size_t>(level_width) * level_height * 4);
+                image_view level = { pyramid_storage_[i].data(), level_width, level_height, level_width * 4 };
+                int bands = (level_height + tile_size_ - 1) / tile_size_;
+
+                if (i == 0) {
+                    for (int y = 0; y < level_height; y++) {
+                        std::copy_n(src.data + static_cast<size_t>(y) * src.stride, level.stride, level.data + static_cast<size_t>(y) * level.stride);
+                    }
+                }
+                else {
+                    const_image_view above = pyramid_levels_[i - 1];
+                    pool().parallel_for(bands, [&](int band, int) {
+                        pyramid_down_rows(above, level, 0.75f, band * tile_size_, std::min((band + 1) * tile_size_, level_height));
+                    });
+                }
+
+                pyramid_levels_[i] = level;
+                level_width = std::max(1, level_width / 2);
+                level_height = std::max(1, level_height / 2);
+            }
+            return true;
+        }
+
+        // dst is the size of the image given to build_pyramid; sigma is in its texels, see pyramid_lod.
+        bool resolve_pyramid(const image_view& dst, float sigma) {
+            if (pyramid_levels_.empty() || !dst.data) return false;
+            if (dst.width != pyramid_levels_[0].width || dst.height != pyramid_levels_[0].height) return false;
+
+            float lod = pyramid_lod(sigma);
+            int bands = (dst.height + tile_size_ - 1) / tile_size_;
+            pool().parallel_for(bands, [&](int band, int) {
+                pyramid_resolve_rows(pyramid_levels_.data(), static_cast<int>(pyramid_levels_.size()), dst, lod,
+                    band * tile_size_, std::min((band + 1) * tile_size_, dst.height));
+            });
+            return true;
+        }
+
+        const std::vector<const_image_view>& pyramid() const { return pyramid_levels_; }
+
+        // Per level of the last process_dual_kawase call: level size, time to produce it and time to upsample from it.
+        const std::vector<kawase_level_timing>& kawase_timings() const { return kawase_timings_; }
+
+        bool process_reference(const const_image_view& src, const image_view& dst, float blur_strength,
+            const kernel_desc& desc = {}) {
+            if (!src.data || !dst.data || src.width <= 0 || src.height <= 0) return false;
+            if (src.width != dst.width || src.height != dst.height) return false;
+
+            temp_.resize(static_cast<size_t>(src.width) * src.height * 4);
+            image_view temp = { temp_.data(), src.width, src.height, src.width * 4 };
+
+            return reference_horizontal_pass(src, temp, blur_strength, desc) &&
+                reference_vertical_pass(temp, dst, blur_strength, desc);
+        }
+    };
+
+}
+}
+
+#endif
@@ -0,0 +1,403 @@
+#ifndef BLUR_CPU_SIMD_HPP
+#define BLUR_CPU_SIMD_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define BLUR_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define BLUR_TARGET_AVX2
+#else
+#include <cpuid.h>
+#define BLUR_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define BLUR_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace blur {
+namespace cpu {
+
+    enum class kernel_isa {
+        scalar,
+        sse2,
+        avx2,
+        neon
+    };
+
+    inline const char* kernel_isa_name(kernel_isa isa) {
+        switch (isa) {
+        case kernel_isa::sse2: return "sse2";
+        case kernel_isa::avx2: return "avx2";
+        case kernel_isa::neon: return "neon";
+        default: return "scalar";
+        }
+    }
+
+    // Row kernels per instruction set, on RGBA pixels held as 0..255 floats; horizontal reads an already padded row.
+    struct row_kernels {
+        void (*widen)(const uint8_t* src, float* dst, int count);
+        void (*horizontal)(const float* row, uint8_t* out, int width, const int* offsets, const float* weights, int taps);
+        void (*vertical)(const uint8_t* const* rows, uint8_t* out, int count, const float* weights, int taps);
+    };
+
+    // Upper bound on taps per row kernel call; the vertical tails keep row pointers on the stack.
+    constexpr int max_kernel_taps = 512;
+
+    namespace detail {
+
+        inline uint8_t round_to_u8(float value) {
+            return static_cast<uint8_t>(std::min(std::max(value + 0.5f, 0.0f), 255.0f));
+        }
+
+        inline void widen_scalar(const uint8_t* src, float* dst, int count) {
+            for (int i = 0; i < count; i++) dst[i] = static_cast<float>(src[i]);
+        }
+
+        inline void horizontal_scalar(const float* row, uint8_t* out, int width, const int* offsets, const float* weights, int taps) {
+            for (int x = 0; x < width; x++) {
+                float color[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+                for (int k = 0; k < taps; k++) {
+                    const float* texel = row + static_cast<ptrdiff_t>(x + offsets[k]) * 4;
+                    for (int c = 0; c < 4; c++) color[c] += texel[c] * weights[k];
+                }
+                for (int c = 0; c < 4; c++) out[x * 4 + c] = round_to_u8(color[c]);
+            }
+        }
+
+        inline void vertical_scalar(const uint8_t* const* rows, uint8_t* out, int count, const float* weights, int taps) {
+            for (int i = 0; i < count; i++) {
+                float value = 0.0f;
+                for (int k = 0; k < taps; k++) value += rows[k][i] * weights[k];
+                out[i] = round_to_u8(value);
+            }
+        }
+
+#if defined(BLUR_SIMD_X86)
+        inline __m128i pack_sse2(__m128 a, __m128 b, __m128 c, __m128 d) {
+            const __m128 half = _mm_set1_ps(0.5f);
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 max = _mm_set1_ps(255.0f);
+            __m128i ia = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_add_ps(a, half), zero), max));
+            __m128i ib = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_add_ps(b, half), zero), max));
+            __m128i ic = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_add_ps(c, half), zero), max));
+            __m128i id = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_add_ps(d, half), zero), max));
+            return _mm_packus_epi16(_mm_packs_epi32(ia, ib), _mm_packs_epi32(ic, id));
+        }
+
+        inline void widen_sse2(const uint8_t* src, float* dst, int count) {
+            const __m128i zero = _mm_setzero_si128();
+            int i = 0;
+            for (; i + 16 <= count; i += 16) {
+                __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+                __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+                _mm_storeu_ps(dst + i, _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)));
+                _mm_storeu_ps(dst + i + 4, _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)));
+                _mm_storeu_ps(dst + i + 8, _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)));
+                _mm_storeu_ps(dst + i + 12, _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)));
+            }
+            widen_scalar(src + i, dst + i, count - i);
+        }
+
+        inline void horizontal_sse2(const float* row, uint8_t* out, int width, const int* offsets, const float* weights, int taps) {
+            int x = 0;
+            for (; x + 4 <= width; x += 4) {
+                __m128 acc0 = _mm_setzero_ps();
+                __m128 acc1 = _mm_setzero_ps();
+                __m128 acc2 = _mm_setzero_ps();
+                __m128 acc3 = _mm_setzero_ps();
+                for (int k = 0; k < taps; k++) {
+                    const float* texel = row + static_cast<ptrdiff_t>(x + offsets[k]) * 4;
+                    __m128 weight = _mm_set1_ps(weights[k]);
+                    acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(texel), weight));
+                    acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(texel + 4), weight));
+                    acc2 = _mm_add_ps(acc2, _mm_mul_ps(_mm_loadu_ps(texel + 8), weight));
+                    acc3 = _mm_add_ps(acc3, _mm_mul_ps(_mm_loadu_ps(texel + 12), weight));
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 4), pack_sse2(acc0, acc1, acc2, acc3));
+            }
+            horizontal_scalar(row + static_cast<ptrdiff_t>(x) * 4, out + x * 4, width - x, offsets, weights, taps);
+        }
+
+        inline void vertical_sse2(const uint8_t* const* rows, uint8_t* out, int count, const float* weights, int taps) {
+            const __m128i zero = _mm_setzero_si128();
+            int i = 0;
+            for (; i + 16 <= count; i += 16) {
+                __m128 acc0 = _mm_setzero_ps();
+                __m128 acc1 = _mm_setzero_ps();
+                __m128 acc2 = _mm_setzero_ps();
+                __m128 acc3 = _mm_setzero_ps();
+                for (int k = 0; k < taps; k++) {
+                    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[k] + i));
+                    __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+                    __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+                    __m128 weight = _mm_set1_ps(weights[k]);
+                    acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), weight));
+                    acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), weight));
+                    acc2 = _mm_add_ps(acc2, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), weight));
+                    acc3 = _mm_add_ps(acc3, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), weight));
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), pack_sse2(acc0, acc1, acc2, acc3));
+            }
+            if (i < count) {
+                const uint8_t* tail_rows[max_kernel_taps];
+                for (int k = 0; k < taps; k++) tail_rows[k] = rows[k] + i;
+                vertical_scalar(tail_rows, out + i, count - i, weights, taps);
+            }
+        }
+
+        BLUR_TARGET_AVX2 inline __m256i pack_avx2(__m256 a, __m256 b, __m256 c, __m256 d) {
+            const __m256 half = _mm256_set1_ps(0.5f);
+            const __m256 zero = _mm256_setzero_ps();
+            const __m256 max = _mm256_set1_ps(255.0f);
+            __m256i ia = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_add_ps(a, half), zero), max));
+            __m256i ib = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_add_ps(b, half), zero), max));
+            __m256i ic = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_add_ps(c, half), zero), max));
+            __m256i id = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_add_ps(d, half), zero), max));
+            __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(ia, ib), _mm256_packs_epi32(ic, id));
+            return _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+        }
+
+        BLUR_TARGET_AVX2 inline void widen_avx2(const uint8_t* src, float* dst, int count) {
+            int i = 0;
+            for (; i + 8 <= count; i += 8) {
+                __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i));
+                _mm256_storeu_ps(dst + i, _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(bytes)));
+            }
+            widen_scalar(src + i, dst + i, count - i);
+        }
+
+        BLUR_TARGET_AVX2 inline void horizontal_avx2(const float* row, uint8_t* out, int width, const int* offsets, const float* weights, int taps) {
+            int x = 0;
+            for (; x + 8 <= width; x += 8) {
+                __m256 acc0 = _mm256_setzero_ps();
+                __m256 acc1 = _mm256_setzero_ps();
+                __m256 acc2 = _mm256_setzero_ps();
+                __m256 acc3 = _mm256_setzero_ps();
+                for (int k = 0; k < taps; k++) {
+                    const float* texel = row + static_cast<ptrdiff_t>(x + offsets[k]) * 4;
+                    __m256 weight = _mm256_set1_ps(weights[k]);
+                    acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(texel), weight));
+                    acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(_mm256_loadu_ps(texel + 8), weight));
+                    acc2 = _mm256_add_ps(acc2, _mm256_mul_ps(_mm256_loadu_ps(texel + 16), weight));
+                    acc3 = _mm256_add_ps(acc3, _mm256_mul_ps(_mm256_loadu_ps(texel + 24), weight));
+                }
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + x * 4), pack_avx2(acc0, acc1, acc2, acc3));
+            }
+            horizontal_sse2(row + static_cast<ptrdiff_t>(x) * 4, out + x * 4, width - x, offsets, weights, taps);
+        }
+
+        BLUR_TARGET_AVX2 inline void vertical_avx2(const uint8_t* const* rows, uint8_t* out, int count, const float* weights, int taps) {
+            int i = 0;
+            for (; i + 32 <= count; i += 32) {
+                __m256 acc0 = _mm256_setzero_ps();
+                __m256 acc1 = _mm256_setzero_ps();
+                __m256 acc2 = _mm256_setzero_ps();
+                __m256 acc3 = _mm256_setzero_ps();
+                for (int k = 0; k < taps; k++) {
+                    const uint8_t* src = rows[k] + i;
+                    __m256 weight = _mm256_set1_ps(weights[k]);
+                    acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src)))), weight));
+                    acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + 8)))), weight));
+                    acc2 = _mm256_add_ps(acc2, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + 16)))), weight));
+                    acc3 = _mm256_add_ps(acc3, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + 24)))), weight));
+                }
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), pack_avx2(acc0, acc1, acc2, acc3));
+            }
+            if (i < count) {
+                const uint8_t* tail_rows[max_kernel_taps];
+                for (int k = 0; k < taps; k++) tail_rows[k] = rows[k] + i;
+                vertical_sse2(tail_rows, out + i, count - i, weights, taps);
+            }
+        }
+
+        inline void cpuid(int leaf, int subleaf, int regs[4]) {
+#if defined(_MSC_VER) && !defined(__clang__)
+            __cpuidex(regs, leaf, subleaf);
+#else
+            unsigned int a = 0, b = 0, c = 0, d = 0;
+            __cpuid_count(leaf, subleaf, a, b, c, d);
+            regs[0] = static_cast<int>(a); regs[1] = static_cast<int>(b);
+            regs[2] = static_cast<int>(c); regs[3] = static_cast<int>(d);
+#endif
+        }
+
+        inline uint64_t xgetbv0() {
+#if defined(_MSC_VER) && !defined(__clang__)
+            return _xgetbv(0);
+#else
+            uint32_t lo = 0, hi = 0;
+            __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+            return (static_cast<uint64_t>(hi) << 32) | lo;
+#endif
+        }
+#endif
+
+#if defined(BLUR_SIMD_NEON)
+        inline uint8x16_t pack_neon(float32x4_t a, float32x4_t b, float32x4_t c, float32x4_t d) {
+            const float32x4_t half = vdupq_n_f32(0.5f);
+            const float32x4_t zero = vdupq_n_f32(0.0f);
+            const float32x4_t max = vdupq_n_f32(255.0f);
+            uint32x4_t ia = vcvtq_u32_f32(vminq_f32(vmaxq_f32(vaddq_f32(a, half), zero), max));
+            uint32x4_t ib = vcvtq_u32_f32(vminq_f32(vmaxq_f32(vaddq_f32(b, half), zero), max));
+            uint32x4_t ic = vcvtq_u32_f32(vminq_f32(vmaxq_f32(vaddq_f32(c, half), zero), max));
+            uint32x4_t id = vcvtq_u32_f32(vminq_f32(vmaxq_f32(vaddq_f32(d, half), zero), max));
+            uint16x8_t ab = vcombine_u16(vmovn_u32(ia), vmovn_u32(ib));
+            uint16x8_t cd = vcombine_u16(vmovn_u32(ic), vmovn_u32(id));
+            return vcombine_u8(vqmovn_u16(ab), vqmovn_u16(cd));
+        }
+
+        inline void widen_neon(const uint8_t* src, float* dst, int count) {
+            int i = 0;
+            for (; i + 16 <= count; i += 16) {
+                uint8x16_t bytes = vld1q_u8(src + i);
+                uint16x8_t lo = vmovl_u8(vget_low_u8(bytes));
+                uint16x8_t hi = vmovl_u8(vget_high_u8(bytes));
+                vst1q_f32(dst + i, vcvtq_f32_u32(vmovl_u16(vget_low_u16(lo))));
+                vst1q_f32(dst + i + 4, vcvtq_f32_u32(vmovl_u16(vget_high_u16(lo))));
+                vst1q_f32(dst + i + 8, vcvtq_f32_u32(vmovl_u16(vget_low_u16(hi))));
+                vst1q_f32(dst + i + 12, vcvtq_f32_u32(vmovl_u16(vget_high_u16(hi))));
+            }
+            widen_scalar(src + i, dst + i, count - i);
+        }
+
+        inline void horizontal_neon(const float* row, uint8_t* out, int width, const int* offsets, const float* weights, int taps) {
+            int x = 0;
+            for (; x + 4 <= width; x += 4) {
+                float32x4_t acc0 = vdupq_n_f32(0.0f);
+                float32x4_t acc1 = vdupq_n_f32(0.0f);
+                float32x4_t acc2 = vdupq_n_f32(0.0f);
+                float32x4_t acc3 = vdupq_n_f32(0.0f);
+                for (int k = 0; k < taps; k++) {
+                    const float* texel = row + static_cast<ptrdiff_t>(x + offsets[k]) * 4;
+                    float32x4_t weight = vdupq_n_f32(weights[k]);
+                    acc0 = vaddq_f32(acc0, vmulq_f32(vld1q_f32(texel), weight));
+                    acc1 = vaddq_f32(acc1, vmulq_f32(vld1q_f32(texel + 4), weight));
+                    acc2 = vaddq_f32(acc2, vmulq_f32(vld1q_f32(texel + 8), weight));
+                    acc3 = vaddq_f32(acc3, vmulq_f32(vld1q_f32(texel + 12), weight));
+                }
+                vst1q_u8(out + x * 4, pack_neon(acc0, acc1, acc2, acc3));
+            }
+            horizontal_scalar(row + static_cast<ptrdiff_t>(x) * 4, out + x * 4, width - x, offsets, weights, taps);
+        }
+
+        inline void vertical_neon(const uint8_t* const* rows, uint8_t* out, int count, const float* weights, int taps) {
+            int i = 0;
+            for (; i + 16 <= count; i += 16) {
+                float32x4_t acc0 = vdupq_n_f32(0.0f);
+                float32x4_t acc1 = vdupq_n_f32(0.0f);
+                float32x4_t acc2 = vdupq_n_f32(0.0f);
+                float32x4_t acc3 = vdupq_n_f32(0.0f);
+                for (int k = 0; k < taps; k++) {
+                    uint8x16_t bytes = vld1q_u8(rows[k] + i);
+                    uint16x8_t lo = vmovl_u8(vget_low_u8(bytes));
+                    uint16x8_t hi = vmovl_u8(vget_high_u8(bytes));
+                    float32x4_t weight = vdupq_n_f32(weights[k]);
+                    acc0 = vaddq_f32(acc0, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(lo))), weight));
+                    acc1 = vaddq_f32(acc1, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(lo))), weight));
+                    acc2 = vaddq_f32(acc2, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(hi))), weight));
+                    acc3 = vaddq_f32(acc3, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(hi))), weight));
+                }
+                vst1q_u8(out + i, pack_neon(acc0, acc1, acc2, acc3));
+            }
+            if (i < count) {
+                const uint8_t* tail_rows[max_kernel_taps];
+                for (int k = 0; k < taps; k++) tail_rows[k] = rows[k] + i;
+                vertical_scalar(tail_rows, out + i, count - i, weights, taps);
+            }
+        }
+#endif
+
+        // The forced kernel_isa, or -1 for none; atomic so it can be forced while other threads blur.
+        inline std::atomic<int>& forced_isa() {
+            static std::atomic<int> isa(-1);
+            return isa;
+        }
+
+    }
+
+    inline bool kernel_isa_supported(kernel_isa isa) {
+        switch (isa) {
+        case kernel_isa::scalar:
+            return true;
+#if defined(BLUR_SIMD_X86)
+        case kernel_isa::sse2: {
+            int regs[4];
+            detail::cpuid(1, 0, regs);
+            return (regs[3] & (1 << 26)) != 0;
+        }
+        case kernel_isa::avx2: {
+            int regs[4];
+            detail::cpuid(0, 0, regs);
+            if (regs[0] < 7) return false;
+            detail::cpuid(1, 0, regs);
+            bool osxsave = (regs[2] & (1 << 27)) != 0;
+            bool avx = (regs[2] & (1 << 28)) != 0;
+            if (!osxsave || !avx || (detail::xgetbv0() & 0x6) != 0x6) return false;
+            detail::cpuid(7, 0, regs);
+            return (regs[1] & (1 << 5)) != 0;
+        }
+#endif
+#if defined(BLUR_SIMD_NEON)
+        case kernel_isa::neon:
+            return true;
+#endif
+        default:
+            return false;
+        }
+    }
+
+    inline kernel_isa detect_kernel_isa() {
+        static const kernel_isa detected = [] {
+            if (kernel_isa_supported(kernel_isa::avx2)) return kernel_isa::avx2;
+            if (kernel_isa_supported(kernel_isa::sse2)) return kernel_isa::sse2;
+            if (kernel_isa_supported(kernel_isa::neon)) return kernel_isa::neon;
+            return kernel_isa::scalar;
+        }();
+        return detected;
+    }
+
+    // Pins the row kernels to one instruction set, e.g. to compare variants in tests. Fails if the CPU lacks it.
+    inline bool force_kernel_isa(kernel_isa isa) {
+        if (!kernel_isa_supported(isa)) return false;
+        detail::forced_isa().store(static_cast<int>(isa));
+        return true;
+    }
+
+    inline void reset_kernel_isa() {
+        detail::forced_isa().store(-1);
+    }
+
+    inline kernel_isa active_kernel_isa() {
+        int forced = detail::forced_isa().load();
+        return forced >= 0 ? static_cast<kernel_isa>(forced) : detect_kernel_isa();
+    }
+
+    inline row_kernels get_row_kernels(kernel_isa isa) {
+        switch (isa) {
+#if defined(BLUR_SIMD_X86)
+        case kernel_isa::sse2: return { detail::widen_sse2, detail::horizontal_sse2, detail::vertical_sse2 };
+        case kernel_isa::avx2: return { detail::widen_avx2, detail::horizontal_avx2, detail::vertical_avx2 };
+#endif
+#if defined(BLUR_SIMD_NEON)
+        case kernel_isa::neon: return { detail::widen_neon, detail::horizontal_neon, detail::vertical_neon };
+#endif
+        default: return { detail::widen_scalar, detail::horizontal_scalar, detail::vertical_scalar };
+        }
+    }
+
+    inline row_kernels get_row_kernels() {
+        return get_row_kernels(active_kernel_isa());
+    }
+
+}
+}
+
+#endif
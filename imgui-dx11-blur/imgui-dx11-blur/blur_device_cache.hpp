@@ -0,0 +1,140 @@
+#ifndef BLUR_DEVICE_CACHE_HPP
+#define BLUR_DEVICE_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace blur {
+
+    struct device_cache_stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        size_t entries = 0;
+    };
+
+    // Values built per device and shared by its users, each acquire() matched by a release(). Entries hold a
+    // reference on their device. Builder: device (AddRef/Release), value, create(device*, value&), destroy(value&).
+    template <typename Builder>
+    class device_cache {
+    public:
+        using device = typename Builder::device;
+        using value = typename Builder::value;
+
+    private:
+        struct entry {
+            device* key;
+            value object;
+            int users;
+            double last_used;
+        };
+
+        Builder builder_;
+        std::vector<std::unique_ptr<entry>> entries_;
+        double idle_timeout_ = 30.0;
+        device_cache_stats stats_;
+
+        void destroy(entry& e) {
+            builder_.destroy(e.object);
+            e.key->Release();
+            stats_.evictions++;
+        }
+
+    public:
+        explicit device_cache(Builder builder = Builder()) : builder_(builder) {}
+        ~device_cache() { clear(); }
+
+        device_cache(const device_cache&) = delete;
+        device_cache& operator=(const device_cache&) = delete;
+
+        // Builds on first use; nullptr if that failed. Valid until the matching release().
+        value* acquire(device* key, double time) {
+            if (!key) return nullptr;
+            for (std::unique_ptr<entry>& e : entries_) {
+                if (e->key != key) continue;
+                e->users++;
+                e->last_used = time;
+                stats_.hits++;
+                return &e->object;
+            }
+
+            stats_.misses++;
+            std::unique_ptr<entry> created(new entry{ key, value{}, 1, time });
+            if (!builder_.create(key, created->object)) {
+                builder_.destroy(created->object);
+                return nullptr;
+            }
+
+            key->AddRef();
+            entries_.push_back(std::move(created));
+            stats_.entries = entries_.size();
+            return &entries_.back()->object;
+        }
+
+        // The entry stays cached; the idle timeout starts at time once nobody uses it.
+        void release(device* key, double time) {
+            for (std::unique_ptr<entry>& e : entries_) {
+                if (e->key != key || e->users == 0) continue;
+                e->users--;
+                e->last_used = time;
+                return;
+            }
+        }
+
+        // Destroys key's entry unless it is still in use. Returns whether nothing is cached for key any more.
+        bool evict(device* key) {
+            for (size_t i = 0; i < entries_.size(); i++) {
+                if (entries_[i]->key != key) continue;
+                if (entries_[i]->users > 0) return false;
+                destroy(*entries_[i]);
+                entries_.erase(entries_.begin() + i);
+                stats_.entries = entries_.size();
+                return true;
+            }
+            return true;
+        }
+
+        // Evicts devices nobody has used for longer than the timeout; call once per frame.
+        void trim(double time) {
+            for (size_t i = 0; i < entries_.size();) {
+                if (entries_[i]->users > 0 || time - entries_[i]->last_used <= idle_timeout_) {
+                    i++;
+                    continue;
+                }
+                destroy(*entries_[i]);
+                entries_.erase(entries_.begin() + i);
+            }
+            stats_.entries = entries_.size();
+        }
+
+        // Destroys every entry, including ones still in use; for shutdown.
+        void clear() {
+            for (std::unique_ptr<entry>& e : entries_) destroy(*e);
+            entries_.clear();
+            stats_.entries = 0;
+        }
+
+        void set_idle_timeout(double seconds) { idle_timeout_ = seconds; }
+        double idle_timeout() const { return idle_timeout_; }
+        int users(const device* key) const {
+            for (const std::unique_ptr<entry>& e : entries_) {
+                if (e->key == key) return e->users;
+            }
+            return 0;
+        }
+
+        const device_cache_stats& stats() const { return stats_; }
+        void reset_stats() {
+            stats_.hits = 0;
+            stats_.misses = 0;
+            stats_.evictions = 0;
+        }
+
+        Builder& builder() { return builder_; }
+    };
+
+}
+
+#endif
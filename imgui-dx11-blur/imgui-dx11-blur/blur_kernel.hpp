@@ -0,0 +1,189 @@
+#ifndef BLUR_KERNEL_HPP
+#define BLUR_KERNEL_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace blur {
+
+    enum class blur_mode {
+        gaussian,       // separable Gaussian at full resolution, shaped by kernel_desc
+        dual_kawase,    // progressive half-resolution downsample chain followed by the matching upsample chain
+        pyramid         // binomial mip chain of the shared backdrop, each window samples the level matching its sigma;
+                        // without shared_backdrop it blurs like gaussian
+    };
+
+    enum class kernel_sampling {
+        discrete,   // one fetch per Gaussian tap: 2 * radius + 1 fetches per pass
+        linear      // adjacent taps merged into one bilinear fetch: radius + 1 fetches per pass (radius even)
+    };
+
+    constexpr int default_kernel_radius = 4;
+    constexpr int max_kernel_radius = 64;
+    constexpr int max_table_taps = max_kernel_radius + 1;
+
+    // radius is in taps on each side of the centre; sigma <= 0 derives it from the radius the way the original
+    // shaders did (exp(-0.5 * i * i / (radius * radius * 0.5))).
+    struct kernel_desc {
+        int radius = default_kernel_radius;
+        float sigma = 0.0f;
+        kernel_sampling sampling = kernel_sampling::discrete;
+    };
+
+    // One side of the symmetric kernel; the shaders fetch at +offset and -offset (in texels, before blur_strength).
+    // Padded to a float4 so an array of these matches the cbuffer layout.
+    struct kernel_tap {
+        float offset;
+        float weight;
+        float padding[2];
+    };
+
+    struct kernel_table {
+        int tap_count = 0;
+        kernel_tap taps[max_table_taps] = {};
+    };
+
+    inline int kernel_radius(const kernel_desc& desc) {
+        return desc.radius < 1 ? 1 : (desc.radius > max_kernel_radius ? max_kernel_radius : desc.radius);
+    }
+
+    inline float kernel_sigma(const kernel_desc& desc) {
+        if (desc.sigma > 0.0f) return desc.sigma;
+        return static_cast<float>(kernel_radius(desc)) * std::sqrt(0.5f);
+    }
+
+    inline float kernel_weight(int i, float sigma) {
+        return std::exp(-0.5f * static_cast<float>(i * i) / (sigma * sigma));
+    }
+
+    // taps[0] is the centre fetch. Linear mode merges taps i and i + 1 at their weighted centre, exact when
+    // blur_strength is 1.
+    inline kernel_table make_kernel_table(const kernel_desc& desc = {}) {
+        int radius = kernel_radius(desc);
+        float sigma = kernel_sigma(desc);
+
+        float total_weight = 0.0f;
+        for (int i = -radius; i <= radius; i++) total_weight += kernel_weight(i, sigma);
+
+        kernel_table table;
+        table.taps[0] = { 0.0f, kernel_weight(0, sigma) / total_weight, { 0.0f, 0.0f } };
+        table.tap_count = 1;
+
+        if (desc.sampling == kernel_sampling::discrete) {
+            for (int i = 1; i <= radius; i++) {
+                table.taps[table.tap_count++] = { static_cast<float>(i), kernel_weight(i, sigma) / total_weight, { 0.0f, 0.0f } };
+            }
+            return table;
+        }
+
+        for (int i = 1; i <= radius; i += 2) {
+            float w0 = kernel_weight(i, sigma);
+            float w1 = i + 1 <= radius ? kernel_weight(i + 1, sigma) : 0.0f;
+            float offset = (i * w0 + (i + 1) * w1) / (w0 + w1);
+            table.taps[table.tap_count++] = { offset, (w0 + w1) / total_weight, { 0.0f, 0.0f } };
+        }
+        return table;
+    }
+
+    // The shader taps sit at +-offset * blur_strength texels. Splitting each bilinear fetch into its two texels
+    // gives an integer-offset kernel that is exact under clamp addressing and maps onto plain SIMD loads.
+    struct pixel_kernel {
+        std::vector<int> offsets;
+        std::vector<float> weights;
+        int min_offset = 0;
+        int max_offset = 0;
+    };
+
+    inline pixel_kernel make_pixel_kernel(const kernel_table& table, float blur_strength) {
+        float reach = 0.0f;
+        for (int i = 0; i < table.tap_count; i++) reach = std::max(reach, std::fabs(table.taps[i].offset * blur_strength));
+
+        int first = static_cast<int>(std::floor(-reach));
+        int last = static_cast<int>(std::floor(reach)) + 1;
+        std::vector<float> dense(static_cast<size_t>(last - first + 1), 0.0f);
+
+        auto add_fetch = [&](float position, float weight) {
+            float position_floor = std::floor(position);
+            float fraction = position - position_floor;
+            int index = static_cast<int>(position_floor) - first;
+            dense[index] += weight * (1.0f - fraction);
+            dense[index + 1] += weight * fraction;
+        };
+
+        add_fetch(0.0f, table.taps[0].weight);
+        for (int i = 1; i < table.tap_count; i++) {
+            add_fetch(table.taps[i].offset * blur_strength, table.taps[i].weight);
+            add_fetch(-table.taps[i].offset * blur_strength, table.taps[i].weight);
+        }
+
+        pixel_kernel kernel;
+        for (int i = 0; i < static_cast<int>(dense.size()); i++) {
+            if (dense[i] <= 0.0f) continue;
+            kernel.offsets.push_back(first + i);
+            kernel.weights.push_back(dense[i]);
+        }
+        kernel.min_offset = kernel.offsets.front();
+        kernel.max_offset = kernel.offsets.back();
+        return kernel;
+    }
+
+    inline pixel_kernel make_pixel_kernel(float blur_strength, const kernel_desc& desc = {}) {
+        return make_pixel_kernel(make_kernel_table(desc), blur_strength);
+    }
+
+    // Compute path geometry, matching the TILE / APRON defines in shaders::blur_compute_source: every thread group
+    // loads a compute_tile_size square plus compute_apron texels on each side into groupshared memory.
+    constexpr int compute_tile_size = 16;
+    constexpr int compute_apron = 8;
+
+    inline bool fits_compute_apron(const pixel_kernel& kernel) {
+        return kernel.min_offset >= -compute_apron && kernel.max_offset <= compute_apron;
+    }
+
+    constexpr int max_downsample = 8;
+
+    // Power-of-two reduction applied to the capture before blurring: 1, 2, 4 or 8. Anything else rounds down.
+    inline int downsample_factor(int downsample) {
+        int factor = 1;
+        while (factor * 2 <= downsample && factor < max_downsample) factor *= 2;
+        return factor;
+    }
+
+    inline int downsampled_size(int size, int factor) {
+        return std::max(1, (size + factor - 1) / factor);
+    }
+
+    constexpr int max_kawase_iterations = 6;
+
+    // Each Dual Kawase iteration halves the resolution and roughly doubles the blur footprint, so the iteration
+    // count follows log2 of the requested radius in pixels (blur_radius * blur_strength).
+    inline int kawase_iterations(float radius) {
+        int iterations = static_cast<int>(std::ceil(std::log2(radius > 1.0f ? radius : 1.0f)));
+        return iterations < 1 ? 1 : (iterations > max_kawase_iterations ? max_kawase_iterations : iterations);
+    }
+
+    // Texels a separable pass reads on each side of its output texel, bilinear footprint included.
+    inline int kernel_apron(const kernel_desc& desc, float blur_strength) {
+        return static_cast<int>(std::ceil(kernel_radius(desc) * blur_strength)) + 1;
+    }
+
+    constexpr int max_pyramid_levels = 8;
+
+    // Mip count of a pyramid over a width x height image; levels halve like D3D11 mips, down to 1 x 1 at most.
+    inline int pyramid_levels(int width, int height) {
+        int levels = 1;
+        while (levels < max_pyramid_levels && (std::max(width, height) >> levels) > 0) levels++;
+        return levels;
+    }
+
+    // Level k approximates a Gaussian of variance (4^k - 1) / 4 level-0 texels; returns the fractional level for
+    // sigma.
+    inline float pyramid_lod(float sigma) {
+        if (sigma <= 0.0f) return 0.0f;
+        return 0.5f * std::log2(4.0f * sigma * sigma + 1.0f);
+    }
+
+}
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef BLUR_PANEL_HPP
+#define BLUR_PANEL_HPP
+
+#include <imgui.h>
+
+#include "blur.hpp"
+
+namespace blur {
+
+    // Drop-in window with the renderer's CPU timers and counters over the last frames and its GPU time per stage.
+    // Call between ImGui::NewFrame() and ImGui::Render(), from the thread that builds the UI.
+    inline void show_profiler_window(const blur_renderer& renderer, bool* open = nullptr) {
+        if (!ImGui::Begin("Blur profiler", open)) {
+            ImGui::End();
+            return;
+        }
+
+        static stats::cpu_frame frames[stats::profiler_frames];
+        static float plot[stats::profiler_frames];
+        size_t count = renderer.profiler().recent(frames, stats::profiler_frames);
+
+        if (ImGui::CollapsingHeader("CPU", ImGuiTreeNodeFlags_DefaultOpen) && count > 0) {
+            for (size_t i = 0; i < count; i++) {
+                plot[i] = static_cast<float>(frames[count - 1 - i].timer_ms[static_cast<int>(stats::cpu_timer::render)]);
+            }
+            ImGui::PlotLines("render ms", plot, static_cast<int>(count));
+
+            if (ImGui::BeginTable("cpu_timers", 5, ImGuiTableFlags_RowBg)) {
+                ImGui::TableSetupColumn("timer");
+                ImGui::TableSetupColumn("calls");
+                ImGui::TableSetupColumn("last ms");
+                ImGui::TableSetupColumn("avg ms");
+                ImGui::TableSetupColumn("p99 ms");
+                ImGui::TableHeadersRow();
+                for (int i = 0; i < stats::cpu_timer_count; i++) {
+                    stats::cpu_timer timer = static_cast<stats::cpu_timer>(i);
+                    stats::summary summary = stats::summarize(frames, count, timer);
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(stats::cpu_timer_name(timer));
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%d", frames[0].timer_calls[i]);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.3f", frames[0].timer_ms[i]);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.3f", summary.avg_ms);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.3f", summary.p99_ms);
+                }
+                ImGui::EndTable();
+            }
+
+            if (ImGui::BeginTable("counters", 3, ImGuiTableFlags_RowBg)) {
+                ImGui::TableSetupColumn("counter");
+                ImGui::TableSetupColumn("last frame");
+                ImGui::TableSetupColumn("total");
+                ImGui::TableHeadersRow();
+                for (int i = 0; i < stats::counter_count; i++) {
+                    unsigned long long total = 0;
+                    for (size_t f = 0; f < count; f++) total += frames[f].counters[i];
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(stats::counter_name(static_cast<stats::counter>(i)));
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%llu", static_cast<unsigned long long>(frames[0].counters[i]));
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%llu", total);
+                }
+                ImGui::EndTable();
+            }
+            ImGui::Text("Totals over the last %d frames, %llu frames over budget", static_cast<int>(count),
+                static_cast<unsigned long long>(renderer.profiler().frames_over_budget()));
+        }
+
+        const stats::gpu_timings& gpu = renderer.gpu_stats();
+        if (ImGui::CollapsingHeader("GPU", ImGuiTreeNodeFlags_DefaultOpen)) {
+            if (ImGui::BeginTable("gpu_stages", 5, ImGuiTableFlags_RowBg)) {
+                ImGui::TableSetupColumn("stage");
+                ImGui::TableSetupColumn("last ms");
+                ImGui::TableSetupColumn("min ms");
+                ImGui::TableSetupColumn("avg ms");
+                ImGui::TableSetupColumn("p99 ms");
+                ImGui::TableHeadersRow();
+                for (int i = 0; i <= stats::stage_count; i++) {
+                    bool total = i == stats::stage_count;
+                    stats::summary summary = total ? gpu.total() : gpu.stage_summary(static_cast<stats::stage>(i));
+                    if (summary.samples == 0) continue;
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(total ? "total" : stats::stage_name(static_cast<stats::stage>(i)));
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.3f", summary.last_ms);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.3f", summary.min_ms);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.3f", summary.avg_ms);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.3f", summary.p99_ms);
+                }
+                ImGui::EndTable();
+            }
+            ImGui::Text("%llu frames read back, %llu lost", static_cast<unsigned long long>(gpu.frames()),
+                static_cast<unsigned long long>(gpu.lost_frames()));
+        }
+
+        ImGui::End();
+    }
+
+}
+
+#endif
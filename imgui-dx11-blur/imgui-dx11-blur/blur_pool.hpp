@@ -0,0 +1,135 @@
+#ifndef BLUR_POOL_HPP
+#define BLUR_POOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace blur {
+
+    // Rounds up to one of four steps per power of two, at least 16 texels apart, keeping power-of-two alignments.
+    inline int pool_bucket_size(int size) {
+        if (size <= 0) return 0;
+
+        int octave = 1;
+        while (octave <= size / 2) octave *= 2;
+        int step = octave / 4 > 16 ? octave / 4 : 16;
+        return (size + step - 1) / step * step;
+    }
+
+    struct texture_pool_stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        size_t in_use = 0;
+        size_t idle = 0;
+    };
+
+    // Recycles render targets by bucketed size and bind flags until idle past the timeout. Allocator: resource,
+    // create(width, height, bind_flags, resource&), destroy(resource&), same(a, b).
+    template <typename Allocator>
+    class texture_pool {
+    public:
+        using resource = typename Allocator::resource;
+
+    private:
+        struct entry {
+            resource value;
+            int width;
+            int height;
+            unsigned bind_flags;
+            bool in_use;
+            double release_time;
+        };
+
+        Allocator allocator_;
+        std::vector<entry> entries_;
+        double idle_timeout_ = 2.0;
+        texture_pool_stats stats_;
+
+    public:
+        explicit texture_pool(Allocator allocator = Allocator()) : allocator_(allocator) {}
+        ~texture_pool() { clear(); }
+
+        texture_pool(const texture_pool&) = delete;
+        texture_pool& operator=(const texture_pool&) = delete;
+
+        // out is at least width x height; its real size is pool_bucket_size of each.
+        bool acquire(int width, int height, unsigned bind_flags, resource& out) {
+            int bucket_width = pool_bucket_size(width);
+            int bucket_height = pool_bucket_size(height);
+
+            for (entry& e : entries_) {
+                if (e.in_use || e.width != bucket_width || e.height != bucket_height || e.bind_flags != bind_flags) continue;
+                e.in_use = true;
+                out = e.value;
+                stats_.hits++;
+                stats_.idle--;
+                stats_.in_use++;
+                return true;
+            }
+
+            stats_.misses++;
+            resource value{};
+            if (!allocator_.create(bucket_width, bucket_height, bind_flags, value)) {
+                allocator_.destroy(value);
+                return false;
+            }
+
+            entries_.push_back({ value, bucket_width, bucket_height, bind_flags, true, 0.0 });
+            stats_.in_use++;
+            out = value;
+            return true;
+        }
+
+        // Returns a texture from acquire(); anything else is ignored.
+        void release(const resource& value, double time) {
+            for (entry& e : entries_) {
+                if (!e.in_use || !allocator_.same(e.value, value)) continue;
+                e.in_use = false;
+                e.release_time = time;
+                stats_.in_use--;
+                stats_.idle++;
+                return;
+            }
+        }
+
+        // Destroys textures idle for longer than the timeout; call once per frame.
+        void trim(double time) {
+            for (size_t i = 0; i < entries_.size();) {
+                entry& e = entries_[i];
+                if (e.in_use || time - e.release_time <= idle_timeout_) {
+                    i++;
+                    continue;
+                }
+                allocator_.destroy(e.value);
+                e = entries_.back();
+                entries_.pop_back();
+                stats_.idle--;
+                stats_.evictions++;
+            }
+        }
+
+        // Destroys every texture, including ones still handed out; for device loss or shutdown.
+        void clear() {
+            for (entry& e : entries_) allocator_.destroy(e.value);
+            entries_.clear();
+            stats_.in_use = 0;
+            stats_.idle = 0;
+        }
+
+        void set_idle_timeout(double seconds) { idle_timeout_ = seconds; }
+        double idle_timeout() const { return idle_timeout_; }
+        const texture_pool_stats& stats() const { return stats_; }
+        void reset_stats() {
+            stats_.hits = 0;
+            stats_.misses = 0;
+            stats_.evictions = 0;
+        }
+
+        Allocator& allocator() { return allocator_; }
+    };
+
+}
+
+#endif
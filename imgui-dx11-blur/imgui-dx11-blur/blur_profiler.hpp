@@ -0,0 +1,212 @@
+#ifndef BLUR_PROFILER_HPP
+#define BLUR_PROFILER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "blur_stats.hpp"
+
+namespace blur {
+
+    namespace stats {
+
+        // CPU time spent by the renderer, inclusive: a state save inside a blur counts for both.
+        enum class cpu_timer {
+            render,         // blur_renderer::render, once per window
+            capture,        // capture callbacks, change detection included
+            blur,           // blur and backdrop callbacks
+            state,          // saving and restoring the caller's render targets and viewport
+            map,            // Map / Unmap of the instance and constant buffers
+            create,         // shaders, states, textures, views and queries
+            count
+        };
+
+        enum class counter {
+            d3d_calls,          // device and context methods
+            bytes_allocated,    // texture memory created
+            textures_created,
+            resources_created,  // every Create call: textures, views, buffers, states, shaders and queries
+            captures,
+            passes,
+            count
+        };
+
+        constexpr int cpu_timer_count = static_cast<int>(cpu_timer::count);
+        constexpr int counter_count = static_cast<int>(counter::count);
+        static_assert(counter_count <= 32, "cpu_frame::over_budget has a bit per counter");
+
+        inline const char* cpu_timer_name(cpu_timer value) {
+            switch (value) {
+            case cpu_timer::render: return "render";
+            case cpu_timer::capture: return "capture";
+            case cpu_timer::blur: return "blur";
+            case cpu_timer::state: return "state";
+            case cpu_timer::map: return "map";
+            case cpu_timer::create: return "create";
+            default: return "";
+            }
+        }
+
+        inline const char* counter_name(counter value) {
+            switch (value) {
+            case counter::d3d_calls: return "D3D calls";
+            case counter::bytes_allocated: return "bytes allocated";
+            case counter::textures_created: return "textures created";
+            case counter::resources_created: return "resources created";
+            case counter::captures: return "captures";
+            case counter::passes: return "passes";
+            default: return "";
+            }
+        }
+
+        struct cpu_frame {
+            uint64_t frame = 0;
+            double timer_ms[cpu_timer_count] = {};
+            int timer_calls[cpu_timer_count] = {};
+            uint64_t counters[counter_count] = {};
+            uint32_t over_budget = 0;   // a bit per counter past its frame_budget limit
+        };
+
+        // Per-frame limits on the counters, e.g. no resource creation once the scene has settled.
+        struct frame_budget {
+            uint64_t limits[counter_count];
+
+            frame_budget() {
+                for (uint64_t& limit : limits) limit = UINT64_MAX;
+            }
+
+            frame_budget& limit(counter value, uint64_t maximum) {
+                limits[static_cast<int>(value)] = maximum;
+                return *this;
+            }
+
+            uint32_t check(const cpu_frame& frame) const {
+                uint32_t exceeded = 0;
+                for (int i = 0; i < counter_count; i++) {
+                    if (frame.counters[i] > limits[i]) exceeded |= 1u << i;
+                }
+                return exceeded;
+            }
+        };
+
+        // One writer, any number of readers, no locks. A slot's sequence is odd while it is written; a reader that
+        // sees it change during its copy stops there.
+        template <typename T, size_t Capacity>
+        class frame_ring {
+            static_assert(std::is_trivially_copyable<T>::value, "frame_ring copies values byte-wise");
+
+        private:
+            struct slot {
+                std::atomic<uint64_t> sequence{ 0 };
+                T value;
+            };
+
+            slot slots_[Capacity];
+            std::atomic<uint64_t> head_{ 0 };
+
+        public:
+            void push(const T& value) {
+                uint64_t index = head_.load(std::memory_order_relaxed);
+                slot& target = slots_[index % Capacity];
+                target.sequence.store(2 * index + 1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+                target.value = value;
+                target.sequence.store(2 * index + 2, std::memory_order_release);
+                head_.store(index + 1, std::memory_order_release);
+            }
+
+            // Copies up to max_count of the newest values into out, newest first. Returns how many were copied.
+            size_t read_recent(T* out, size_t max_count) const {
+                uint64_t head = head_.load(std::memory_order_acquire);
+                size_t count = 0;
+                for (uint64_t index = head; index > 0 && count < max_count && head - index < Capacity; index--) {
+                    const slot& source = slots_[(index - 1) % Capacity];
+                    uint64_t sequence = source.sequence.load(std::memory_order_acquire);
+                    if (sequence != 2 * index) break;
+
+                    T value = source.value;
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    if (source.sequence.load(std::memory_order_relaxed) != sequence) break;
+                    out[count++] = value;
+                }
+                return count;
+            }
+
+            uint64_t pushed() const { return head_.load(std::memory_order_acquire); }
+            static constexpr size_t capacity() { return Capacity; }
+        };
+
+        constexpr size_t profiler_frames = 256;
+
+        // Records on the render thread only; the history can be read from anywhere.
+        class frame_profiler {
+        public:
+            using clock = std::chrono::steady_clock;
+
+        private:
+            cpu_frame current_;
+            frame_ring<cpu_frame, profiler_frames> history_;
+            frame_budget budget_;
+            std::atomic<uint64_t> over_budget_{ 0 };
+
+        public:
+            void add_time(cpu_timer timer, clock::duration elapsed) {
+                int index = static_cast<int>(timer);
+                current_.timer_ms[index] += std::chrono::duration<double, std::milli>(elapsed).count();
+                current_.timer_calls[index]++;
+            }
+
+            void count(counter value, uint64_t amount = 1) { current_.counters[static_cast<int>(value)] += amount; }
+
+            void end_frame(uint64_t next_frame) {
+                current_.over_budget = budget_.check(current_);
+                if (current_.over_budget) over_budget_.fetch_add(1, std::memory_order_relaxed);
+                history_.push(current_);
+                current_ = {};
+                current_.frame = next_frame;
+            }
+
+            // Applies from the frame being built on; the count of frames over budget restarts.
+            void set_budget(const frame_budget& budget) {
+                budget_ = budget;
+                over_budget_.store(0, std::memory_order_relaxed);
+            }
+
+            const frame_budget& budget() const { return budget_; }
+            uint64_t frames_over_budget() const { return over_budget_.load(std::memory_order_relaxed); }
+
+            const cpu_frame& current() const { return current_; }
+            size_t recent(cpu_frame* out, size_t max_count) const { return history_.read_recent(out, max_count); }
+            uint64_t frames() const { return history_.pushed(); }
+        };
+
+        class scoped_timer {
+        private:
+            frame_profiler& profiler_;
+            cpu_timer timer_;
+            frame_profiler::clock::time_point start_;
+
+        public:
+            scoped_timer(frame_profiler& profiler, cpu_timer timer)
+                : profiler_(profiler), timer_(timer), start_(frame_profiler::clock::now()) {}
+            ~scoped_timer() { profiler_.add_time(timer_, frame_profiler::clock::now() - start_); }
+
+            scoped_timer(const scoped_timer&) = delete;
+            scoped_timer& operator=(const scoped_timer&) = delete;
+        };
+
+        // min / avg / p99 of one timer over frames, counting frames it did not run in as 0.
+        inline summary summarize(const cpu_frame* frames, size_t count, cpu_timer timer) {
+            rolling_window window(count);
+            for (size_t i = count; i > 0; i--) window.add(frames[i - 1].timer_ms[static_cast<int>(timer)]);
+            return window.summarize();
+        }
+
+    }
+
+}
+
+#endif
@@ -0,0 +1,126 @@
+#ifndef BLUR_SCHEDULE_HPP
+#define BLUR_SCHEDULE_HPP
+
+#include <algorithm>
+#include <cstdint>
+
+namespace blur {
+
+    // Frame-side half of the capture state machine: begin_frame decides whether to queue a capture, the callback
+    // reports back through on_capture.
+    class capture_schedule {
+    private:
+        bool enabled_last_frame_ = false;
+        bool pending_ = false;
+        bool scheduled_ = false;
+        bool captured_ = false;
+        double enable_time_ = 0.0;
+
+    public:
+        // True when a capture callback has to be queued this frame. A callback queued last frame that never ran
+        // (the draw list was not rendered) is queued again right away.
+        bool begin_frame(bool should_blur, double time, double delay) {
+            if (should_blur && !enabled_last_frame_) {
+                reset();
+                pending_ = true;
+                enable_time_ = time;
+            }
+            else if (!should_blur && enabled_last_frame_) {
+                reset();
+            }
+            enabled_last_frame_ = should_blur;
+
+            if (scheduled_) {
+                scheduled_ = false;
+                pending_ = true;
+            }
+
+            if (!should_blur || !pending_ || captured_ || time - enable_time_ < delay) return false;
+
+            pending_ = false;
+            scheduled_ = true;
+            return true;
+        }
+
+        void on_capture(bool success) {
+            scheduled_ = false;
+            captured_ = success || captured_;
+        }
+
+        // The blurred image may be drawn once a capture succeeded, or in the frame that queued one: the callback
+        // sits in front of the image in the same command stream, so the GPU sees the result first.
+        bool has_image() const { return enabled_last_frame_ && (captured_ || scheduled_); }
+
+        // Live mode: recapture over an existing image. The old image stays on screen if the new capture fails.
+        bool refresh() {
+            if (!enabled_last_frame_ || !captured_ || scheduled_) return false;
+            scheduled_ = true;
+            return true;
+        }
+
+        bool captured() const { return captured_; }
+        bool scheduled() const { return scheduled_; }
+
+        // Forget any capture, e.g. after the render targets were recreated. Blur stays enabled, so the next
+        // begin_frame schedules a fresh capture without waiting for the delay again.
+        void invalidate() {
+            captured_ = false;
+            scheduled_ = false;
+            pending_ = enabled_last_frame_;
+        }
+
+        void reset() {
+            pending_ = false;
+            scheduled_ = false;
+            captured_ = false;
+        }
+    };
+
+    struct refresh_stats {
+        uint64_t refreshes = 0;
+        uint64_t skipped_interval = 0;
+        uint64_t skipped_budget = 0;
+    };
+
+    // Live-mode pacing: at most every `interval` frames, and with a budget a token bucket of GPU time that each
+    // refresh spends its measured cost from. It holds up to max(budget_ms, cost), so costly blurs still run.
+    class refresh_policy {
+    private:
+        int frames_since_refresh_ = 0;
+        double credit_ms_ = 0.0;
+        double cost_ms_ = 0.0;
+        refresh_stats stats_;
+
+    public:
+        bool should_refresh(int interval, double budget_ms) {
+            frames_since_refresh_++;
+            if (budget_ms > 0.0) credit_ms_ = std::min(credit_ms_ + budget_ms, std::max(budget_ms, cost_ms_));
+
+            if (frames_since_refresh_ < std::max(interval, 1)) {
+                stats_.skipped_interval++;
+                return false;
+            }
+            if (budget_ms > 0.0 && cost_ms_ > credit_ms_) {
+                stats_.skipped_budget++;
+                return false;
+            }
+
+            if (budget_ms > 0.0) credit_ms_ -= cost_ms_;
+            frames_since_refresh_ = 0;
+            stats_.refreshes++;
+            return true;
+        }
+
+        // GPU time of one capture + blur, smoothed; timings arrive a few frames late and only for some refreshes.
+        void record_cost(double milliseconds) {
+            cost_ms_ = cost_ms_ > 0.0 ? cost_ms_ * 0.75 + milliseconds * 0.25 : milliseconds;
+        }
+
+        double cost_ms() const { return cost_ms_; }
+        const refresh_stats& stats() const { return stats_; }
+        void reset_stats() { stats_ = {}; }
+    };
+
+}
+
+#endif
@@ -0,0 +1,367 @@
+#ifndef BLUR_SHADER_CACHE_HPP
+#define BLUR_SHADER_CACHE_HPP
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "blur_shaders.hpp"
+
+namespace blur {
+
+    struct shader_macro {
+        std::string name;
+        std::string definition;
+    };
+
+    inline uint64_t fnv1a_64(const void* data, size_t size, uint64_t hash = 0xcbf29ce484222325ull) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; i++) hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+        return hash;
+    }
+
+    // Fields are hashed with their terminators, so ("AB", "C") and ("A", "BC") differ.
+    inline uint64_t shader_cache_key(const char* source, const char* entry_point, const char* target,
+        const std::vector<shader_macro>& macros = {}) {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (const char* text : { source, entry_point, target }) hash = fnv1a_64(text, std::strlen(text) + 1, hash);
+        for (const shader_macro& macro : macros) {
+            hash = fnv1a_64(macro.name.c_str(), macro.name.size() + 1, hash);
+            hash = fnv1a_64(macro.definition.c_str(), macro.definition.size() + 1, hash);
+        }
+        return hash;
+    }
+
+    // Read-only view of a whole file. Empty files and missing files both fail to open.
+    class mapped_file {
+    private:
+        const unsigned char* data_ = nullptr;
+        size_t size_ = 0;
+#ifdef _WIN32
+        HANDLE file_ = INVALID_HANDLE_VALUE;
+        HANDLE mapping_ = nullptr;
+#endif
+
+    public:
+        mapped_file() = default;
+        ~mapped_file() { close(); }
+
+        mapped_file(const mapped_file&) = delete;
+        mapped_file& operator=(const mapped_file&) = delete;
+
+        bool open(const std::string& path) {
+            close();
+#ifdef _WIN32
+            file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file_ == INVALID_HANDLE_VALUE) return false;
+
+            LARGE_INTEGER file_size = {};
+            if (!GetFileSizeEx(file_, &file_size) || file_size.QuadPart <= 0) { close(); return false; }
+
+            mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (!mapping_) { close(); return false; }
+
+            data_ = static_cast<const unsigned char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+            if (!data_) { close(); return false; }
+            size_ = static_cast<size_t>(file_size.QuadPart);
+#else
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) return false;
+
+            struct stat info = {};
+            if (fstat(fd, &info) != 0 || info.st_size <= 0) { ::close(fd); return false; }
+
+            void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (view == MAP_FAILED) return false;
+
+            data_ = static_cast<const unsigned char*>(view);
+            size_ = static_cast<size_t>(info.st_size);
+#endif
+            return true;
+        }
+
+        void close() {
+#ifdef _WIN32
+            if (data_) UnmapViewOfFile(data_);
+            if (mapping_) CloseHandle(mapping_);
+            if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+            mapping_ = nullptr;
+            file_ = INVALID_HANDLE_VALUE;
+#else
+            if (data_) munmap(const_cast<unsigned char*>(data_), size_);
+#endif
+            data_ = nullptr;
+            size_ = 0;
+        }
+
+        const unsigned char* data() const { return data_; }
+        size_t size() const { return size_; }
+    };
+
+    struct shader_cache_stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t insertions = 0;
+        uint64_t evictions = 0;
+        uint64_t corrupt_entries = 0;
+    };
+
+    constexpr size_t default_shader_cache_bytes = 16 * 1024 * 1024;
+
+    // Compiled shader blobs by key in one memory-mapped pack file, least recently used evicted past max_bytes.
+    // Entries with a bad checksum are dropped; a damaged entry table discards the rest of the file.
+    class shader_cache {
+    private:
+        struct pack_header {
+            char magic[4];
+            uint32_t version;
+            uint32_t entry_count;
+            uint32_t reserved;
+            uint64_t tick;
+        };
+
+        struct pack_entry {
+            uint64_t key;
+            uint64_t last_use;
+            uint32_t size;
+            uint32_t checksum;
+        };
+
+        struct entry {
+            uint64_t last_use = 0;
+            const unsigned char* data = nullptr;
+            size_t size = 0;
+            std::vector<unsigned char> owned;
+        };
+
+        static constexpr uint32_t pack_version = 1;
+
+        std::string path_;
+        size_t max_bytes_;
+        mapped_file file_;
+        std::unordered_map<uint64_t, entry> entries_;
+        size_t total_bytes_ = 0;
+        uint64_t tick_ = 0;
+        bool dirty_ = false;
+        shader_cache_stats stats_;
+
+        static uint32_t checksum(const unsigned char* data, size_t size) {
+            uint64_t hash = fnv1a_64(data, size);
+            return static_cast<uint32_t>(hash ^ (hash >> 32));
+        }
+
+        static size_t padded(size_t size) { return (size + 7) & ~static_cast<size_t>(7); }
+
+        void evict_to_budget() {
+            while (total_bytes_ > max_bytes_ && !entries_.empty()) {
+                auto oldest = entries_.begin();
+                for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+                    if (it->second.last_use < oldest->second.last_use) oldest = it;
+                }
+                total_bytes_ -= oldest->second.size;
+                entries_.erase(oldest);
+                stats_.evictions++;
+                dirty_ = true;
+            }
+        }
+
+        // Blobs served from the mapping must be copied out before the mapping goes away.
+        void detach_from_file() {
+            for (auto& item : entries_) {
+                entry& cached = item.second;
+                if (!cached.owned.empty()) continue;
+                cached.owned.assign(cached.data, cached.data + cached.size);
+                cached.data = cached.owned.data();
+            }
+            file_.close();
+        }
+
+    public:
+        explicit shader_cache(std::string path, size_t max_bytes = default_shader_cache_bytes)
+            : path_(std::move(path)), max_bytes_(max_bytes) {}
+
+        shader_cache(const shader_cache&) = delete;
+        shader_cache& operator=(const shader_cache&) = delete;
+
+        // Replaces the in-memory contents with the pack file. A missing file is an empty cache, not an error;
+        // false means the file existed but its header was unusable.
+        bool load() {
+            clear();
+            if (!file_.open(path_)) return !std::filesystem::exists(path_);
+
+            const unsigned char* data = file_.data();
+            size_t size = file_.size();
+
+            pack_header header;
+            if (size < sizeof(header)) { file_.close(); stats_.corrupt_entries++; return false; }
+            std::memcpy(&header, data, sizeof(header));
+            if (std::memcmp(header.magic, "BLSC", 4) != 0 || header.version != pack_version) {
+                file_.close();
+                stats_.corrupt_entries++;
+                return false;
+            }
+
+            tick_ = header.tick;
+            size_t offset = sizeof(header);
+            for (uint32_t i = 0; i < header.entry_count; i++) {
+                pack_entry record;
+                if (size - offset < sizeof(record)) { stats_.corrupt_entries += header.entry_count - i; dirty_ = true; break; }
+                std::memcpy(&record, data + offset, sizeof(record));
+                offset += sizeof(record);
+
+                if (size - offset < record.size) { stats_.corrupt_entries += header.entry_count - i; dirty_ = true; break; }
+                const unsigned char* blob = data + offset;
+                offset += padded(record.size) < size - offset ? padded(record.size) : size - offset;
+
+                if (record.size == 0 || checksum(blob, record.size) != record.checksum || entries_.count(record.key)) {
+                    stats_.corrupt_entries++;
+                    dirty_ = true;
+                    continue;
+                }
+
+                entry& cached = entries_[record.key];
+                cached.last_use = record.last_use;
+                cached.data = blob;
+                cached.size = record.size;
+                total_bytes_ += record.size;
+            }
+
+            evict_to_budget();
+            return true;
+        }
+
+        // Valid until the entry is evicted or the cache is cleared or reloaded.
+        shader_bytecode find(uint64_t key) {
+            auto it = entries_.find(key);
+            if (it == entries_.end()) {
+                stats_.misses++;
+                return {};
+            }
+
+            stats_.hits++;
+            it->second.last_use = ++tick_;
+            return { it->second.data, it->second.size };
+        }
+
+        void insert(uint64_t key, const void* data, size_t size) {
+            if (!data || size == 0 || size > max_bytes_ || size > UINT32_MAX) return;
+
+            auto it = entries_.find(key);
+            if (it != entries_.end()) {
+                total_bytes_ -= it->second.size;
+                entries_.erase(it);
+            }
+
+            entry& cached = entries_[key];
+            cached.owned.assign(static_cast<const unsigned char*>(data), static_cast<const unsigned char*>(data) + size);
+            cached.data = cached.owned.data();
+            cached.size = size;
+            cached.last_use = ++tick_;
+            total_bytes_ += size;
+            stats_.insertions++;
+            dirty_ = true;
+
+            evict_to_budget();
+        }
+
+        // Written next to the pack and renamed over it, so a crash leaves the previous pack intact.
+        bool save() {
+            if (!dirty_) return true;
+
+            detach_from_file();
+
+            std::error_code error;
+            std::filesystem::path path(path_);
+            if (path.has_parent_path()) std::filesystem::create_directories(path.parent_path(), error);
+
+            std::string temp_path = path_ + ".tmp";
+            {
+                std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+                if (!out) return false;
+
+                pack_header header = { { 'B', 'L', 'S', 'C' }, pack_version, static_cast<uint32_t>(entries_.size()), 0, tick_ };
+                out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+                static const char padding[8] = {};
+                for (const auto& item : entries_) {
+                    const entry& cached = item.second;
+                    pack_entry record = { item.first, cached.last_use, static_cast<uint32_t>(cached.size), checksum(cached.data, cached.size) };
+                    out.write(reinterpret_cast<const char*>(&record), sizeof(record));
+                    out.write(reinterpret_cast<const char*>(cached.data), static_cast<std::streamsize>(cached.size));
+                    out.write(padding, static_cast<std::streamsize>(padded(cached.size) - cached.size));
+                }
+
+                if (!out) return false;
+            }
+
+            std::filesystem::rename(temp_path, path_, error);
+            if (error) {
+                std::filesystem::remove(temp_path, error);
+                return false;
+            }
+
+            dirty_ = false;
+            return true;
+        }
+
+        void clear() {
+            entries_.clear();
+            file_.close();
+            total_bytes_ = 0;
+            dirty_ = false;
+        }
+
+        void set_max_bytes(size_t max_bytes) {
+            max_bytes_ = max_bytes;
+            evict_to_budget();
+        }
+
+        const std::string& path() const { return path_; }
+        size_t max_bytes() const { return max_bytes_; }
+        size_t size_bytes() const { return total_bytes_; }
+        size_t entry_count() const { return entries_.size(); }
+        bool dirty() const { return dirty_; }
+        const shader_cache_stats& stats() const { return stats_; }
+        void reset_stats() { stats_ = {}; }
+    };
+
+    // %LOCALAPPDATA%\imgui-dx11-blur\shaders.bin on Windows, $XDG_CACHE_HOME/imgui-dx11-blur/shaders.bin or
+    // ~/.cache/imgui-dx11-blur/shaders.bin elsewhere. Falls back to the working directory.
+    inline std::string default_shader_cache_path() {
+        std::filesystem::path base;
+#ifdef _WIN32
+        if (const char* local = std::getenv("LOCALAPPDATA")) base = local;
+#else
+        if (const char* xdg = std::getenv("XDG_CACHE_HOME")) base = xdg;
+        else if (const char* home = std::getenv("HOME")) base = std::filesystem::path(home) / ".cache";
+#endif
+        if (base.empty()) return "shaders.bin";
+        return (base / "imgui-dx11-blur" / "shaders.bin").string();
+    }
+
+}
+
+#endif
@@ -0,0 +1,271 @@
+#ifndef BLUR_SHADERS_HPP
+#define BLUR_SHADERS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+namespace blur {
+namespace shaders {
+
+    // One instance per atlas region, drawn at target_rect (NDC) from source_rect (uv). Taps are clamped to uv_clamp,
+    // the region's outermost texel centres.
+    inline constexpr const char* vertex_source = R"(
+    struct VS_INPUT {
+        float3 position : POSITION; float2 uv : TEXCOORD0;
+        float4 target_rect : TEXCOORD1; float4 source_rect : TEXCOORD2; float4 uv_clamp : TEXCOORD3; float pass_value : TEXCOORD4;
+    };
+    struct VS_OUTPUT { float4 position : SV_POSITION; float2 uv : TEXCOORD0; nointerpolation float4 uv_clamp : TEXCOORD1; nointerpolation float pass_value : TEXCOORD2; };
+    VS_OUTPUT main(VS_INPUT input) {
+        VS_OUTPUT output;
+        output.position = float4(lerp(input.target_rect.xy, input.target_rect.zw, input.uv), 0.0f, 1.0f);
+        output.uv = lerp(input.source_rect.xy, input.source_rect.zw, input.uv);
+        output.uv_clamp = input.uv_clamp;
+        output.pass_value = input.pass_value;
+        return output;
+    })";
+
+    inline constexpr const char* horizontal_blur_source = R"(
+    cbuffer BlurConstants : register(b0) { float2 texture_size; int downsample_factor; int tap_count; float4 taps[65]; };
+    Texture2D source_texture : register(t0);
+    SamplerState texture_sampler : register(s0);
+    struct PS_INPUT { float4 position : SV_POSITION; float2 uv : TEXCOORD0; nointerpolation float4 uv_clamp : TEXCOORD1; nointerpolation float blur_strength : TEXCOORD2; };
+    float4 main(PS_INPUT input) : SV_Target {
+        float2 pixel_step = float2(input.blur_strength / texture_size.x, 0.0f);
+        float4 color = source_texture.Sample(texture_sampler, input.uv) * taps[0].y;
+        for (int i = 1; i < tap_count; i++) {
+            float2 offset = pixel_step * taps[i].x;
+            color += source_texture.Sample(texture_sampler, clamp(input.uv + offset, input.uv_clamp.xy, input.uv_clamp.zw)) * taps[i].y;
+            color += source_texture.Sample(texture_sampler, clamp(input.uv - offset, input.uv_clamp.xy, input.uv_clamp.zw)) * taps[i].y;
+        }
+        return color;
+    })";
+
+    inline constexpr const char* vertical_blur_source = R"(
+    cbuffer BlurConstants : register(b0) { float2 texture_size; int downsample_factor; int tap_count; float4 taps[65]; };
+    Texture2D source_texture : register(t0);
+    SamplerState texture_sampler : register(s0);
+    struct PS_INPUT { float4 position : SV_POSITION; float2 uv : TEXCOORD0; nointerpolation float4 uv_clamp : TEXCOORD1; nointerpolation float blur_strength : TEXCOORD2; };
+    float4 main(PS_INPUT input) : SV_Target {
+        float2 pixel_step = float2(0.0f, input.blur_strength / texture_size.y);
+        float4 color = source_texture.Sample(texture_sampler, input.uv) * taps[0].y;
+        for (int i = 1; i < tap_count; i++) {
+            float2 offset = pixel_step * taps[i].x;
+            color += source_texture.Sample(texture_sampler, clamp(input.uv + offset, input.uv_clamp.xy, input.uv_clamp.zw)) * taps[i].y;
+            color += source_texture.Sample(texture_sampler, clamp(input.uv - offset, input.uv_clamp.xy, input.uv_clamp.zw)) * taps[i].y;
+        }
+        return color;
+    })";
+
+    inline constexpr const char* kawase_down_source = R"(
+    cbuffer BlurConstants : register(b0) { float2 texture_size; int downsample_factor; int tap_count; };
+    Texture2D source_texture : register(t0);
+    SamplerState texture_sampler : register(s0);
+    struct PS_INPUT { float4 position : SV_POSITION; float2 uv : TEXCOORD0; nointerpolation float4 uv_clamp : TEXCOORD1; nointerpolation float blur_strength : TEXCOORD2; };
+    float4 tap(PS_INPUT input, float2 offset) { return source_texture.Sample(texture_sampler, clamp(input.uv + offset, input.uv_clamp.xy, input.uv_clamp.zw)); }
+    float4 main(PS_INPUT input) : SV_Target {
+        float2 offset = input.blur_strength / texture_size;
+        float4 color = tap(input, float2(0.0f, 0.0f)) * 4.0f;
+        color += tap(input, -offset);
+        color += tap(input, offset);
+        color += tap(input, float2(offset.x, -offset.y));
+        color += tap(input, float2(-offset.x, offset.y));
+        return color / 8.0f;
+    })";
+
+    inline constexpr const char* kawase_up_source = R"(
+    cbuffer BlurConstants : register(b0) { float2 texture_size; int downsample_factor; int tap_count; };
+    Texture2D source_texture : register(t0);
+    SamplerState texture_sampler : register(s0);
+    struct PS_INPUT { float4 position : SV_POSITION; float2 uv : TEXCOORD0; nointerpolation float4 uv_clamp : TEXCOORD1; nointerpolation float blur_strength : TEXCOORD2; };
+    float4 tap(PS_INPUT input, float2 offset) { return source_texture.Sample(texture_sampler, clamp(input.uv + offset, input.uv_clamp.xy, input.uv_clamp.zw)); }
+    float4 main(PS_INPUT input) : SV_Target {
+        float2 offset = input.blur_strength / texture_size;
+        float4 color = tap(input, float2(-offset.x, 0.0f));
+        color += tap(input, float2(offset.x, 0.0f));
+        color += tap(input, float2(0.0f, -offset.y));
+        color += tap(input, float2(0.0f, offset.y));
+        color += tap(input, float2(-offset.x, -offset.y) * 0.5f) * 2.0f;
+        color += tap(input, float2(offset.x, -offset.y) * 0.5f) * 2.0f;
+        color += tap(input, float2(-offset.x, offset.y) * 0.5f) * 2.0f;
+        color += tap(input, float2(offset.x, offset.y) * 0.5f) * 2.0f;
+        return color / 12.0f;
+    })";
+
+    // Each output texel averages its downsample_factor x downsample_factor block with bilinear fetches between texel
+    // pairs.
+    inline constexpr const char* downsample_source = R"(
+    cbuffer BlurConstants : register(b0) { float2 texture_size; int downsample_factor; int tap_count; };
+    Texture2D source_texture : register(t0);
+    SamplerState texture_sampler : register(s0);
+    struct PS_INPUT { float4 position : SV_POSITION; float2 uv : TEXCOORD0; nointerpolation float4 uv_clamp : TEXCOORD1; nointerpolation float blur_strength : TEXCOORD2; };
+    float4 main(PS_INPUT input) : SV_Target {
+        int half_factor = downsample_factor / 2;
+        float2 block_centre = input.uv * texture_size;
+        float4 color = float4(0.0f, 0.0f, 0.0f, 0.0f);
+        for (int y = 0; y < half_factor; y++) {
+            for (int x = 0; x < half_factor; x++) {
+                float2 position = block_centre + float2(2 * x + 1 - half_factor, 2 * y + 1 - half_factor);
+                color += source_texture.Sample(texture_sampler, clamp(position / texture_size, input.uv_clamp.xy, input.uv_clamp.zw));
+            }
+        }
+        return color / (half_factor * half_factor);
+    })";
+
+    // One pyramid level from the level above: four bilinear fetches at +-blur_strength (0.75) source texels form the
+    // [1 3 3 1] x [1 3 3 1] binomial around the 2 x 2 block each output texel covers.
+    inline constexpr const char* pyramid_down_source = R"(
+    cbuffer BlurConstants : register(b0) { float2 texture_size; int downsample_factor; int tap_count; };
+    Texture2D source_texture : register(t0);
+    SamplerState texture_sampler : register(s0);
+    struct PS_INPUT { float4 position : SV_POSITION; float2 uv : TEXCOORD0; nointerpolation float4 uv_clamp : TEXCOORD1; nointerpolation float blur_strength : TEXCOORD2; };
+    float4 tap(PS_INPUT input, float2 offset) { return source_texture.Sample(texture_sampler, clamp(input.uv + offset, input.uv_clamp.xy, input.uv_clamp.zw)); }
+    float4 main(PS_INPUT input) : SV_Target {
+        float2 offset = input.blur_strength / texture_size;
+        float4 color = tap(input, -offset);
+        color += tap(input, offset);
+        color += tap(input, float2(offset.x, -offset.y));
+        color += tap(input, float2(-offset.x, offset.y));
+        return color * 0.25f;
+    })";
+
+    // Reads the pyramid at a fractional level; the MIN_MAG_MIP_LINEAR sampler blends the two nearest levels.
+    inline constexpr const char* pyramid_resolve_source = R"(
+    Texture2D source_texture : register(t0);
+    SamplerState texture_sampler : register(s0);
+    struct PS_INPUT { float4 position : SV_POSITION; float2 uv : TEXCOORD0; nointerpolation float4 uv_clamp : TEXCOORD1; nointerpolation float lod : TEXCOORD2; };
+    float4 main(PS_INPUT input) : SV_Target {
+        return source_texture.SampleLevel(texture_sampler, clamp(input.uv, input.uv_clamp.xy, input.uv_clamp.zw), input.lod);
+    })";
+
+    // Compares a new capture (t0) with the one last blurred (t1). Texels whose largest channel difference exceeds the
+    // threshold survive and are counted by an occlusion predicate; the pass writes no colour.
+    inline constexpr const char* change_test_source = R"(
+    Texture2D current_texture : register(t0);
+    Texture2D reference_texture : register(t1);
+    SamplerState texture_sampler : register(s0);
+    struct PS_INPUT { float4 position : SV_POSITION; float2 uv : TEXCOORD0; nointerpolation float4 uv_clamp : TEXCOORD1; nointerpolation float threshold : TEXCOORD2; };
+    float4 main(PS_INPUT input) : SV_Target {
+        float2 uv = clamp(input.uv, input.uv_clamp.xy, input.uv_clamp.zw);
+        float3 difference = abs(current_texture.Sample(texture_sampler, uv).rgb - reference_texture.Sample(texture_sampler, uv).rgb);
+        if (max(difference.r, max(difference.g, difference.b)) <= input.threshold) discard;
+        return float4(0.0f, 0.0f, 0.0f, 0.0f);
+    })";
+
+    inline constexpr const char* blur_compute_source = R"(
+    #define TILE 16
+    #define APRON 8
+    #define SPAN (TILE + 2 * APRON)
+    cbuffer BlurConstants : register(b0) { float2 texture_size; int downsample_factor; int tap_count; float4 taps[65]; int4 region; int4 source_origin; };
+    Texture2D<float4> source_texture : register(t0);
+    RWTexture2D<unorm float4> output_texture : register(u0);
+    groupshared float4 input_tile[SPAN][SPAN];
+    groupshared float4 row_tile[SPAN][TILE];
+    [numthreads(TILE, TILE, 1)]
+    void main(uint3 group_id : SV_GroupID, uint3 thread_id : SV_GroupThreadID, uint3 dispatch_id : SV_DispatchThreadID) {
+        int2 size = region.zw;
+        int2 origin = int2(group_id.xy) * TILE - APRON;
+        for (int load_y = thread_id.y; load_y < SPAN; load_y += TILE) {
+            for (int load_x = thread_id.x; load_x < SPAN; load_x += TILE) {
+                int2 coord = source_origin.xy + clamp(origin + int2(load_x, load_y), int2(0, 0), size - 1);
+                input_tile[load_y][load_x] = source_texture.Load(int3(coord, 0));
+            }
+        }
+        GroupMemoryBarrierWithGroupSync();
+        for (int row = thread_id.y; row < SPAN; row += TILE) {
+            float4 color = float4(0.0f, 0.0f, 0.0f, 0.0f);
+            for (int i = 0; i < tap_count; i++) color += input_tile[row][thread_id.x + APRON + int(taps[i].x)] * taps[i].y;
+            row_tile[row][thread_id.x] = color;
+        }
+        GroupMemoryBarrierWithGroupSync();
+        float4 color = float4(0.0f, 0.0f, 0.0f, 0.0f);
+        for (int i = 0; i < tap_count; i++) color += row_tile[thread_id.y + APRON + int(taps[i].x)][thread_id.x] * taps[i].y;
+        if (all(int2(dispatch_id.xy) < size)) output_texture[region.xy + int2(dispatch_id.xy)] = color;
+    })";
+
+}
+
+    enum class shader_id {
+        vertex,
+        horizontal_blur,
+        vertical_blur,
+        kawase_down,
+        kawase_up,
+        downsample,
+        pyramid_down,
+        pyramid_resolve,
+        change_test,
+        compute_blur,
+        count
+    };
+
+    struct shader_source {
+        const char* name;
+        const char* target;
+        const char* source;
+    };
+
+    // Indexed by shader_id; name is also the file stem tools/bake_shaders uses for the .hlsl and .dxbc files.
+    inline constexpr shader_source shader_sources[] = {
+        { "vertex", "vs_5_0", shaders::vertex_source },
+        { "horizontal_blur", "ps_5_0", shaders::horizontal_blur_source },
+        { "vertical_blur", "ps_5_0", shaders::vertical_blur_source },
+        { "kawase_down", "ps_5_0", shaders::kawase_down_source },
+        { "kawase_up", "ps_5_0", shaders::kawase_up_source },
+        { "downsample", "ps_5_0", shaders::downsample_source },
+        { "pyramid_down", "ps_5_0", shaders::pyramid_down_source },
+        { "pyramid_resolve", "ps_5_0", shaders::pyramid_resolve_source },
+        { "change_test", "ps_5_0", shaders::change_test_source },
+        { "compute_blur", "cs_5_0", shaders::blur_compute_source },
+    };
+
+    static_assert(sizeof(shader_sources) / sizeof(shader_sources[0]) == static_cast<size_t>(shader_id::count),
+        "shader_sources must list every shader_id");
+
+    inline const shader_source& get_shader_source(shader_id id) {
+        return shader_sources[static_cast<int>(id)];
+    }
+
+    // FNV-1a over every name, target and source. tools/bake_shaders stamps it into the generated header, so bytecode
+    // baked from older sources is ignored instead of silently running shaders that no longer match the host code.
+    constexpr uint64_t hash_shader_sources() {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (const shader_source& shader : shader_sources) {
+            for (const char* text : { shader.name, shader.target, shader.source }) {
+                for (const char* c = text; *c; c++) hash = (hash ^ static_cast<unsigned char>(*c)) * 0x100000001b3ull;
+                hash = (hash ^ 0xffu) * 0x100000001b3ull;
+            }
+        }
+        return hash;
+    }
+
+    struct shader_bytecode {
+        const unsigned char* data = nullptr;
+        size_t size = 0;
+    };
+
+}
+
+// Define BLUR_RUNTIME_SHADER_COMPILE to ignore a generated header and always compile with D3DCompile.
+#if defined(__has_include) && !defined(BLUR_RUNTIME_SHADER_COMPILE)
+#if __has_include("blur_shaders_bytecode.hpp")
+#include "blur_shaders_bytecode.hpp"
+#define BLUR_HAS_PRECOMPILED_SHADERS
+#endif
+#endif
+
+namespace blur {
+
+    // Empty when there is no generated header, it is stale, or the offline compiler could not build this shader;
+    // blur_renderer falls back to compiling the source at runtime in all three cases.
+    inline shader_bytecode precompiled_shader(shader_id id) {
+#ifdef BLUR_HAS_PRECOMPILED_SHADERS
+        if (precompiled::source_hash == hash_shader_sources()) return precompiled::bytecode[static_cast<int>(id)];
+#endif
+        (void)id;
+        return {};
+    }
+
+}
+
+#endif
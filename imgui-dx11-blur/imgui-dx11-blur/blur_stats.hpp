@@ -0,0 +1,308 @@
+#ifndef BLUR_STATS_HPP
+#define BLUR_STATS_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace blur {
+
+    namespace stats {
+
+        // GPU work timed separately. A stage can run several times in a frame (one pass per kernel group, one
+        // composite per window); the frame's sample is their sum.
+        enum class stage {
+            capture,        // backdrop copies into the capture atlas
+            reduce,         // downsample into the blur atlas
+            horizontal,
+            vertical,
+            kawase,
+            pyramid,        // the shared backdrop's mip chain
+            resolve,        // pyramid windows sampling their level
+            change_test,
+            compute,
+            composite,      // blurred images drawn into the windows by the ImGui backend
+            count
+        };
+
+        constexpr int stage_count = static_cast<int>(stage::count);
+
+        inline const char* stage_name(stage value) {
+            switch (value) {
+            case stage::capture: return "capture";
+            case stage::reduce: return "reduce";
+            case stage::horizontal: return "horizontal";
+            case stage::vertical: return "vertical";
+            case stage::kawase: return "kawase";
+            case stage::pyramid: return "pyramid";
+            case stage::resolve: return "resolve";
+            case stage::change_test: return "change test";
+            case stage::compute: return "compute";
+            case stage::composite: return "composite";
+            default: return "";
+            }
+        }
+
+        struct summary {
+            int samples = 0;
+            double last_ms = 0.0;
+            double min_ms = 0.0;
+            double avg_ms = 0.0;
+            double p99_ms = 0.0;
+        };
+
+        constexpr size_t default_window = 240;
+
+        // The last capacity samples. summarize() sorts a copy, so it belongs where the numbers are displayed rather
+        // than where samples are added.
+        class rolling_window {
+        private:
+            std::vector<double> samples_;
+            size_t capacity_;
+            size_t next_ = 0;
+            double last_ = 0.0;
+            mutable std::vector<double> sorted_;
+
+        public:
+            explicit rolling_window(size_t capacity = default_window) : capacity_(std::max<size_t>(capacity, 1)) {}
+
+            void add(double value) {
+                if (samples_.size() < capacity_) samples_.push_back(value);
+                else samples_[next_] = value;
+                next_ = (next_ + 1) % capacity_;
+                last_ = value;
+            }
+
+            void clear() {
+                samples_.clear();
+                next_ = 0;
+                last_ = 0.0;
+            }
+
+            // p99 is nearest-rank: the smallest sample at or above 99% of them.
+            summary summarize() const {
+                summary result;
+                result.samples = static_cast<int>(samples_.size());
+                if (samples_.empty()) return result;
+
+                sorted_.assign(samples_.begin(), samples_.end());
+                std::sort(sorted_.begin(), sorted_.end());
+                double total = 0.0;
+                for (double value : sorted_) total += value;
+
+                size_t rank = static_cast<size_t>(std::ceil(0.99 * sorted_.size()));
+                result.last_ms = last_;
+                result.min_ms = sorted_.front();
+                result.avg_ms = total / sorted_.size();
+                result.p99_ms = sorted_[std::max<size_t>(rank, 1) - 1];
+                return result;
+            }
+
+            size_t size() const { return samples_.size(); }
+            size_t capacity() const { return capacity_; }
+        };
+
+        // One frame read back from the GPU. runs counts the timed ranges of each stage; cpu_ns is the steady_clock
+        // time at which the frame's first timestamp was issued.
+        struct frame_timing {
+            uint64_t frame = 0;
+            int64_t cpu_ns = 0;
+            double total_ms = 0.0;
+            double stage_ms[stage_count] = {};
+            int runs[stage_count] = {};
+        };
+
+        // One timed range, relative to the first timestamp of its frame.
+        struct gpu_range {
+            stage kind;
+            double begin_ms;
+            double end_ms;
+        };
+
+        constexpr int timestamp_frames = 3;
+        constexpr int max_frame_timestamps = 256;
+
+        // Timestamp pairs of the last timestamp_frames frames, read back in order without waiting; a slot still
+        // pending when its turn comes round is dropped. Source: available(), begin_frame(slot), timestamp(slot,
+        // index), end_frame(slot), read(slot, count, ticks, frequency, disjoint), false while not ready.
+        template <typename Source>
+        class timestamp_ring {
+        private:
+            static constexpr int max_pairs = max_frame_timestamps / 2;
+
+            struct frame_slot {
+                bool open = false;
+                bool pending = false;
+                int count = 0;
+                uint64_t frame = 0;
+                int64_t cpu_ns = 0;
+                stage stages[max_pairs] = {};
+                bool began[max_pairs] = {};
+                bool ended[max_pairs] = {};
+            };
+
+            Source source_;
+            frame_slot slots_[timestamp_frames];
+            uint64_t ticks_[max_frame_timestamps] = {};
+            int current_ = 0;
+            uint64_t frame_ = 0;
+            uint64_t dropped_ = 0;
+            uint64_t disjoint_ = 0;
+            uint64_t overflow_ = 0;
+
+        public:
+            // Starts a range of stage in the current frame. Returns the handle for end(), -1 if nothing is timed.
+            int begin(stage value) {
+                frame_slot& slot = slots_[current_];
+                if (!slot.open) {
+                    if (!source_.available() || !source_.begin_frame(current_)) return -1;
+                    slot.open = true;
+                    slot.count = 0;
+                    slot.frame = frame_;
+                    slot.cpu_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now().time_since_epoch()).count();
+                }
+                if (slot.count >= max_pairs) {
+                    overflow_++;
+                    return -1;
+                }
+
+                int pair = slot.count++;
+                slot.stages[pair] = value;
+                slot.began[pair] = source_.timestamp(current_, pair * 2);
+                slot.ended[pair] = false;
+                return pair;
+            }
+
+            void end(int pair) {
+                frame_slot& slot = slots_[current_];
+                if (pair < 0 || !slot.open || pair >= slot.count || slot.ended[pair]) return;
+                slot.ended[pair] = source_.timestamp(current_, pair * 2 + 1);
+            }
+
+            // Closes the current frame and moves to the oldest slot, dropping it if it was never read back. A range
+            // left open is ended here so every query of the frame has been issued; its time is not reported.
+            void next_frame() {
+                frame_slot& slot = slots_[current_];
+                if (slot.open) {
+                    for (int pair = 0; pair < slot.count; pair++) {
+                        if (!slot.ended[pair]) source_.timestamp(current_, pair * 2 + 1);
+                    }
+                    source_.end_frame(current_);
+                    slot.open = false;
+                    slot.pending = true;
+                }
+                frame_++;
+                current_ = (current_ + 1) % timestamp_frames;
+
+                frame_slot& next = slots_[current_];
+                if (next.pending) {
+                    next.pending = false;
+                    dropped_++;
+                }
+            }
+
+            // The oldest finished frame, if any, and optionally its individual ranges. Frames the GPU clock was
+            // unreliable for are skipped.
+            bool collect(frame_timing& out, std::vector<gpu_range>* ranges = nullptr) {
+                for (int i = 1; i <= timestamp_frames; i++) {
+                    int index = (current_ + i) % timestamp_frames;
+                    frame_slot& slot = slots_[index];
+                    if (!slot.pending) continue;
+
+                    uint64_t frequency = 0;
+                    bool disjoint = false;
+                    if (!source_.read(index, slot.count * 2, ticks_, frequency, disjoint)) return false;
+
+                    slot.pending = false;
+                    if (disjoint || frequency == 0) {
+                        disjoint_++;
+                        continue;
+                    }
+
+                    out = {};
+                    out.frame = slot.frame;
+                    out.cpu_ns = slot.cpu_ns;
+                    if (ranges) ranges->clear();
+
+                    uint64_t first = UINT64_MAX;
+                    for (int pair = 0; pair < slot.count; pair++) {
+                        if (slot.began[pair] && slot.ended[pair]) first = std::min(first, ticks_[pair * 2]);
+                    }
+
+                    double ms_per_tick = 1000.0 / static_cast<double>(frequency);
+                    for (int pair = 0; pair < slot.count; pair++) {
+                        uint64_t begin = ticks_[pair * 2];
+                        uint64_t end = ticks_[pair * 2 + 1];
+                        if (!slot.began[pair] || !slot.ended[pair] || end < begin) continue;
+
+                        double ms = static_cast<double>(end - begin) * ms_per_tick;
+                        int stage_index = static_cast<int>(slot.stages[pair]);
+                        out.stage_ms[stage_index] += ms;
+                        out.runs[stage_index]++;
+                        out.total_ms += ms;
+                        if (ranges) {
+                            double offset = static_cast<double>(begin - first) * ms_per_tick;
+                            ranges->push_back({ slot.stages[pair], offset, offset + ms });
+                        }
+                    }
+                    return true;
+                }
+                return false;
+            }
+
+            // Forgets every slot, e.g. before the source's queries are released.
+            void reset() {
+                for (frame_slot& slot : slots_) slot = frame_slot{};
+                current_ = 0;
+            }
+
+            Source& source() { return source_; }
+            const Source& source() const { return source_; }
+            uint64_t dropped() const { return dropped_; }
+            uint64_t disjoint() const { return disjoint_; }
+            uint64_t overflow() const { return overflow_; }
+        };
+
+        // Rolling statistics per stage over the frames read back. A stage only contributes samples for frames it
+        // ran in, so a blur pass that runs once a second is not averaged against zeros.
+        class gpu_timings {
+        private:
+            rolling_window stages_[stage_count];
+            rolling_window total_;
+            uint64_t frames_ = 0;
+            uint64_t lost_frames_ = 0;
+
+        public:
+            void add(const frame_timing& frame) {
+                for (int i = 0; i < stage_count; i++) {
+                    if (frame.runs[i] > 0) stages_[i].add(frame.stage_ms[i]);
+                }
+                total_.add(frame.total_ms);
+                frames_++;
+            }
+
+            void clear() {
+                for (rolling_window& window : stages_) window.clear();
+                total_.clear();
+                frames_ = 0;
+                lost_frames_ = 0;
+            }
+
+            summary stage_summary(stage value) const { return stages_[static_cast<int>(value)].summarize(); }
+            summary total() const { return total_.summarize(); }
+            uint64_t frames() const { return frames_; }
+
+            // Frames dropped unread or with a disjoint clock.
+            uint64_t lost_frames() const { return lost_frames_; }
+            void add_lost_frames(uint64_t count) { lost_frames_ += count; }
+        };
+
+    }
+
+}
+
+#endif
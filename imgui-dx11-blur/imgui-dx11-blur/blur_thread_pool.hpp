@@ -0,0 +1,184 @@
+#ifndef BLUR_THREAD_POOL_HPP
+#define BLUR_THREAD_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace blur {
+
+    struct worker_stats {
+        uint64_t tasks = 0;
+        uint64_t steals = 0;
+        double busy_seconds = 0.0;
+    };
+
+    // Fork/join pool for the CPU blur. Slot 0 is the thread calling parallel_for, slots 1..N-1 are workers.
+    // Each slot owns a deque: it pops its own work from the back and steals from the front of the others.
+    class thread_pool {
+    private:
+        struct slot_queue {
+            std::mutex mutex;
+            std::deque<int> tasks;
+        };
+
+        using job = std::function<void(int index, int slot)>;
+
+        std::vector<std::thread> threads_;
+        std::vector<std::unique_ptr<slot_queue>> queues_;
+        std::vector<worker_stats> stats_;
+        double wall_seconds_ = 0.0;
+
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        std::condition_variable done_;
+        std::atomic<const job*> job_{ nullptr };
+        std::atomic<int> remaining_{ 0 };
+        uint64_t generation_ = 0;
+        bool stopping_ = false;
+
+        bool pop_task(int slot, int& index) {
+            slot_queue& own = *queues_[slot];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (own.tasks.empty()) return false;
+            index = own.tasks.back();
+            own.tasks.pop_back();
+            return true;
+        }
+
+        bool steal_task(int slot, int& index) {
+            int count = static_cast<int>(queues_.size());
+            for (int i = 1; i < count; i++) {
+                slot_queue& victim = *queues_[(slot + i) % count];
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                if (victim.tasks.empty()) continue;
+                index = victim.tasks.front();
+                victim.tasks.pop_front();
+                return true;
+            }
+            return false;
+        }
+
+        void run_tasks(int slot) {
+            int index = 0;
+            for (;;) {
+                bool stolen = false;
+                if (!pop_task(slot, index)) {
+                    if (!steal_task(slot, index)) return;
+                    stolen = true;
+                }
+
+                auto start = std::chrono::steady_clock::now();
+                (*job_.load(std::memory_order_acquire))(index, slot);
+                auto end = std::chrono::steady_clock::now();
+
+                worker_stats& stats = stats_[slot];
+                stats.tasks++;
+                if (stolen) stats.steals++;
+                stats.busy_seconds += std::chrono::duration<double>(end - start).count();
+
+                if (remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    done_.notify_all();
+                }
+            }
+        }
+
+        void worker_main(int slot) {
+            uint64_t seen = 0;
+            for (;;) {
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    wake_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+                    if (stopping_) return;
+                    seen = generation_;
+                }
+                run_tasks(slot);
+            }
+        }
+
+    public:
+        explicit thread_pool(int thread_count = 0) {
+            if (thread_count <= 0) thread_count = static_cast<int>(std::thread::hardware_concurrency());
+            thread_count = std::max(thread_count, 1);
+
+            for (int i = 0; i < thread_count; i++) queues_.push_back(std::make_unique<slot_queue>());
+            stats_.resize(thread_count);
+            for (int i = 1; i < thread_count; i++) threads_.emplace_back(&thread_pool::worker_main, this, i);
+        }
+
+        ~thread_pool() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stopping_ = true;
+            }
+            wake_.notify_all();
+            for (std::thread& thread : threads_) thread.join();
+        }
+
+        thread_pool(const thread_pool&) = delete;
+        thread_pool& operator=(const thread_pool&) = delete;
+
+        int thread_count() const { return static_cast<int>(queues_.size()); }
+
+        // Runs fn(index, slot) for index in [0, count) and returns once all of them finished.
+        void parallel_for(int count, const job& fn) {
+            if (count <= 0) return;
+
+            auto start = std::chrono::steady_clock::now();
+            int slots = thread_count();
+
+            job_.store(&fn, std::memory_order_release);
+            remaining_.store(count, std::memory_order_release);
+            for (int slot = 0; slot < slots; slot++) {
+                int begin = static_cast<int>(static_cast<int64_t>(count) * slot / slots);
+                int end = static_cast<int>(static_cast<int64_t>(count) * (slot + 1) / slots);
+                std::lock_guard<std::mutex> lock(queues_[slot]->mutex);
+                for (int index = end - 1; index >= begin; index--) queues_[slot]->tasks.push_back(index);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                generation_++;
+            }
+            wake_.notify_all();
+
+            run_tasks(0);
+
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                done_.wait(lock, [&] { return remaining_.load(std::memory_order_acquire) == 0; });
+            }
+
+            wall_seconds_ += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        const std::vector<worker_stats>& stats() const { return stats_; }
+
+        double wall_seconds() const { return wall_seconds_; }
+
+        // Share of parallel_for wall time each slot spent running tasks.
+        std::vector<double> utilization() const {
+            std::vector<double> result(stats_.size(), 0.0);
+            if (wall_seconds_ <= 0.0) return result;
+            for (size_t i = 0; i < stats_.size(); i++) result[i] = stats_[i].busy_seconds / wall_seconds_;
+            return result;
+        }
+
+        void reset_stats() {
+            std::fill(stats_.begin(), stats_.end(), worker_stats{});
+            wall_seconds_ = 0.0;
+        }
+    };
+
+}
+
+#endif
@@ -0,0 +1,231 @@
+#ifndef BLUR_TILES_HPP
+#define BLUR_TILES_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "blur_atlas.hpp"
+#include "blur_hash.hpp"
+
+namespace blur {
+
+    constexpr int max_dirty_rects = 4;
+    constexpr int default_tile_size = 32;
+
+    inline int64_t rect_area(const atlas_rect& rect) { return static_cast<int64_t>(rect.width) * rect.height; }
+
+    inline atlas_rect union_rect(const atlas_rect& a, const atlas_rect& b) {
+        int x0 = std::min(a.x, b.x);
+        int y0 = std::min(a.y, b.y);
+        int x1 = std::max(a.x + a.width, b.x + b.width);
+        int y1 = std::max(a.y + a.height, b.y + b.height);
+        return { x0, y0, x1 - x0, y1 - y0 };
+    }
+
+    // Overlapping or sharing an edge.
+    inline bool rects_touch(const atlas_rect& a, const atlas_rect& b) {
+        return a.x <= b.x + b.width && b.x <= a.x + a.width && a.y <= b.y + b.height && b.y <= a.y + a.height;
+    }
+
+    // Grows rect by apron on every side, clipped to a width x height region.
+    inline atlas_rect expand_rect(const atlas_rect& rect, int apron, int width, int height) {
+        int x0 = std::max(rect.x - apron, 0);
+        int y0 = std::max(rect.y - apron, 0);
+        int x1 = std::min(rect.x + rect.width + apron, width);
+        int y1 = std::min(rect.y + rect.height + apron, height);
+        return { x0, y0, std::max(x1 - x0, 0), std::max(y1 - y0, 0) };
+    }
+
+    // Rects that touch become their bounding rect, repeatedly, since a union can reach further rects. Then, while
+    // more than max_count remain, the pair whose bounding rect adds the least area is merged. Returns the new count.
+    inline int merge_rects(atlas_rect* rects, int count, int max_count) {
+        for (bool merged = true; merged;) {
+            merged = false;
+            for (int i = 0; i < count; i++) {
+                for (int j = i + 1; j < count; j++) {
+                    if (!rects_touch(rects[i], rects[j])) continue;
+                    rects[i] = union_rect(rects[i], rects[j]);
+                    rects[j--] = rects[--count];
+                    merged = true;
+                }
+            }
+        }
+
+        while (count > std::max(max_count, 1)) {
+            int best_i = 0;
+            int best_j = 1;
+            int64_t best_growth = INT64_MAX;
+            for (int i = 0; i < count; i++) {
+                for (int j = i + 1; j < count; j++) {
+                    int64_t growth = rect_area(union_rect(rects[i], rects[j])) - rect_area(rects[i]) - rect_area(rects[j]);
+                    if (growth < best_growth) {
+                        best_growth = growth;
+                        best_i = i;
+                        best_j = j;
+                    }
+                }
+            }
+            rects[best_i] = union_rect(rects[best_i], rects[best_j]);
+            rects[best_j] = rects[--count];
+        }
+        return count;
+    }
+
+    // Hashes per tile every triangle whose clipped bounds reach it; finish() turns the tiles that changed since the
+    // last frame into a few rects grown by the blur's apron.
+    class tile_tracker {
+    private:
+        int width_ = 0;
+        int height_ = 0;
+        int tile_size_ = default_tile_size;
+        int tiles_x_ = 0;
+        int tiles_y_ = 0;
+        std::vector<uint64_t> current_;
+        std::vector<uint64_t> previous_;
+        std::vector<atlas_rect> runs_;
+        bool valid_ = false;
+        int dirty_tiles_ = 0;
+
+    public:
+        void reset(int width, int height, int tile_size) {
+            tile_size_ = std::max(tile_size, 1);
+            width_ = std::max(width, 0);
+            height_ = std::max(height, 0);
+            tiles_x_ = (width_ + tile_size_ - 1) / tile_size_;
+            tiles_y_ = (height_ + tile_size_ - 1) / tile_size_;
+            current_.assign(static_cast<size_t>(tiles_x_) * tiles_y_, 0);
+            previous_.assign(current_.size(), 0);
+            valid_ = false;
+        }
+
+        // Anything that changes the whole image (position, kernel, mark_dirty) goes into seed.
+        void begin(uint64_t seed) { std::fill(current_.begin(), current_.end(), seed); }
+
+        // Bounds are in region pixels, max exclusive.
+        void add_triangle(float min_x, float min_y, float max_x, float max_y, uint64_t hash) {
+            int tx0 = std::max(static_cast<int>(std::floor(min_x)), 0) / tile_size_;
+            int ty0 = std::max(static_cast<int>(std::floor(min_y)), 0) / tile_size_;
+            int tx1 = std::min(static_cast<int>(std::ceil(max_x)), width_);
+            int ty1 = std::min(static_cast<int>(std::ceil(max_y)), height_);
+            if (tx1 <= 0 || ty1 <= 0 || min_x >= width_ || min_y >= height_) return;
+            tx1 = (tx1 - 1) / tile_size_;
+            ty1 = (ty1 - 1) / tile_size_;
+
+            for (int ty = ty0; ty <= ty1; ty++) {
+                uint64_t* row = current_.data() + static_cast<size_t>(ty) * tiles_x_;
+                for (int tx = tx0; tx <= tx1; tx++) row[tx] = detail::hash_round(row[tx], hash);
+            }
+        }
+
+        // The commands of an ImDrawList-like type before cmd_end, for a region whose top-left is at origin in the
+        // list's coordinates. Triangle bounds are clipped to each command's ClipRect; callbacks are skipped.
+        template <typename DrawList>
+        void add_draw_commands(const DrawList& list, int cmd_end, float origin_x, float origin_y) {
+            using vertex_type = std::decay_t<decltype(*list.VtxBuffer.Data)>;
+            cmd_end = std::min(cmd_end, list.CmdBuffer.Size);
+
+            for (int c = 0; c < cmd_end; c++) {
+                const auto& cmd = list.CmdBuffer.Data[c];
+                if (cmd.UserCallback || cmd.ElemCount == 0) continue;
+
+                float clip_x0 = cmd.ClipRect.x - origin_x;
+                float clip_y0 = cmd.ClipRect.y - origin_y;
+                float clip_x1 = cmd.ClipRect.z - origin_x;
+                float clip_y1 = cmd.ClipRect.w - origin_y;
+                if (clip_x1 <= 0.0f || clip_y1 <= 0.0f || clip_x0 >= width_ || clip_y0 >= height_) continue;
+
+                uint64_t texture = hash_value(cmd.TextureId, 0);
+                const auto* indices = list.IdxBuffer.Data + cmd.IdxOffset;
+                const vertex_type* vertices = list.VtxBuffer.Data + cmd.VtxOffset;
+
+                for (unsigned i = 0; i + 2 < cmd.ElemCount; i += 3) {
+                    vertex_type triangle[3] = { vertices[indices[i]], vertices[indices[i + 1]], vertices[indices[i + 2]] };
+                    float min_x = std::min(triangle[0].pos.x, std::min(triangle[1].pos.x, triangle[2].pos.x)) - origin_x;
+                    float min_y = std::min(triangle[0].pos.y, std::min(triangle[1].pos.y, triangle[2].pos.y)) - origin_y;
+                    float max_x = std::max(triangle[0].pos.x, std::max(triangle[1].pos.x, triangle[2].pos.x)) - origin_x;
+                    float max_y = std::max(triangle[0].pos.y, std::max(triangle[1].pos.y, triangle[2].pos.y)) - origin_y;
+
+                    min_x = std::max(min_x, clip_x0);
+                    min_y = std::max(min_y, clip_y0);
+                    max_x = std::min(max_x, clip_x1);
+                    max_y = std::min(max_y, clip_y1);
+                    if (min_x >= max_x || min_y >= max_y) continue;
+
+                    add_triangle(min_x, min_y, max_x, max_y, hash64(triangle, sizeof(triangle), texture));
+                }
+            }
+        }
+
+        // Dirty tiles as rects grown by apron and merged down to max_count, in region pixels. Returns the count: 0
+        // when nothing changed, one rect over the whole region on the first call after reset().
+        int finish(int apron, atlas_rect* rects, int max_count) {
+            dirty_tiles_ = 0;
+            int count = 0;
+
+            if (!valid_) {
+                dirty_tiles_ = tiles_x_ * tiles_y_;
+                if (width_ > 0 && height_ > 0 && max_count > 0) rects[count++] = { 0, 0, width_, height_ };
+            }
+            else {
+                // Horizontal runs of dirty tiles, stacked with an identical run in the row above where possible.
+                runs_.clear();
+                size_t row_begin = 0;
+                for (int ty = 0; ty < tiles_y_; ty++) {
+                    size_t row_end = runs_.size();
+                    const uint64_t* current = current_.data() + static_cast<size_t>(ty) * tiles_x_;
+                    const uint64_t* previous = previous_.data() + static_cast<size_t>(ty) * tiles_x_;
+                    for (int tx = 0; tx < tiles_x_;) {
+                        if (current[tx] == previous[tx]) {
+                            tx++;
+                            continue;
+                        }
+                        int run = tx;
+                        while (tx < tiles_x_ && current[tx] != previous[tx]) tx++;
+                        dirty_tiles_ += tx - run;
+
+                        atlas_rect rect = { run * tile_size_, ty * tile_size_, (tx - run) * tile_size_, tile_size_ };
+                        bool stacked = false;
+                        for (size_t i = row_begin; i < row_end && !stacked; i++) {
+                            atlas_rect& above = runs_[i];
+                            if (above.x == rect.x && above.width == rect.width && above.y + above.height == rect.y) {
+                                above.height += tile_size_;
+                                stacked = true;
+                            }
+                        }
+                        if (!stacked) runs_.push_back(rect);
+                    }
+                    // Only runs that reach this row can be extended by the next one.
+                    size_t kept = row_begin;
+                    for (size_t i = row_begin; i < runs_.size(); i++) {
+                        if (runs_[i].y + runs_[i].height < (ty + 1) * tile_size_) std::swap(runs_[i], runs_[kept++]);
+                    }
+                    row_begin = kept;
+                }
+
+                for (atlas_rect& rect : runs_) rect = expand_rect(rect, apron, width_, height_);
+                count = merge_rects(runs_.data(), static_cast<int>(runs_.size()), max_count);
+                std::copy(runs_.begin(), runs_.begin() + count, rects);
+            }
+
+            current_.swap(previous_);
+            valid_ = true;
+            return count;
+        }
+
+        // Forget the previous hashes, e.g. when the capture they describe was lost.
+        void invalidate() { valid_ = false; }
+
+        int width() const { return width_; }
+        int height() const { return height_; }
+        int tile_size() const { return tile_size_; }
+        int tiles_x() const { return tiles_x_; }
+        int tiles_y() const { return tiles_y_; }
+        int dirty_tiles() const { return dirty_tiles_; }
+    };
+
+}
+
+#endif
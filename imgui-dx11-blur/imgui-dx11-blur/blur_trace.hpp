@@ -0,0 +1,265 @@
+#ifndef BLUR_TRACE_HPP
+#define BLUR_TRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define BLUR_TRACE_TSC 1
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+// Define BLUR_TRACE to compile the renderer's trace scopes in; without it BLUR_TRACE_SCOPE expands to nothing and
+// trace::enabled() is a constant false.
+#define BLUR_TRACE_JOIN_(a, b) a##b
+#define BLUR_TRACE_JOIN(a, b) BLUR_TRACE_JOIN_(a, b)
+#if defined(BLUR_TRACE)
+#define BLUR_TRACE_SCOPE(name) ::blur::trace::scope BLUR_TRACE_JOIN(blur_trace_scope_, __LINE__)(name)
+#else
+#define BLUR_TRACE_SCOPE(name) static_cast<void>(0)
+#endif
+
+namespace blur {
+
+    namespace trace {
+
+        // Names must outlive the trace: string literals, or names of static tables such as shader_sources.
+        struct event {
+            const char* name;
+            uint64_t ticks;
+            char phase;     // 'B' or 'E'
+        };
+
+        struct gpu_event {
+            const char* name;
+            int64_t begin_ns;   // steady_clock
+            int64_t end_ns;
+        };
+
+        constexpr size_t chunk_events = 4096;
+        constexpr size_t default_max_events = size_t(1) << 20;
+
+        namespace detail {
+
+            // The TSC where there is one, converted to steady_clock time when the trace is written.
+            inline uint64_t ticks() {
+#if defined(BLUR_TRACE_TSC)
+                return __rdtsc();
+#else
+                return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+            }
+
+            inline int64_t steady_ns() {
+                return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+            }
+
+            // Chunks are kept when cleared, so steady recording writes to memory that is already mapped.
+            struct thread_buffer {
+                uint32_t thread_id = 0;
+                std::vector<std::unique_ptr<event[]>> chunks;
+                size_t chunk = 0;           // the one being filled
+                event* next = nullptr;
+                event* limit = nullptr;
+
+                size_t used_chunks() const { return chunks.empty() ? 0 : chunk + 1; }
+
+                size_t size(size_t index) const {
+                    return index < chunk ? chunk_events : static_cast<size_t>(next - chunks[index].get());
+                }
+
+                void use_chunk(size_t index) {
+                    chunk = index;
+                    next = chunks[index].get();
+                    limit = next + chunk_events;
+                }
+
+                void clear() {
+                    if (!chunks.empty()) use_chunk(0);
+                }
+            };
+
+            struct recorder {
+                std::atomic<bool> enabled{ false };
+                std::atomic<uint64_t> dropped{ 0 };
+                std::mutex mutex;
+                std::vector<std::unique_ptr<thread_buffer>> buffers;
+                std::vector<gpu_event> gpu_events;
+                size_t max_events = default_max_events;
+                uint64_t start_ticks = 0;
+                int64_t start_ns = 0;
+            };
+
+            inline recorder& state() {
+                static recorder instance;
+                return instance;
+            }
+
+            inline thread_local thread_buffer* current_buffer = nullptr;
+
+            // Slow path: the thread's first event, or a full chunk.
+            inline thread_buffer* reserve() {
+                recorder& recorder = state();
+                thread_buffer* buffer = current_buffer;
+                if (!buffer) {
+                    std::lock_guard<std::mutex> lock(recorder.mutex);
+                    recorder.buffers.push_back(std::make_unique<thread_buffer>());
+                    buffer = recorder.buffers.back().get();
+                    buffer->thread_id = static_cast<uint32_t>(recorder.buffers.size());
+                    current_buffer = buffer;
+                }
+
+                if (buffer->next != buffer->limit) return buffer;
+                if (buffer->used_chunks() < buffer->chunks.size()) {
+                    buffer->use_chunk(buffer->used_chunks());
+                    return buffer;
+                }
+                if (buffer->chunks.size() * chunk_events >= recorder.max_events) {
+                    recorder.dropped.fetch_add(1, std::memory_order_relaxed);
+                    return nullptr;
+                }
+                buffer->chunks.push_back(std::make_unique<event[]>(chunk_events));
+                buffer->use_chunk(buffer->chunks.size() - 1);
+                return buffer;
+            }
+
+            inline void record(const char* name, char phase) {
+                thread_buffer* buffer = current_buffer;
+                if (!buffer || buffer->next == buffer->limit) {
+                    buffer = reserve();
+                    if (!buffer) return;
+                }
+                *buffer->next++ = { name, ticks(), phase };
+            }
+
+            inline void write_escaped(std::string& out, const char* text) {
+                for (; *text; text++) {
+                    if (*text == '"' || *text == '\\') out += '\\';
+                    if (static_cast<unsigned char>(*text) >= 0x20) out += *text;
+                }
+            }
+
+        }
+
+#if defined(BLUR_TRACE)
+        inline bool enabled() { return detail::state().enabled.load(std::memory_order_relaxed); }
+#else
+        constexpr bool enabled() { return false; }
+#endif
+
+        // Starts recording, up to max_events per thread until the next write; later events are dropped and counted
+        // from here on.
+        inline void start(size_t max_events = default_max_events) {
+            detail::recorder& recorder = detail::state();
+            std::lock_guard<std::mutex> lock(recorder.mutex);
+            recorder.max_events = max_events;
+            recorder.dropped.store(0, std::memory_order_relaxed);
+            recorder.start_ticks = detail::ticks();
+            recorder.start_ns = detail::steady_ns();
+            recorder.enabled.store(true, std::memory_order_relaxed);
+        }
+
+        inline void stop() { detail::state().enabled.store(false, std::memory_order_relaxed); }
+
+        // Events dropped since start().
+        inline uint64_t dropped_events() { return detail::state().dropped.load(std::memory_order_relaxed); }
+
+        // A scope that began while enabled always ends, so stopping inside it keeps the trace balanced.
+        class scope {
+        private:
+            const char* name_;
+
+        public:
+            explicit scope(const char* name) : name_(enabled() ? name : nullptr) {
+                if (name_) detail::record(name_, 'B');
+            }
+
+            ~scope() {
+                if (name_) detail::record(name_, 'E');
+            }
+
+            scope(const scope&) = delete;
+            scope& operator=(const scope&) = delete;
+        };
+
+        // A GPU range on its own track, in steady_clock time.
+        inline void record_gpu(const char* name, int64_t begin_ns, int64_t end_ns) {
+            if (!enabled()) return;
+
+            detail::recorder& recorder = detail::state();
+            std::lock_guard<std::mutex> lock(recorder.mutex);
+            recorder.gpu_events.push_back({ name, begin_ns, end_ns });
+        }
+
+        // Writes and clears everything since start() or the last write as Chrome trace JSON. Thread buffers are read
+        // without locking: call it where no other thread records, e.g. between frames.
+        inline bool write_chrome_trace(const std::string& path) {
+            detail::recorder& recorder = detail::state();
+            std::lock_guard<std::mutex> lock(recorder.mutex);
+
+            // Ticks to microseconds since start(), from the TSC rate over the whole recording.
+            uint64_t end_ticks = detail::ticks();
+            int64_t end_ns = detail::steady_ns();
+            double us_per_tick = end_ticks > recorder.start_ticks && end_ns > recorder.start_ns ?
+                (end_ns - recorder.start_ns) / 1000.0 / static_cast<double>(end_ticks - recorder.start_ticks) : 0.001;
+
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            if (!file) return false;
+
+            std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+            out += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"GPU\"}}";
+            char line[160];
+
+            for (const std::unique_ptr<detail::thread_buffer>& buffer : recorder.buffers) {
+                snprintf(line, sizeof(line), ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"thread %u\"}}",
+                    buffer->thread_id, buffer->thread_id);
+                out += line;
+
+                for (size_t chunk = 0; chunk < buffer->used_chunks(); chunk++) {
+                    const event* events = buffer->chunks[chunk].get();
+                    for (size_t i = 0, count = buffer->size(chunk); i < count; i++) {
+                        const event& e = events[i];
+                        double ts = static_cast<double>(static_cast<int64_t>(e.ticks - recorder.start_ticks)) * us_per_tick;
+                        out += ",\n{\"name\":\"";
+                        detail::write_escaped(out, e.name);
+                        snprintf(line, sizeof(line), "\",\"cat\":\"blur\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%u}",
+                            e.phase, ts, buffer->thread_id);
+                        out += line;
+                    }
+                    file.write(out.data(), static_cast<std::streamsize>(out.size()));
+                    out.clear();
+                }
+                buffer->clear();
+            }
+
+            for (const gpu_event& e : recorder.gpu_events) {
+                out += ",\n{\"name\":\"";
+                detail::write_escaped(out, e.name);
+                snprintf(line, sizeof(line), "\",\"cat\":\"gpu\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":0}",
+                    (e.begin_ns - recorder.start_ns) / 1000.0, (e.end_ns - e.begin_ns) / 1000.0);
+                out += line;
+            }
+            recorder.gpu_events.clear();
+
+            out += "\n]}\n";
+            file.write(out.data(), static_cast<std::streamsize>(out.size()));
+            return static_cast<bool>(file);
+        }
+
+    }
+
+}
+
+#endif
@@ -12,7 +12,7 @@
 #include <d3d11.h>
 #include <tchar.h>
 
-#include "blur.hpp"
+#include "blur_panel.hpp"
 
 #pragma comment (lib, "d3d11")
 
@@ -77,6 +77,11 @@ int main(int, char**)
     ImGui_ImplWin32_Init(hwnd);
     ImGui_ImplDX11_Init(g_pd3dDevice, g_pd3dDeviceContext);
 
+    // Keep compiled blur shaders across launches
+    blur::shader_cache shader_cache(blur::default_shader_cache_path());
+    shader_cache.load();
+    blur::g_blur_renderer.set_shader_cache(&shader_cache);
+
     // Load Fonts
     // - If no fonts are loaded, dear imgui will use the default font. You can also load multiple fonts and use ImGui::PushFont()/PopFont() to select them.
     // - AddFontFromFileTTF() will return the ImFont* so you can store it if you need to select the font among multiple.
@@ -144,16 +149,43 @@ int main(int, char**)
             static float f = 0.0f;
             static int counter = 0;
             static bool should_blur = false;
+            static bool live_blur = false;
+            static bool shared_backdrop = false;
+            static bool pyramid = false;
+            static bool dirty_tiles = true;
+            static bool show_profiler = false;
+            static float blur_strength = 0.6f;
 
-            ImGui::Begin("Hello, world!", nullptr, ImGuiWindowFlags_NoTitleBar);          
+            // NoBackground: the blur is drawn first in the window's draw list and takes the background's place,
+            // so the capture only sees what lies beneath the window.
+            ImGui::Begin("Hello, world!", nullptr, ImGuiWindowFlags_NoTitleBar | (should_blur ? ImGuiWindowFlags_NoBackground : 0));
 
             window_pos = ImGui::GetWindowPos();
             window_size = ImGui::GetWindowSize();
 
+            blur::blur_params blur_params;
+            blur_params.device = g_pd3dDevice;
+            blur_params.draw_list = ImGui::GetWindowDrawList();
+            blur_params.window_pos = window_pos;
+            blur_params.window_size = window_size;
+            blur_params.blur_strength = blur_strength;
+            blur_params.corner_radius = 6.0f;
+            blur_params.delay_time = 0.1;
+            blur_params.live = live_blur;
+            blur_params.detect_changes = true;
+            // Reblur only the changed tiles, or test the whole capture on the GPU; the two do not combine.
+            blur_params.dirty_tile_size = dirty_tiles ? blur::default_tile_size : 0;
+            blur_params.change_threshold = dirty_tiles ? 0.0f : 2.0f / 255.0f;
+            blur_params.shared_backdrop = shared_backdrop;
+            if (pyramid) blur_params.mode = blur::blur_mode::pyramid;
+
+            blur::render_blur_overlay(blur_params, should_blur);
+
             ImGui::Text("This is some useful text.");               
 
             ImGui::SliderFloat("float", &f, 0.0f, 1.0f);            
-            ImGui::ColorEdit3("clear color", (float*)&clear_color); 
+            if (ImGui::ColorEdit3("clear color", (float*)&clear_color))
+                blur::g_blur_renderer.mark_dirty();
 
             if (ImGui::Button("Button"))                            
                 counter++;
@@ -161,21 +193,35 @@ int main(int, char**)
             ImGui::Text("counter = %d", counter);
 
             ImGui::Checkbox("Blur", &should_blur);
+            ImGui::SameLine();
+            ImGui::Checkbox("Live", &live_blur);
+            ImGui::SameLine();
+            ImGui::Checkbox("Shared", &shared_backdrop);
+            ImGui::SameLine();
+            ImGui::Checkbox("Pyramid", &pyramid);
+            ImGui::SameLine();
+            ImGui::Checkbox("Tiles", &dirty_tiles);
+            ImGui::SameLine();
+            ImGui::Checkbox("Profiler", &show_profiler);
+            ImGui::SliderFloat("Strength", &blur_strength, 0.0f, 8.0f);
+
+            const blur::frame_counters& counters = blur::g_blur_renderer.last_frame_counters();
+            ImGui::Text("Blur: %d captures, %d passes per frame", counters.captures, counters.passes);
+            const blur::change_stats& changes = blur::g_blur_renderer.change_detection_stats();
+            ImGui::Text("Unchanged backdrop: %llu of %llu refreshes skipped, %llu partial",
+                (unsigned long long)changes.skipped, (unsigned long long)changes.checks, (unsigned long long)changes.partial);
+            const blur::change_test_stats& tests = blur::g_blur_renderer.gpu_change_stats();
+            ImGui::Text("Unchanged capture: %llu of %llu blurs skipped on the GPU",
+                (unsigned long long)tests.unchanged, (unsigned long long)tests.tests);
+            blur::stats::summary gpu = blur::g_blur_renderer.gpu_stats().total();
+            ImGui::Text("Blur GPU: %.3f ms avg, %.3f ms p99, %.3f ms min", gpu.avg_ms, gpu.p99_ms, gpu.min_ms);
 
             ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / io.Framerate, io.Framerate);
 
-            blur::blur_params blur_params;
-            blur_params.device = g_pd3dDevice;
-            blur_params.draw_list = ImGui::GetWindowDrawList(); // or GetForegroundDrawList
-            blur_params.window_pos = window_pos;
-            blur_params.window_size = window_size;
-            blur_params.blur_strength = 0.6f;
-            blur_params.corner_radius = 6.0f;
-            blur_params.delay_time = 0.1;
-
-            blur::render_blur_overlay(blur_params, should_blur);
-
             ImGui::End();
+
+            if (show_profiler)
+                blur::show_profiler_window(blur::g_blur_renderer, &show_profiler);
         }
 
         // Renderingd
@@ -196,6 +242,7 @@ int main(int, char**)
     ImGui_ImplWin32_Shutdown();
     ImGui::DestroyContext();
 
+    blur::g_blur_renderer.release_device(g_pd3dDevice);
     CleanupDeviceD3D();
     ::DestroyWindow(hwnd);
     ::UnregisterClassW(wc.lpszClassName, wc.hInstance);
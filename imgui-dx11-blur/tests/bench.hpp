@@ -0,0 +1,33 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <chrono>
+#include <cstdio>
+
+// Timing for the bench_* executables, which print a table and are not run by ctest.
+namespace bench {
+
+    using clock = std::chrono::steady_clock;
+
+    inline double elapsed_ms(clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    }
+
+    // Makes the compiler assume value is read and written here, so work on it is not folded away across iterations.
+    template <typename T>
+    void keep(T& value) {
+        asm volatile("" : : "r"(&value) : "memory");
+    }
+
+    // Milliseconds per call of fn, over iterations calls after a tenth as many to warm up.
+    template <typename Fn>
+    double run(int iterations, Fn&& fn) {
+        for (int i = 0; i < iterations / 10; i++) fn();
+        clock::time_point start = clock::now();
+        for (int i = 0; i < iterations; i++) fn();
+        return elapsed_ms(start) / iterations;
+    }
+
+}
+
+#endif
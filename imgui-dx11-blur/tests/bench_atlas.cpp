@@ -0,0 +1,44 @@
+#include "bench.hpp"
+
+#include "blur_atlas.hpp"
+
+#include <random>
+
+// Full repacks and incremental inserts of the atlas layout, for 10 to 200 regions of window-like sizes.
+int main() {
+    std::mt19937 rng(7);
+    blur::atlas_rect sizes[200], rects[200];
+    for (blur::atlas_rect& size : sizes) size = { 0, 0, 50 + static_cast<int>(rng() % 400), 40 + static_cast<int>(rng() % 300) };
+
+    std::printf("%8s %14s %14s %12s\n", "regions", "pack (us)", "insert (ns)", "occupancy");
+    for (int count : { 10, 50, 100, 200 }) {
+        blur::atlas_layout layout;
+        int width = 0, height = 0;
+        layout.pack(sizes, rects, count, 8, width, height);
+
+        double pack_us = bench::run(2000, [&] {
+            int w = width, h = height;
+            layout.pack(sizes, rects, count, 8, w, h);
+        }) * 1e3;
+
+        long area = 0;
+        for (int i = 0; i < count; i++) area += static_cast<long>(sizes[i].width) * sizes[i].height;
+        double occupancy = 100.0 * area / (static_cast<double>(width) * layout.used_height());
+
+        // 64x48 inserts into the free space a pack leaves in an atlas twice its height, until it is full.
+        long inserts = 0;
+        double insert_ms = 0.0;
+        for (int rep = 0; rep < 200; rep++) {
+            int w = width, h = height * 2;
+            layout.pack(sizes, rects, count, 8, w, h);
+            blur::atlas_rect rect;
+            bench::clock::time_point start = bench::clock::now();
+            while (layout.insert(64, 48, rect)) inserts++;
+            insert_ms += bench::elapsed_ms(start);
+        }
+        double insert_ns = inserts ? insert_ms * 1e6 / inserts : 0.0;
+
+        std::printf("%8d %14.2f %14.1f %11.1f%%\n", count, pack_us, insert_ns, occupancy);
+    }
+    return 0;
+}
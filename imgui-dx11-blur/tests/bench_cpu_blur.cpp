@@ -0,0 +1,224 @@
+#include "bench.hpp"
+
+#include "blur_cpu.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    struct bench_image {
+        int width;
+        int height;
+        std::vector<uint8_t> pixels;
+
+        bench_image(int width, int height) : width(width), height(height), pixels(static_cast<size_t>(width) * height * 4) {}
+
+        blur::cpu::image_view view() { return { pixels.data(), width, height, width * 4 }; }
+        blur::cpu::const_image_view const_view() const { return { pixels.data(), width, height, width * 4 }; }
+    };
+
+    bench_image random_image(int width, int height) {
+        bench_image image(width, height);
+        std::mt19937 rng(1);
+        for (uint8_t& value : image.pixels) value = static_cast<uint8_t>(rng());
+        return image;
+    }
+
+    // Separable Gaussian of sigma in double, cut off at 4 sigma, with the same clamp addressing.
+    bench_image exact_gaussian(const bench_image& source, float sigma) {
+        int reach = static_cast<int>(std::ceil(4.0f * sigma));
+        std::vector<double> weights(2 * reach + 1);
+        double total = 0.0;
+        for (int i = -reach; i <= reach; i++) total += weights[i + reach] = std::exp(-0.5 * i * i / (sigma * sigma));
+        for (double& weight : weights) weight /= total;
+
+        int width = source.width, height = source.height;
+        std::vector<double> rows(source.pixels.size());
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                for (int c = 0; c < 4; c++) {
+                    double sum = 0.0;
+                    for (int i = -reach; i <= reach; i++) {
+                        int sx = std::min(std::max(x + i, 0), width - 1);
+                        sum += source.pixels[(static_cast<size_t>(y) * width + sx) * 4 + c] * weights[i + reach];
+                    }
+                    rows[(static_cast<size_t>(y) * width + x) * 4 + c] = sum;
+                }
+            }
+        }
+
+        bench_image result(width, height);
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                for (int c = 0; c < 4; c++) {
+                    double sum = 0.0;
+                    for (int i = -reach; i <= reach; i++) {
+                        int sy = std::min(std::max(y + i, 0), height - 1);
+                        sum += rows[(static_cast<size_t>(sy) * width + x) * 4 + c] * weights[i + reach];
+                    }
+                    result.pixels[(static_cast<size_t>(y) * width + x) * 4 + c] = static_cast<uint8_t>(sum + 0.5);
+                }
+            }
+        }
+        return result;
+    }
+
+    // Cost and quality per kernel radius: time on a 1920x1080 frame with one worker, and PSNR on a 480x270 crop against
+    // the untruncated Gaussian of the same sigma, for discrete and linear sampling.
+    void radius_sweep() {
+        bench_image frame = random_image(1920, 1080), result(1920, 1080);
+        bench_image crop = random_image(480, 270), crop_result(480, 270);
+        blur::cpu::cpu_blur_renderer renderer(1);
+
+        std::printf("\n1920x1080, 1 worker\n%8s %7s %15s %15s %13s %13s\n", "radius", "sigma", "discrete (ms)", "linear (ms)",
+            "discrete dB", "linear dB");
+        for (int radius : { 4, 8, 16, 32, 64 }) {
+            blur::kernel_desc discrete;
+            discrete.radius = radius;
+            blur::kernel_desc linear = discrete;
+            linear.sampling = blur::kernel_sampling::linear;
+            float sigma = blur::kernel_sigma(discrete);
+            bench_image exact = exact_gaussian(crop, sigma);
+
+            double ms[2], db[2];
+            const blur::kernel_desc* descs[2] = { &discrete, &linear };
+            for (int i = 0; i < 2; i++) {
+                ms[i] = bench::run(5, [&] { renderer.process(frame.const_view(), result.view(), 1.0f, *descs[i]); });
+                renderer.process(crop.const_view(), crop_result.view(), 1.0f, *descs[i]);
+                db[i] = blur::cpu::psnr(exact.const_view(), crop_result.const_view());
+            }
+            std::printf("%8d %7.2f %15.2f %15.2f %13.1f %13.1f\n", radius, sigma, ms[0], ms[1], db[0], db[1]);
+        }
+    }
+
+    // One worker on a 1920x1080 frame with each row kernel variant the host supports, against scalar.
+    void instruction_sets() {
+        const blur::cpu::kernel_isa variants[] = { blur::cpu::kernel_isa::scalar, blur::cpu::kernel_isa::sse2,
+            blur::cpu::kernel_isa::avx2, blur::cpu::kernel_isa::neon };
+        bench_image source = random_image(1920, 1080), result(1920, 1080);
+        blur::cpu::cpu_blur_renderer renderer(1);
+
+        std::printf("1920x1080, 1 worker\n%8s %14s %9s %14s %9s\n", "isa", "radius 4 (ms)", "speedup", "radius 16 (ms)", "speedup");
+        double scalar[2] = {};
+        for (blur::cpu::kernel_isa isa : variants) {
+            if (!blur::cpu::force_kernel_isa(isa)) continue;
+            double ms[2];
+            for (int i = 0; i < 2; i++) {
+                blur::kernel_desc kernel;
+                kernel.radius = i == 0 ? 4 : 16;
+                ms[i] = bench::run(10, [&] { renderer.process(source.const_view(), result.view(), 1.0f, kernel); });
+                if (isa == blur::cpu::kernel_isa::scalar) scalar[i] = ms[i];
+            }
+            std::printf("%8s %14.2f %8.2fx %14.2f %8.2fx\n", blur::cpu::kernel_isa_name(isa), ms[0], scalar[0] / ms[0], ms[1],
+                scalar[1] / ms[1]);
+        }
+        blur::cpu::reset_kernel_isa();
+    }
+
+    // Time per Dual Kawase level on a 1920x1080 frame, averaged over runs, for the iterations a radius of 16 needs.
+    void dual_kawase_levels() {
+        bench_image source = random_image(1920, 1080), result(1920, 1080);
+        blur::cpu::cpu_blur_renderer renderer(1);
+        int iterations = blur::kawase_iterations(16.0f);
+
+        const int runs = 10;
+        std::vector<blur::cpu::kawase_level_timing> total;
+        double ms = bench::run(runs, [&] {
+            renderer.process_dual_kawase(source.const_view(), result.view(), iterations);
+            const std::vector<blur::cpu::kawase_level_timing>& timings = renderer.kawase_timings();
+            total.resize(timings.size());
+            for (size_t i = 0; i < timings.size(); i++) {
+                total[i].width = timings[i].width;
+                total[i].height = timings[i].height;
+                total[i].down_seconds += timings[i].down_seconds;
+                total[i].up_seconds += timings[i].up_seconds;
+            }
+        });
+
+        // bench::run also makes a tenth as many warm-up calls, which land in the totals.
+        double calls = runs + runs / 10;
+        std::printf("\n1920x1080 dual kawase, %d iterations, 1 worker: %.2f ms\n%8s %12s %10s %10s\n", iterations, ms, "level",
+            "size", "down (ms)", "up (ms)");
+        for (size_t i = 0; i < total.size(); i++) {
+            std::printf("%8zu %5dx%-6d %10.3f %10.3f\n", i + 1, total[i].width, total[i].height,
+                1000.0 * total[i].down_seconds / calls, 1000.0 * total[i].up_seconds / calls);
+        }
+    }
+
+    // The pyramid is built once per frame and resolved per window; the separable path blurs per window. Both on a
+    // 1920x1080 frame with one worker, at the sigmas a window might ask for.
+    void pyramid_against_separable() {
+        bench_image source = random_image(1920, 1080), result(1920, 1080);
+        blur::cpu::cpu_blur_renderer renderer(1);
+        double build = bench::run(10, [&] { renderer.build_pyramid(source.const_view()); });
+
+        std::printf("\n1920x1080 pyramid, 1 worker: build %.2f ms\n%8s %14s %16s\n", build, "sigma", "resolve (ms)",
+            "separable (ms)");
+        for (float sigma : { 1.0f, 2.0f, 4.0f, 8.0f, 16.0f }) {
+            blur::kernel_desc kernel;
+            kernel.sigma = sigma;
+            kernel.radius = static_cast<int>(std::ceil(3.0f * sigma));
+            double resolve = bench::run(10, [&] { renderer.resolve_pyramid(result.view(), sigma); });
+            double separable = bench::run(5, [&] { renderer.process(source.const_view(), result.view(), 1.0f, kernel); });
+            std::printf("%8.0f %14.2f %16.2f\n", sigma, resolve, separable);
+        }
+    }
+
+    // Tiled Gaussian time against worker count at radius 16, for 128 and 256 pixel tiles. Speedup is against one
+    // worker with the same tiles; utilization is the workers' average busy share of the wall time with 256 pixel tiles.
+    void thread_scaling(int max_threads) {
+        std::vector<int> thread_counts;
+        for (int count = 1; count < max_threads; count *= 2) thread_counts.push_back(count);
+        thread_counts.push_back(max_threads);
+
+        blur::kernel_desc kernel;
+        kernel.radius = 16;
+        const int tile_sizes[] = { 128, 256 };
+
+        const struct { int width, height; } sizes[] = { { 3840, 2160 }, { 7680, 4320 } };
+        for (const auto& size : sizes) {
+            bench_image source = random_image(size.width, size.height), result(size.width, size.height);
+
+            std::printf("\n%dx%d\n%8s %14s %9s %14s %9s %12s\n", size.width, size.height, "workers", "tile 128 (ms)", "speedup",
+                "tile 256 (ms)", "speedup", "utilization");
+            double single[2] = {};
+            for (int threads : thread_counts) {
+                double ms[2];
+                double busy = 0.0;
+                for (int t = 0; t < 2; t++) {
+                    blur::cpu::cpu_blur_renderer renderer(threads, tile_sizes[t]);
+                    renderer.process(source.const_view(), result.view(), 1.0f, kernel);
+                    renderer.reset_thread_stats();
+                    ms[t] = bench::run(5, [&] { renderer.process(source.const_view(), result.view(), 1.0f, kernel); });
+                    if (threads == 1) single[t] = ms[t];
+
+                    std::vector<double> utilization = renderer.thread_utilization();
+                    busy = 0.0;
+                    for (double value : utilization) busy += value / utilization.size();
+                }
+                std::printf("%8d %14.1f %8.2fx %14.1f %8.2fx %11.0f%%\n", threads, ms[0], single[0] / ms[0], ms[1],
+                    single[1] / ms[1], 100.0 * busy);
+            }
+        }
+    }
+
+}
+
+// Pass a maximum worker count for the thread scaling tables as the first argument, by default twice the hardware
+// threads.
+int main(int argc, char** argv) {
+    int hardware = static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u));
+    int max_threads = argc > 1 ? std::max(std::atoi(argv[1]), 1) : 2 * hardware;
+    std::printf("%d hardware threads, detected %s\n\n", hardware, blur::cpu::kernel_isa_name(blur::cpu::detect_kernel_isa()));
+
+    instruction_sets();
+    radius_sweep();
+    dual_kawase_levels();
+    pyramid_against_separable();
+    thread_scaling(max_threads);
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include "bench.hpp"
+#include "scene.hpp"
+
+#include "blur_hash.hpp"
+
+#include <random>
+
+namespace {
+
+    // n quads in commands of 256, each command's indices relative to its VtxOffset like ImGui's with large meshes.
+    void fill_list(ImDrawList& list, int quads, std::mt19937& rng) {
+        list.CmdBuffer.clear();
+        list.VtxBuffer.clear();
+        list.IdxBuffer.clear();
+        for (int q = 0; q < quads; q++) {
+            if (q % 256 == 0) {
+                ImDrawCmd cmd = {};
+                cmd.ClipRect = ImVec4(0.0f, 0.0f, 1920.0f, 1080.0f);
+                cmd.VtxOffset = static_cast<unsigned>(list.VtxBuffer.Size);
+                cmd.IdxOffset = static_cast<unsigned>(list.IdxBuffer.Size);
+                list.CmdBuffer.push_back(cmd);
+            }
+            float x = static_cast<float>(rng() % 1900), y = static_cast<float>(rng() % 1060);
+            ImU32 col = static_cast<ImU32>(rng());
+            unsigned base = static_cast<unsigned>(list.VtxBuffer.Size) - list.CmdBuffer.back().VtxOffset;
+            list.VtxBuffer.push_back({ ImVec2(x, y), ImVec2(0.0f, 0.0f), col });
+            list.VtxBuffer.push_back({ ImVec2(x + 20.0f, y), ImVec2(1.0f, 0.0f), col });
+            list.VtxBuffer.push_back({ ImVec2(x + 20.0f, y + 20.0f), ImVec2(1.0f, 1.0f), col });
+            list.VtxBuffer.push_back({ ImVec2(x, y + 20.0f), ImVec2(0.0f, 1.0f), col });
+            for (unsigned i : { 0u, 1u, 2u, 0u, 2u, 3u }) list.IdxBuffer.push_back(static_cast<ImDrawIdx>(base + i));
+            list.CmdBuffer.back().ElemCount += 6;
+        }
+    }
+
+    // Live mode with detect_changes over a static or an animated background; the skip rate is the share of refresh
+    // checks change_stats counts as unchanged.
+    void skip_rate(const char* name, bool animate) {
+        fake::scene scene(8, [](blur::blur_params& params, int) {
+            params.live = true;
+            params.detect_changes = true;
+        }, animate);
+        scene.run(10);
+        scene.renderer.reset_change_detection_stats();
+        scene.run(300);
+
+        const blur::change_stats& stats = scene.renderer.change_detection_stats();
+        std::printf("%10s %8llu %8llu %9.1f%% %12.2f\n", name, static_cast<unsigned long long>(stats.checks),
+            static_cast<unsigned long long>(stats.skipped), stats.checks ? 100.0 * stats.skipped / stats.checks : 0.0,
+            stats.checks ? 1e6 * stats.hash_seconds / stats.checks : 0.0);
+    }
+
+}
+
+// hash_draw_commands over one draw list of 1k to 1M quads, whole and up to its middle command (the prefix a capture
+// callback halfway through a window's list hashes). Then the skip rate of 8 live windows over 300 frames.
+int main() {
+    std::mt19937 rng(4);
+    ImDrawList list;
+
+    std::printf("%10s %12s %12s %10s %12s %10s\n", "quads", "bytes", "full (us)", "GB/s", "prefix (us)", "GB/s");
+    for (int quads : { 1000, 10000, 100000, 1000000 }) {
+        fill_list(list, quads, rng);
+        int iterations = std::max(10, 2000000 / quads);
+
+        uint64_t full_bytes = 0, prefix_bytes = 0, hash = 0;
+        blur::hash_draw_commands(list, list.CmdBuffer.Size, 0, &full_bytes);
+        blur::hash_draw_commands(list, list.CmdBuffer.Size / 2, 0, &prefix_bytes);
+        double full = bench::run(iterations, [&] { hash += blur::hash_draw_commands(list, list.CmdBuffer.Size, hash); });
+        double prefix = bench::run(iterations, [&] { hash += blur::hash_draw_commands(list, list.CmdBuffer.Size / 2, hash); });
+        bench::keep(hash);
+
+        std::printf("%10d %12llu %12.1f %10.2f %12.1f %10.2f\n", quads, static_cast<unsigned long long>(full_bytes), 1000.0 * full,
+            full_bytes / (full * 1e6), 1000.0 * prefix, prefix_bytes / (prefix * 1e6));
+    }
+
+    std::printf("\n%10s %8s %8s %10s %12s\n", "backdrop", "checks", "skipped", "skip rate", "hash (us)");
+    skip_rate("static", false);
+    skip_rate("animated", true);
+    return 0;
+}
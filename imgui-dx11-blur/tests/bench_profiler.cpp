@@ -0,0 +1,36 @@
+#include "bench.hpp"
+
+#include "blur_profiler.hpp"
+
+// What recording costs the render thread, and what reading the history costs the panel.
+int main() {
+    blur::stats::frame_profiler profiler;
+    std::printf("%-32s %10s\n", "operation", "ns");
+
+    double count_ns = bench::run(10000000, [&] {
+        profiler.count(blur::stats::counter::d3d_calls);
+        bench::keep(profiler);
+    }) * 1e6;
+    std::printf("%-32s %10.2f\n", "count", count_ns);
+
+    double timer_ns = bench::run(1000000, [&] { blur::stats::scoped_timer timer(profiler, blur::stats::cpu_timer::map); }) * 1e6;
+    std::printf("%-32s %10.2f\n", "scoped_timer", timer_ns);
+
+    uint64_t frame = 0;
+    double end_ns = bench::run(1000000, [&] { profiler.end_frame(++frame); }) * 1e6;
+    std::printf("%-32s %10.2f\n", "end_frame (push)", end_ns);
+
+    static blur::stats::cpu_frame frames[blur::stats::profiler_frames];
+    for (size_t count : { size_t(1), size_t(60), blur::stats::profiler_frames }) {
+        double read_ns = bench::run(20000, [&] { profiler.recent(frames, count); }) * 1e6;
+        char name[48];
+        std::snprintf(name, sizeof(name), "read_recent %zu", count);
+        std::printf("%-32s %10.2f\n", name, read_ns);
+    }
+
+    double summarize_ns = bench::run(20000, [&] {
+        blur::stats::summarize(frames, blur::stats::profiler_frames, blur::stats::cpu_timer::render);
+    }) * 1e6;
+    std::printf("%-32s %10.2f\n", "summarize 256", summarize_ns);
+    return 0;
+}
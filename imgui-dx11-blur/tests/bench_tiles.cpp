@@ -0,0 +1,76 @@
+#include "bench.hpp"
+
+#include "blur_tiles.hpp"
+
+#include <random>
+
+// Hashing a frame's triangles into tiles and finishing into dirty rects, for regions up to full HD with 1%, 10% and all
+// of their quads changing; the dirty column is the share of tiles that makes. Then merge_rects alone on 16 to 256 runs.
+int main() {
+    std::mt19937 rng(3);
+
+    std::printf("%12s %10s %10s %14s %14s %8s\n", "region", "triangles", "dirty", "hash (us)", "finish (us)", "rects");
+    const struct { int width, height; } regions[] = { { 400, 300 }, { 1280, 720 }, { 1920, 1080 } };
+    for (const auto& region : regions) {
+        blur::tile_tracker tracker;
+        tracker.reset(region.width, region.height, blur::default_tile_size);
+
+        // Widget-sized quads of two triangles each, roughly 400 per megapixel.
+        int quads = static_cast<int>(400.0 * region.width * region.height / 1e6) + 50;
+        std::vector<float> bounds(static_cast<size_t>(quads) * 4);
+        for (int i = 0; i < quads; i++) {
+            float x = static_cast<float>(rng() % region.width), y = static_cast<float>(rng() % region.height);
+            bounds[i * 4 + 0] = x;
+            bounds[i * 4 + 1] = y;
+            bounds[i * 4 + 2] = x + 10.0f + rng() % 200;
+            bounds[i * 4 + 3] = y + 10.0f + rng() % 30;
+        }
+        std::vector<uint64_t> hashes(quads, 1);
+
+        auto add = [&] {
+            tracker.begin(0);
+            for (int i = 0; i < quads; i++) {
+                const float* b = &bounds[i * 4];
+                for (int t = 0; t < 2; t++) tracker.add_triangle(b[0], b[1], b[2], b[3], hashes[i] + t);
+            }
+        };
+        double hash_us = bench::run(500, add) * 1e3;
+
+        for (int percent : { 1, 10, 100 }) {
+            blur::atlas_rect rects[blur::max_dirty_rects];
+            int count = 0, dirty = 0;
+            double finish_ms = 0.0;
+            const int rounds = 500;
+            for (int round = 0; round < rounds; round++) {
+                add();
+                tracker.finish(16, rects, blur::max_dirty_rects);
+                for (int i = 0; i < quads; i++) {
+                    if (static_cast<int>(rng() % 100) < percent) hashes[i]++;
+                }
+                add();
+                bench::clock::time_point start = bench::clock::now();
+                count = tracker.finish(16, rects, blur::max_dirty_rects);
+                finish_ms += bench::elapsed_ms(start);
+                dirty = tracker.dirty_tiles();
+            }
+            char name[32];
+            std::snprintf(name, sizeof(name), "%dx%d", region.width, region.height);
+            std::printf("%12s %10d %9d%% %14.2f %14.2f %8d\n", name, quads * 2, 100 * dirty / (tracker.tiles_x() * tracker.tiles_y()),
+                hash_us, finish_ms * 1e3 / rounds, count);
+        }
+    }
+
+    std::printf("\n%8s %14s\n", "runs", "merge (us)");
+    for (int runs : { 16, 64, 256 }) {
+        std::vector<blur::atlas_rect> input(runs), rects(runs);
+        for (blur::atlas_rect& rect : input) {
+            rect = { static_cast<int>(rng() % 1900), static_cast<int>(rng() % 1060), 32 + 32 * static_cast<int>(rng() % 4), 32 };
+        }
+        double merge_us = bench::run(200, [&] {
+            rects = input;
+            blur::merge_rects(rects.data(), runs, blur::max_dirty_rects);
+        }) * 1e3;
+        std::printf("%8d %14.2f\n", runs, merge_us);
+    }
+    return 0;
+}
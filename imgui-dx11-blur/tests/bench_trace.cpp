@@ -0,0 +1,47 @@
+#include "bench.hpp"
+
+#include "blur_trace.hpp"
+
+#include <thread>
+
+// Built with BLUR_TRACE. Nanoseconds per event (half a scope) while recording, and per scope while stopped, the cost
+// every scope in the renderer pays when a trace is compiled in but not running. Without BLUR_TRACE a scope is
+// static_cast<void>(0).
+int main() {
+    const int scopes = 200000;
+    const int batches = 50;
+
+    // Recording into chunks that are already allocated, as steady recording does after the first write.
+    blur::trace::start();
+    double recording_ms = 0.0;
+    for (int batch = 0; batch <= batches; batch++) {
+        bench::clock::time_point start = bench::clock::now();
+        for (int i = 0; i < scopes; i++) {
+            BLUR_TRACE_SCOPE("bench");
+        }
+        if (batch > 0) recording_ms += bench::elapsed_ms(start);
+        blur::trace::write_chrome_trace("/dev/null");
+    }
+    double event_ns = recording_ms * 1e6 / (2.0 * scopes * batches);
+
+    // The first events of a fresh thread, which allocate its chunks.
+    double first_ns = 0.0;
+    std::thread([&] {
+        bench::clock::time_point start = bench::clock::now();
+        for (int i = 0; i < scopes; i++) {
+            BLUR_TRACE_SCOPE("bench");
+        }
+        first_ns = bench::elapsed_ms(start) * 1e6 / (2.0 * scopes);
+    }).join();
+    blur::trace::write_chrome_trace("/dev/null");
+
+    blur::trace::stop();
+    double stopped_ns = bench::run(scopes * 10, [] { BLUR_TRACE_SCOPE("bench"); }) * 1e6;
+
+    std::printf("%-32s %10s\n", "operation", "ns");
+    std::printf("%-32s %10.2f\n", "event, recording", event_ns);
+    std::printf("%-32s %10.2f\n", "event, new thread", first_ns);
+    std::printf("%-32s %10.2f\n", "scope, stopped", stopped_ns);
+    std::printf("dropped: %llu\n", static_cast<unsigned long long>(blur::trace::dropped_events()));
+    return 0;
+}
@@ -0,0 +1,62 @@
+#ifndef CHECK_HPP
+#define CHECK_HPP
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// TEST(name) { ... } registers a test; CHECK and CHECK_EQ report a failure and carry on, REQUIRE returns from the
+// test. check_main.cpp runs every test of the executable, or those whose names contain argv[1].
+namespace check {
+
+    struct test {
+        const char* name;
+        void (*run)();
+    };
+
+    inline std::vector<test>& tests() {
+        static std::vector<test> list;
+        return list;
+    }
+
+    inline int& failures() {
+        static int count = 0;
+        return count;
+    }
+
+    struct registrar {
+        registrar(const char* name, void (*run)()) { tests().push_back({ name, run }); }
+    };
+
+    inline bool report(bool passed, const char* file, int line, const std::string& what) {
+        if (!passed) {
+            failures()++;
+            std::fprintf(stderr, "%s:%d: FAILED %s\n", file, line, what.c_str());
+        }
+        return passed;
+    }
+
+    template <typename A, typename B>
+    bool report_equal(const A& a, const B& b, const char* file, int line, const char* a_text, const char* b_text) {
+        if (a == b) return true;
+        std::ostringstream what;
+        what << a_text << " == " << b_text << " (" << a << " vs " << b << ")";
+        return report(false, file, line, what.str());
+    }
+
+}
+
+#define CHECK_JOIN_(a, b) a##b
+#define CHECK_JOIN(a, b) CHECK_JOIN_(a, b)
+
+#define TEST(name)                                                                                  \
+    static void CHECK_JOIN(test_, name)();                                                          \
+    static ::check::registrar CHECK_JOIN(registrar_, name)(#name, &CHECK_JOIN(test_, name));        \
+    static void CHECK_JOIN(test_, name)()
+
+#define CHECK(cond) ::check::report(static_cast<bool>(cond), __FILE__, __LINE__, #cond)
+#define CHECK_EQ(a, b) ::check::report_equal((a), (b), __FILE__, __LINE__, #a, #b)
+#define REQUIRE(cond) do { if (!CHECK(cond)) return; } while (0)
+
+#endif
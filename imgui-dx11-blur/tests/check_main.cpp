@@ -0,0 +1,17 @@
+#include "check.hpp"
+
+#include <cstring>
+
+int main(int argc, char** argv) {
+    const char* filter = argc > 1 ? argv[1] : "";
+    int run = 0;
+    for (const check::test& test : check::tests()) {
+        if (!std::strstr(test.name, filter)) continue;
+        int before = check::failures();
+        test.run();
+        run++;
+        std::printf("%s %s\n", check::failures() == before ? "ok  " : "FAIL", test.name);
+    }
+    std::printf("%d tests, %d failed checks\n", run, check::failures());
+    return check::failures() == 0 && run > 0 ? 0 : 1;
+}
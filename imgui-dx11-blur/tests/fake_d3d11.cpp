@@ -0,0 +1,220 @@
+#include "fake_d3d11.hpp"
+
+namespace fake {
+
+    recorder& log() {
+        static recorder instance;
+        return instance;
+    }
+
+    long recorder::call(const std::string& name) const {
+        auto it = calls.find(name);
+        return it == calls.end() ? 0 : it->second;
+    }
+
+    long recorder::creates() const {
+        long count = 0;
+        for (const auto& entry : calls) {
+            if (entry.first.compare(0, 6, "Create") == 0) count += entry.second;
+        }
+        return count;
+    }
+
+    long recorder::alive() const {
+        long count = 0;
+        for (const auto& entry : live) count += entry.second;
+        return count;
+    }
+
+    long recorder::alive(const void* device) const {
+        long count = 0;
+        for (const auto& entry : live) {
+            if (entry.first.first == device) count += entry.second;
+        }
+        return count;
+    }
+
+    long recorder::alive(const void* device, const std::string& kind) const {
+        auto it = live.find({ device, kind });
+        return it == live.end() ? 0 : it->second;
+    }
+
+    void recorder::reset_counts() {
+        calls.clear();
+        created.clear();
+    }
+
+    query::query(device* owner, D3D11_QUERY type)
+        : child(owner, type == D3D11_QUERY_OCCLUSION_PREDICATE ? "predicate" : "query"), type(type) {}
+
+    void context::OMGetRenderTargets(UINT count, ID3D11RenderTargetView** rtvs, ID3D11DepthStencilView** dsv) {
+        record("OMGetRenderTargets");
+        for (UINT i = 0; i < count; i++) rtvs[i] = nullptr;
+        if (count && back_buffer) {
+            rtvs[0] = back_buffer;
+            back_buffer->AddRef();
+        }
+        if (dsv) *dsv = nullptr;
+    }
+
+    void context::OMGetBlendState(ID3D11BlendState** state, FLOAT[4], UINT* mask) {
+        record("OMGetBlendState");
+        if (state) *state = nullptr;
+        if (mask) *mask = ~0u;
+    }
+
+    void context::RSGetViewports(UINT* count, D3D11_VIEWPORT* viewports) {
+        record("RSGetViewports");
+        if (viewports && *count) viewports[0] = viewport;
+        *count = 1;
+    }
+
+    HRESULT context::Map(ID3D11Resource* resource, UINT, D3D11_MAP, UINT, D3D11_MAPPED_SUBRESOURCE* mapped) {
+        record("Map");
+        if (log().fail_map) return E_FAIL;
+        buffer* mapped_buffer = static_cast<buffer*>(static_cast<ID3D11Buffer*>(resource));
+        mapped->pData = mapped_buffer->data.data();
+        mapped->RowPitch = 0;
+        mapped->DepthPitch = 0;
+        return S_OK;
+    }
+
+    HRESULT context::GetData(ID3D11Asynchronous*, void* data, UINT size, UINT) {
+        record("GetData");
+        if (size == sizeof(D3D11_QUERY_DATA_TIMESTAMP_DISJOINT)) {
+            *static_cast<D3D11_QUERY_DATA_TIMESTAMP_DISJOINT*>(data) = { 1000000000ull, FALSE };
+        }
+        else if (size == sizeof(UINT64)) {
+            *static_cast<UINT64*>(data) = clock_ += 1000;
+        }
+        else if (size == sizeof(BOOL)) {
+            *static_cast<BOOL*>(data) = TRUE;
+        }
+        return S_OK;
+    }
+
+    device::device(D3D_FEATURE_LEVEL feature_level) : object(this, "device", false), feature_level(feature_level) {
+        context_ = new context(this);
+
+        D3D11_TEXTURE2D_DESC desc = {};
+        desc.Width = 1280;
+        desc.Height = 720;
+        desc.MipLevels = 1;
+        desc.ArraySize = 1;
+        desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        desc.SampleDesc.Count = 1;
+        desc.BindFlags = D3D11_BIND_RENDER_TARGET;
+        back_buffer_ = new texture(this, desc, true);
+        context_->back_buffer = new view<ID3D11RenderTargetView>(this, "rtv", back_buffer_, true);
+    }
+
+    device::~device() {
+        context_->back_buffer->Release();
+        back_buffer_->Release();
+        context_->Release();
+    }
+
+    HRESULT device::CreateBuffer(const D3D11_BUFFER_DESC* desc, const D3D11_SUBRESOURCE_DATA*, ID3D11Buffer** out) {
+        record("CreateBuffer");
+        *out = new buffer(this, desc->ByteWidth);
+        return S_OK;
+    }
+
+    HRESULT device::CreateTexture2D(const D3D11_TEXTURE2D_DESC* desc, const D3D11_SUBRESOURCE_DATA*, ID3D11Texture2D** out) {
+        record("CreateTexture2D");
+        *out = new texture(this, *desc);
+        return S_OK;
+    }
+
+    HRESULT device::CreateShaderResourceView(ID3D11Resource* resource, const D3D11_SHADER_RESOURCE_VIEW_DESC*, ID3D11ShaderResourceView** out) {
+        record("CreateShaderResourceView");
+        *out = new view<ID3D11ShaderResourceView>(this, "srv", resource);
+        return S_OK;
+    }
+
+    HRESULT device::CreateUnorderedAccessView(ID3D11Resource* resource, const D3D11_UNORDERED_ACCESS_VIEW_DESC*, ID3D11UnorderedAccessView** out) {
+        record("CreateUnorderedAccessView");
+        *out = new view<ID3D11UnorderedAccessView>(this, "uav", resource);
+        return S_OK;
+    }
+
+    HRESULT device::CreateRenderTargetView(ID3D11Resource* resource, const D3D11_RENDER_TARGET_VIEW_DESC*, ID3D11RenderTargetView** out) {
+        record("CreateRenderTargetView");
+        *out = new view<ID3D11RenderTargetView>(this, "rtv", resource);
+        return S_OK;
+    }
+
+    HRESULT device::CreateInputLayout(const D3D11_INPUT_ELEMENT_DESC*, UINT, const void*, SIZE_T, ID3D11InputLayout** out) {
+        record("CreateInputLayout");
+        *out = new child<ID3D11InputLayout>(this, "input layout");
+        return S_OK;
+    }
+
+    HRESULT device::CreateVertexShader(const void*, SIZE_T, ID3D11ClassLinkage*, ID3D11VertexShader** out) {
+        record("CreateVertexShader");
+        *out = new child<ID3D11VertexShader>(this, "vertex shader");
+        return S_OK;
+    }
+
+    HRESULT device::CreatePixelShader(const void*, SIZE_T, ID3D11ClassLinkage*, ID3D11PixelShader** out) {
+        record("CreatePixelShader");
+        *out = new child<ID3D11PixelShader>(this, "pixel shader");
+        return S_OK;
+    }
+
+    HRESULT device::CreateComputeShader(const void*, SIZE_T, ID3D11ClassLinkage*, ID3D11ComputeShader** out) {
+        record("CreateComputeShader");
+        *out = new child<ID3D11ComputeShader>(this, "compute shader");
+        return S_OK;
+    }
+
+    HRESULT device::CreateBlendState(const D3D11_BLEND_DESC*, ID3D11BlendState** out) {
+        record("CreateBlendState");
+        *out = new child<ID3D11BlendState>(this, "blend state");
+        return S_OK;
+    }
+
+    HRESULT device::CreateRasterizerState(const D3D11_RASTERIZER_DESC*, ID3D11RasterizerState** out) {
+        record("CreateRasterizerState");
+        *out = new child<ID3D11RasterizerState>(this, "rasterizer state");
+        return S_OK;
+    }
+
+    HRESULT device::CreateSamplerState(const D3D11_SAMPLER_DESC*, ID3D11SamplerState** out) {
+        record("CreateSamplerState");
+        *out = new child<ID3D11SamplerState>(this, "sampler state");
+        return S_OK;
+    }
+
+    HRESULT device::CreateQuery(const D3D11_QUERY_DESC* desc, ID3D11Query** out) {
+        record("CreateQuery");
+        *out = new query(this, desc->Query);
+        return S_OK;
+    }
+
+    HRESULT device::CreatePredicate(const D3D11_QUERY_DESC* desc, ID3D11Predicate** out) {
+        record("CreatePredicate");
+        *out = new query(this, desc->Query);
+        return S_OK;
+    }
+
+    void device::GetImmediateContext(ID3D11DeviceContext** out) {
+        record("GetImmediateContext");
+        *out = context_;
+        context_->AddRef();
+    }
+
+}
+
+HRESULT D3DCompile(LPCVOID, SIZE_T, LPCSTR, const D3D_SHADER_MACRO*, ID3DInclude*, LPCSTR, LPCSTR, UINT, UINT, ID3DBlob** code,
+    ID3DBlob** errors) {
+    fake::log().calls["D3DCompile"]++;
+    *code = new fake::blob(64);
+    if (errors) *errors = nullptr;
+    return S_OK;
+}
+
+HRESULT D3DCreateBlob(SIZE_T size, ID3DBlob** out) {
+    *out = new fake::blob(size);
+    return S_OK;
+}
@@ -0,0 +1,245 @@
+#ifndef FAKE_D3D11_HPP
+#define FAKE_D3D11_HPP
+
+#include <d3d11.h>
+#include <d3dcompiler.h>
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// A D3D11 device and immediate context that record every call and track the refcount of every object they hand
+// out, for running blur_renderer headless. Nothing is drawn; timestamps advance 1 us per query and every change
+// test reports a change.
+namespace fake {
+
+    struct recorder {
+        std::map<std::string, long> calls;      // by method name, plus "D3DCompile"
+        std::map<std::string, long> created;    // by object kind
+        std::map<std::pair<const void*, std::string>, long> live;  // by creating device and kind
+        bool fail_map = false;                  // Map returns E_FAIL, as for a lost device
+
+        long call(const std::string& name) const;
+        long creates() const;                   // every Create* call
+        long alive() const;
+        long alive(const void* device) const;
+        long alive(const void* device, const std::string& kind) const;
+        long draws() const { return call("Draw") + call("DrawInstanced"); }
+        long copies() const { return call("CopySubresourceRegion") + call("CopyResource"); }
+        void reset_counts();
+    };
+
+    recorder& log();
+
+    class device;
+
+    template <typename Base>
+    class object : public Base {
+    private:
+        ULONG refs_ = 1;
+
+    protected:
+        device* owner_;
+        std::string kind_;
+        bool recorded_;
+
+        void record(const char* name) const { log().calls[name]++; }
+
+    public:
+        // Objects that are not recorded are the fakes' own: the device, its context and its back buffer.
+        object(device* owner, const char* kind, bool recorded = true) : owner_(owner), kind_(kind), recorded_(recorded) {
+            if (!recorded_) return;
+            log().created[kind_]++;
+            log().live[{ owner_, kind_ }]++;
+        }
+        virtual ~object() {
+            if (recorded_) log().live[{ owner_, kind_ }]--;
+        }
+
+        object(const object&) = delete;
+        object& operator=(const object&) = delete;
+
+        HRESULT STDMETHODCALLTYPE QueryInterface(REFIID, void**) override { return E_NOINTERFACE; }
+        ULONG STDMETHODCALLTYPE AddRef() override { return ++refs_; }
+        ULONG STDMETHODCALLTYPE Release() override;
+
+        ULONG refs() const { return refs_; }
+        const std::string& kind() const { return kind_; }
+    };
+
+    // Children hold a reference on their device, as D3D11's do, except for the device's own ones.
+    template <typename Base>
+    class child : public object<Base> {
+    public:
+        child(device* owner, const char* kind, bool own = false);
+        ~child() override;
+        void STDMETHODCALLTYPE GetDevice(ID3D11Device** out) override;
+    };
+
+    class buffer : public child<ID3D11Buffer> {
+    public:
+        std::vector<unsigned char> data;
+        buffer(device* owner, UINT size) : child(owner, "buffer"), data(size ? size : 1) {}
+    };
+
+    class texture : public child<ID3D11Texture2D> {
+    public:
+        D3D11_TEXTURE2D_DESC desc;
+        texture(device* owner, const D3D11_TEXTURE2D_DESC& desc, bool own = false) : child(owner, "texture", own), desc(desc) {}
+        void STDMETHODCALLTYPE GetDesc(D3D11_TEXTURE2D_DESC* out) override { *out = desc; }
+    };
+
+    template <typename Base>
+    class view : public child<Base> {
+    private:
+        ID3D11Resource* resource_;
+
+    public:
+        view(device* owner, const char* kind, ID3D11Resource* resource, bool own = false) : child<Base>(owner, kind, own), resource_(resource) {
+            if (resource_) resource_->AddRef();
+        }
+        ~view() override {
+            if (resource_) resource_->Release();
+        }
+        void STDMETHODCALLTYPE GetResource(ID3D11Resource** out) override {
+            *out = resource_;
+            if (resource_) resource_->AddRef();
+        }
+    };
+
+    class query : public child<ID3D11Predicate> {
+    public:
+        D3D11_QUERY type;
+        query(device* owner, D3D11_QUERY type);
+        UINT STDMETHODCALLTYPE GetDataSize() override { return 8; }
+    };
+
+    class blob : public object<ID3D10Blob> {
+    public:
+        std::vector<unsigned char> bytes;
+        explicit blob(size_t size) : object(nullptr, "blob"), bytes(size ? size : 1) {}
+        void* STDMETHODCALLTYPE GetBufferPointer() override { return bytes.data(); }
+        SIZE_T STDMETHODCALLTYPE GetBufferSize() override { return bytes.size(); }
+    };
+
+    class context : public child<ID3D11DeviceContext> {
+    private:
+        uint64_t clock_ = 0;
+
+    public:
+        ID3D11RenderTargetView* back_buffer = nullptr;
+        D3D11_VIEWPORT viewport = { 0.0f, 0.0f, 1280.0f, 720.0f, 0.0f, 1.0f };
+
+        explicit context(device* owner) : child(owner, "context", true) {}
+
+        void STDMETHODCALLTYPE OMGetRenderTargets(UINT count, ID3D11RenderTargetView** rtvs, ID3D11DepthStencilView** dsv) override;
+        void STDMETHODCALLTYPE OMSetRenderTargets(UINT, ID3D11RenderTargetView* const*, ID3D11DepthStencilView*) override { record("OMSetRenderTargets"); }
+        void STDMETHODCALLTYPE OMSetBlendState(ID3D11BlendState*, const FLOAT[4], UINT) override { record("OMSetBlendState"); }
+        void STDMETHODCALLTYPE OMGetBlendState(ID3D11BlendState** state, FLOAT[4], UINT* mask) override;
+        void STDMETHODCALLTYPE RSGetViewports(UINT* count, D3D11_VIEWPORT* viewports) override;
+        void STDMETHODCALLTYPE RSSetViewports(UINT, const D3D11_VIEWPORT*) override { record("RSSetViewports"); }
+        void STDMETHODCALLTYPE RSSetScissorRects(UINT, const D3D11_RECT*) override { record("RSSetScissorRects"); }
+        void STDMETHODCALLTYPE RSGetScissorRects(UINT* count, D3D11_RECT*) override { record("RSGetScissorRects"); *count = 0; }
+        void STDMETHODCALLTYPE RSSetState(ID3D11RasterizerState*) override { record("RSSetState"); }
+        void STDMETHODCALLTYPE RSGetState(ID3D11RasterizerState** state) override { record("RSGetState"); *state = nullptr; }
+        HRESULT STDMETHODCALLTYPE Map(ID3D11Resource* resource, UINT, D3D11_MAP, UINT, D3D11_MAPPED_SUBRESOURCE* mapped) override;
+        void STDMETHODCALLTYPE Unmap(ID3D11Resource*, UINT) override { record("Unmap"); }
+        void STDMETHODCALLTYPE IASetVertexBuffers(UINT, UINT, ID3D11Buffer* const*, const UINT*, const UINT*) override { record("IASetVertexBuffers"); }
+        void STDMETHODCALLTYPE IASetInputLayout(ID3D11InputLayout*) override { record("IASetInputLayout"); }
+        void STDMETHODCALLTYPE IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY) override { record("IASetPrimitiveTopology"); }
+        void STDMETHODCALLTYPE VSSetShader(ID3D11VertexShader*, ID3D11ClassInstance* const*, UINT) override { record("VSSetShader"); }
+        void STDMETHODCALLTYPE PSSetShader(ID3D11PixelShader*, ID3D11ClassInstance* const*, UINT) override { record("PSSetShader"); }
+        void STDMETHODCALLTYPE CSSetShader(ID3D11ComputeShader*, ID3D11ClassInstance* const*, UINT) override { record("CSSetShader"); }
+        void STDMETHODCALLTYPE PSSetConstantBuffers(UINT, UINT, ID3D11Buffer* const*) override { record("PSSetConstantBuffers"); }
+        void STDMETHODCALLTYPE VSSetConstantBuffers(UINT, UINT, ID3D11Buffer* const*) override { record("VSSetConstantBuffers"); }
+        void STDMETHODCALLTYPE CSSetConstantBuffers(UINT, UINT, ID3D11Buffer* const*) override { record("CSSetConstantBuffers"); }
+        void STDMETHODCALLTYPE PSSetSamplers(UINT, UINT, ID3D11SamplerState* const*) override { record("PSSetSamplers"); }
+        void STDMETHODCALLTYPE CSSetSamplers(UINT, UINT, ID3D11SamplerState* const*) override { record("CSSetSamplers"); }
+        void STDMETHODCALLTYPE PSSetShaderResources(UINT, UINT, ID3D11ShaderResourceView* const*) override { record("PSSetShaderResources"); }
+        void STDMETHODCALLTYPE CSSetShaderResources(UINT, UINT, ID3D11ShaderResourceView* const*) override { record("CSSetShaderResources"); }
+        void STDMETHODCALLTYPE CSSetUnorderedAccessViews(UINT, UINT, ID3D11UnorderedAccessView* const*, const UINT*) override { record("CSSetUnorderedAccessViews"); }
+        void STDMETHODCALLTYPE Draw(UINT, UINT) override { record("Draw"); }
+        void STDMETHODCALLTYPE DrawInstanced(UINT, UINT, UINT, UINT) override { record("DrawInstanced"); }
+        void STDMETHODCALLTYPE Dispatch(UINT, UINT, UINT) override { record("Dispatch"); }
+        void STDMETHODCALLTYPE CopySubresourceRegion(ID3D11Resource*, UINT, UINT, UINT, UINT, ID3D11Resource*, UINT, const D3D11_BOX*) override { record("CopySubresourceRegion"); }
+        void STDMETHODCALLTYPE CopyResource(ID3D11Resource*, ID3D11Resource*) override { record("CopyResource"); }
+        void STDMETHODCALLTYPE GenerateMips(ID3D11ShaderResourceView*) override { record("GenerateMips"); }
+        void STDMETHODCALLTYPE Begin(ID3D11Asynchronous*) override { record("Begin"); }
+        void STDMETHODCALLTYPE End(ID3D11Asynchronous*) override { record("End"); }
+        HRESULT STDMETHODCALLTYPE GetData(ID3D11Asynchronous* async, void* data, UINT size, UINT flags) override;
+        void STDMETHODCALLTYPE SetPredication(ID3D11Predicate*, BOOL) override { record("SetPredication"); }
+        void STDMETHODCALLTYPE ClearRenderTargetView(ID3D11RenderTargetView*, const FLOAT[4]) override { record("ClearRenderTargetView"); }
+        void STDMETHODCALLTYPE ClearUnorderedAccessViewUint(ID3D11UnorderedAccessView*, const UINT[4]) override { record("ClearUnorderedAccessViewUint"); }
+    };
+
+    // Starts with one reference, its immediate context and a 1280x720 back buffer bound as render target.
+    class device : public object<ID3D11Device> {
+    private:
+        context* context_ = nullptr;
+        texture* back_buffer_ = nullptr;
+        ULONG child_refs_ = 0;
+
+        template <typename Base>
+        friend class child;
+
+    public:
+        explicit device(D3D_FEATURE_LEVEL feature_level = D3D_FEATURE_LEVEL_11_0);
+        ~device() override;
+
+        D3D_FEATURE_LEVEL feature_level;
+
+        // References held by others than children, i.e. by the code under test plus the creator's one.
+        ULONG external_refs() const { return refs() - child_refs_; }
+        context& immediate_context() { return *context_; }
+
+        HRESULT STDMETHODCALLTYPE CreateBuffer(const D3D11_BUFFER_DESC* desc, const D3D11_SUBRESOURCE_DATA*, ID3D11Buffer** out) override;
+        HRESULT STDMETHODCALLTYPE CreateTexture2D(const D3D11_TEXTURE2D_DESC* desc, const D3D11_SUBRESOURCE_DATA*, ID3D11Texture2D** out) override;
+        HRESULT STDMETHODCALLTYPE CreateShaderResourceView(ID3D11Resource* resource, const D3D11_SHADER_RESOURCE_VIEW_DESC*, ID3D11ShaderResourceView** out) override;
+        HRESULT STDMETHODCALLTYPE CreateUnorderedAccessView(ID3D11Resource* resource, const D3D11_UNORDERED_ACCESS_VIEW_DESC*, ID3D11UnorderedAccessView** out) override;
+        HRESULT STDMETHODCALLTYPE CreateRenderTargetView(ID3D11Resource* resource, const D3D11_RENDER_TARGET_VIEW_DESC*, ID3D11RenderTargetView** out) override;
+        HRESULT STDMETHODCALLTYPE CreateInputLayout(const D3D11_INPUT_ELEMENT_DESC*, UINT, const void*, SIZE_T, ID3D11InputLayout** out) override;
+        HRESULT STDMETHODCALLTYPE CreateVertexShader(const void*, SIZE_T, ID3D11ClassLinkage*, ID3D11VertexShader** out) override;
+        HRESULT STDMETHODCALLTYPE CreatePixelShader(const void*, SIZE_T, ID3D11ClassLinkage*, ID3D11PixelShader** out) override;
+        HRESULT STDMETHODCALLTYPE CreateComputeShader(const void*, SIZE_T, ID3D11ClassLinkage*, ID3D11ComputeShader** out) override;
+        HRESULT STDMETHODCALLTYPE CreateBlendState(const D3D11_BLEND_DESC*, ID3D11BlendState** out) override;
+        HRESULT STDMETHODCALLTYPE CreateRasterizerState(const D3D11_RASTERIZER_DESC*, ID3D11RasterizerState** out) override;
+        HRESULT STDMETHODCALLTYPE CreateSamplerState(const D3D11_SAMPLER_DESC*, ID3D11SamplerState** out) override;
+        HRESULT STDMETHODCALLTYPE CreateQuery(const D3D11_QUERY_DESC* desc, ID3D11Query** out) override;
+        HRESULT STDMETHODCALLTYPE CreatePredicate(const D3D11_QUERY_DESC* desc, ID3D11Predicate** out) override;
+        D3D_FEATURE_LEVEL STDMETHODCALLTYPE GetFeatureLevel() override { return feature_level; }
+        void STDMETHODCALLTYPE GetImmediateContext(ID3D11DeviceContext** out) override;
+    };
+
+    template <typename Base>
+    ULONG object<Base>::Release() {
+        ULONG refs = --refs_;
+        if (refs == 0) delete this;
+        return refs;
+    }
+
+    template <typename Base>
+    child<Base>::child(device* owner, const char* kind, bool own) : object<Base>(owner, kind, !own) {
+        if (own) return;
+        owner->AddRef();
+        owner->child_refs_++;
+    }
+
+    template <typename Base>
+    child<Base>::~child() {
+        if (!this->recorded_) return;
+        device* owner = this->owner_;
+        owner->child_refs_--;
+        owner->Release();
+    }
+
+    template <typename Base>
+    void child<Base>::GetDevice(ID3D11Device** out) {
+        *out = this->owner_;
+        this->owner_->AddRef();
+    }
+
+}
+
+#endif
@@ -0,0 +1,126 @@
+#include "fake_imgui.hpp"
+
+namespace {
+
+    void add_quad(ImDrawList& list, ImTextureID texture, const ImVec2& a, const ImVec2& b, ImU32 col) {
+        unsigned base = static_cast<unsigned>(list.VtxBuffer.Size);
+        list.VtxBuffer.push_back({ a, ImVec2(0.0f, 0.0f), col });
+        list.VtxBuffer.push_back({ ImVec2(b.x, a.y), ImVec2(1.0f, 0.0f), col });
+        list.VtxBuffer.push_back({ b, ImVec2(1.0f, 1.0f), col });
+        list.VtxBuffer.push_back({ ImVec2(a.x, b.y), ImVec2(0.0f, 1.0f), col });
+        for (unsigned i : { 0u, 1u, 2u, 0u, 2u, 3u }) list.IdxBuffer.push_back(static_cast<ImDrawIdx>(base + i));
+
+        if (!list.CmdBuffer.empty() && !list.CmdBuffer.back().UserCallback && list.CmdBuffer.back().TextureId == texture) {
+            list.CmdBuffer.back().ElemCount += 6;
+            return;
+        }
+
+        ImDrawCmd cmd = {};
+        cmd.ClipRect = ImVec4(0.0f, 0.0f, fake::imgui().io.DisplaySize.x, fake::imgui().io.DisplaySize.y);
+        cmd.TextureId = texture;
+        cmd.IdxOffset = static_cast<unsigned>(list.IdxBuffer.Size - 6);
+        cmd.ElemCount = 6;
+        list.CmdBuffer.push_back(cmd);
+    }
+
+    void clear(ImDrawList& list) {
+        list.CmdBuffer.clear();
+        list.VtxBuffer.clear();
+        list.IdxBuffer.clear();
+    }
+
+}
+
+void ImDrawList::AddImageRounded(ImTextureID texture, const ImVec2& p_min, const ImVec2& p_max, const ImVec2&, const ImVec2&,
+    ImU32 col, float, int) {
+    add_quad(*this, texture, p_min, p_max, col);
+}
+
+void ImDrawList::AddImage(ImTextureID texture, const ImVec2& p_min, const ImVec2& p_max, const ImVec2&, const ImVec2&, ImU32 col) {
+    add_quad(*this, texture, p_min, p_max, col);
+}
+
+void ImDrawList::AddRectFilled(const ImVec2& p_min, const ImVec2& p_max, ImU32 col, float, int) {
+    add_quad(*this, nullptr, p_min, p_max, col);
+}
+
+void ImDrawList::AddCallback(ImDrawCallback callback, void* callback_data) {
+    ImDrawCmd cmd = {};
+    cmd.UserCallback = callback;
+    cmd.UserCallbackData = callback_data;
+    cmd.IdxOffset = static_cast<unsigned>(IdxBuffer.Size);
+    CmdBuffer.push_back(cmd);
+}
+
+namespace ImGui {
+
+    ImGuiIO& GetIO() { return fake::imgui().io; }
+    ImDrawData* GetDrawData() { return &fake::imgui().draw_data; }
+    double GetTime() { return fake::imgui().time; }
+    int GetFrameCount() { return fake::imgui().frame; }
+    ImDrawList* GetBackgroundDrawList() { return &fake::imgui().background; }
+    ImDrawList* GetForegroundDrawList() { return &fake::imgui().foreground; }
+
+}
+
+namespace fake {
+
+    imgui_state& imgui() {
+        static imgui_state state;
+        return state;
+    }
+
+    ImDrawList* add_window() {
+        imgui().windows.push_back(new ImDrawList());
+        return imgui().windows.back();
+    }
+
+    void remove_windows() {
+        for (ImDrawList* list : imgui().windows) delete list;
+        imgui().windows.clear();
+    }
+
+    void new_frame() {
+        imgui_state& state = imgui();
+        state.frame++;
+        state.time += 1.0 / 60.0;
+        clear(state.background);
+        clear(state.foreground);
+        for (ImDrawList* list : state.windows) clear(*list);
+    }
+
+    void render_frame() {
+        imgui_state& state = imgui();
+        state.lists.clear();
+        state.lists.push_back(&state.background);
+        for (ImDrawList* list : state.windows) state.lists.push_back(list);
+        state.lists.push_back(&state.foreground);
+
+        ImDrawData& data = state.draw_data;
+        data.Valid = true;
+        data.CmdListsCount = static_cast<int>(state.lists.size());
+        data.CmdLists = state.lists.data();
+        data.DisplaySize = state.io.DisplaySize;
+        data.FramebufferScale = ImVec2(1.0f, 1.0f);
+        data.TotalIdxCount = 0;
+        data.TotalVtxCount = 0;
+        for (ImDrawList* list : state.lists) {
+            data.TotalIdxCount += list->IdxBuffer.Size;
+            data.TotalVtxCount += list->VtxBuffer.Size;
+        }
+
+        for (ImDrawList* list : state.lists) {
+            for (const ImDrawCmd& cmd : list->CmdBuffer) {
+                if (cmd.UserCallback == ImDrawCallback_ResetRenderState) continue;
+                if (cmd.UserCallback) {
+                    state.callbacks++;
+                    cmd.UserCallback(list, &cmd);
+                }
+                else {
+                    state.draws++;
+                }
+            }
+        }
+    }
+
+}
@@ -0,0 +1,40 @@
+#ifndef FAKE_IMGUI_HPP
+#define FAKE_IMGUI_HPP
+
+#include <imgui.h>
+
+#include <vector>
+
+// Frame loop for the stub imgui.h: draw lists for the background, the windows and the foreground, a clock advancing
+// 1/60 s per frame, and a replay of the draw data in the order ImGui_ImplDX11_RenderDrawData walks it.
+namespace fake {
+
+    struct imgui_state {
+        ImDrawList background;
+        ImDrawList foreground;
+        std::vector<ImDrawList*> windows;
+        ImGuiIO io = { 60.0f, ImVec2(1280.0f, 720.0f), 1.0f / 60.0f };
+        int frame = 0;
+        double time = 0.0;
+        ImDrawData draw_data = {};
+        std::vector<ImDrawList*> lists;
+        long draws = 0;                 // non-callback commands replayed
+        long callbacks = 0;
+    };
+
+    imgui_state& imgui();
+
+    // Window draw lists are drawn in the order they were added, between the background and the foreground.
+    ImDrawList* add_window();
+    void remove_windows();
+
+    // ImGui::NewFrame: clears every draw list and advances the frame counter and the clock.
+    void new_frame();
+
+    // ImGui::Render + ImGui_ImplDX11_RenderDrawData: user callbacks run in list order, ResetRenderState is skipped
+    // and every other command counts as one draw.
+    void render_frame();
+
+}
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef SCENE_HPP
+#define SCENE_HPP
+
+#include "fake_d3d11.hpp"
+#include "fake_imgui.hpp"
+
+#include "blur.hpp"
+
+#include <functional>
+#include <vector>
+
+namespace fake {
+
+    using configure_fn = std::function<void(blur::blur_params&, int)>;
+
+    // One renderer drawing blurred windows over a background that changes every frame when animated. device is the
+    // one passed to render(); pointing it at another is a device switch, and the scene's own is released at the end.
+    struct scene {
+        fake::device* const own = new fake::device();
+        fake::device* device = own;
+        blur::blur_renderer renderer;
+        std::vector<ImDrawList*> windows;
+        configure_fn configure;
+        bool animate = true;
+
+        explicit scene(int window_count, configure_fn configure = nullptr, bool animate = true)
+            : configure(std::move(configure)), animate(animate) {
+            for (int i = 0; i < window_count; i++) windows.push_back(add_window());
+        }
+
+        ~scene() {
+            renderer.release_device(device);
+            renderer.release_device(own);
+            remove_windows();
+            own->Release();
+        }
+
+        blur::blur_params params(int index) const {
+            blur::blur_params params{};
+            params.device = device;
+            params.draw_list = windows[index];
+            params.window_pos = ImVec2(40.0f + 150.0f * (index % 8), 40.0f + 150.0f * (index / 8));
+            params.window_size = ImVec2(140.0f, 120.0f);
+            if (configure) configure(params, index);
+            return params;
+        }
+
+        // ImGui::NewFrame and the windows' Begin, where they call render().
+        void build() {
+            new_frame();
+            ImU32 color = animate ? IM_COL32(imgui().frame & 255, 0, 0, 255) : IM_COL32(10, 20, 30, 255);
+            imgui().background.AddRectFilled(ImVec2(0.0f, 0.0f), ImVec2(1280.0f, 720.0f), color);
+            for (size_t i = 0; i < windows.size(); i++) {
+                blur::blur_params p = params(static_cast<int>(i));
+                renderer.render(p, true);
+                windows[i]->AddRectFilled(p.window_pos, ImVec2(p.window_pos.x + 50.0f, p.window_pos.y + 20.0f), IM_COL32(255, 255, 255, 255));
+            }
+        }
+
+        void frame() {
+            build();
+            render_frame();
+        }
+
+        void run(int frames) {
+            for (int i = 0; i < frames; i++) frame();
+        }
+    };
+
+}
+
+#endif
@@ -0,0 +1,129 @@
+#pragma once
+// The part of <d3d11.h> the blur headers use, so they build on Linux against the fakes in fake_d3d11.hpp.
+// Struct layouts follow the Windows SDK; interface method order does not.
+#include "d3dcommon.h"
+#define D3D11_FLOAT32_MAX (3.402823466e+38f)
+#define D3D11_SDK_VERSION 7
+enum DXGI_FORMAT { DXGI_FORMAT_UNKNOWN = 0, DXGI_FORMAT_R32G32B32_FLOAT = 6, DXGI_FORMAT_R32G32_FLOAT = 16, DXGI_FORMAT_R8G8B8A8_UNORM = 28, DXGI_FORMAT_R32G32B32A32_FLOAT = 2, DXGI_FORMAT_R32_UINT = 42, DXGI_FORMAT_R32_FLOAT = 41, DXGI_FORMAT_R16_UINT = 57 };
+struct DXGI_SAMPLE_DESC { UINT Count; UINT Quality; };
+enum D3D11_USAGE { D3D11_USAGE_DEFAULT = 0, D3D11_USAGE_IMMUTABLE = 1, D3D11_USAGE_DYNAMIC = 2, D3D11_USAGE_STAGING = 3 };
+enum D3D11_BIND_FLAG { D3D11_BIND_VERTEX_BUFFER = 1, D3D11_BIND_INDEX_BUFFER = 2, D3D11_BIND_CONSTANT_BUFFER = 4, D3D11_BIND_SHADER_RESOURCE = 8, D3D11_BIND_RENDER_TARGET = 0x20, D3D11_BIND_UNORDERED_ACCESS = 0x80 };
+enum D3D11_CPU_ACCESS_FLAG { D3D11_CPU_ACCESS_WRITE = 0x10000, D3D11_CPU_ACCESS_READ = 0x20000 };
+enum D3D11_RESOURCE_MISC_FLAG { D3D11_RESOURCE_MISC_GENERATE_MIPS = 1, D3D11_RESOURCE_MISC_BUFFER_STRUCTURED = 0x40 };
+enum D3D11_INPUT_CLASSIFICATION { D3D11_INPUT_PER_VERTEX_DATA = 0, D3D11_INPUT_PER_INSTANCE_DATA = 1 };
+#define D3D11_APPEND_ALIGNED_ELEMENT (0xffffffff)
+enum D3D11_FILTER { D3D11_FILTER_MIN_MAG_MIP_POINT = 0, D3D11_FILTER_MIN_MAG_MIP_LINEAR = 0x15 };
+enum D3D11_TEXTURE_ADDRESS_MODE { D3D11_TEXTURE_ADDRESS_WRAP = 1, D3D11_TEXTURE_ADDRESS_CLAMP = 3 };
+enum D3D11_COMPARISON_FUNC { D3D11_COMPARISON_NEVER = 1, D3D11_COMPARISON_ALWAYS = 8 };
+enum D3D11_BLEND { D3D11_BLEND_ZERO = 1, D3D11_BLEND_ONE = 2, D3D11_BLEND_SRC_ALPHA = 5, D3D11_BLEND_INV_SRC_ALPHA = 6 };
+enum D3D11_BLEND_OP { D3D11_BLEND_OP_ADD = 1 };
+enum D3D11_COLOR_WRITE_ENABLE { D3D11_COLOR_WRITE_ENABLE_ALL = 15 };
+enum D3D11_FILL_MODE { D3D11_FILL_SOLID = 3 };
+enum D3D11_CULL_MODE { D3D11_CULL_NONE = 1 };
+enum D3D11_MAP { D3D11_MAP_READ = 1, D3D11_MAP_WRITE = 2, D3D11_MAP_WRITE_DISCARD = 4 };
+enum D3D11_QUERY { D3D11_QUERY_EVENT = 0, D3D11_QUERY_OCCLUSION = 1, D3D11_QUERY_TIMESTAMP = 2, D3D11_QUERY_TIMESTAMP_DISJOINT = 3, D3D11_QUERY_OCCLUSION_PREDICATE = 5 };
+enum D3D11_ASYNC_GETDATA_FLAG { D3D11_ASYNC_GETDATA_DONOTFLUSH = 1 };
+enum D3D11_QUERY_MISC_FLAG { D3D11_QUERY_MISC_PREDICATEHINT = 1 };
+enum D3D11_SRV_DIMENSION_ { D3D11_SRV_DIMENSION_TEXTURE2D = 4 };
+enum D3D11_RTV_DIMENSION_ { D3D11_RTV_DIMENSION_TEXTURE2D = 4 };
+enum D3D11_UAV_DIMENSION_ { D3D11_UAV_DIMENSION_TEXTURE2D = 4, D3D11_UAV_DIMENSION_BUFFER = 1 };
+struct D3D11_BUFFER_DESC { UINT ByteWidth; D3D11_USAGE Usage; UINT BindFlags; UINT CPUAccessFlags; UINT MiscFlags; UINT StructureByteStride; };
+struct D3D11_TEXTURE2D_DESC { UINT Width, Height, MipLevels, ArraySize; DXGI_FORMAT Format; DXGI_SAMPLE_DESC SampleDesc; D3D11_USAGE Usage; UINT BindFlags, CPUAccessFlags, MiscFlags; };
+struct D3D11_SUBRESOURCE_DATA { const void* pSysMem; UINT SysMemPitch; UINT SysMemSlicePitch; };
+struct D3D11_MAPPED_SUBRESOURCE { void* pData; UINT RowPitch; UINT DepthPitch; };
+struct D3D11_INPUT_ELEMENT_DESC { LPCSTR SemanticName; UINT SemanticIndex; DXGI_FORMAT Format; UINT InputSlot; UINT AlignedByteOffset; D3D11_INPUT_CLASSIFICATION InputSlotClass; UINT InstanceDataStepRate; };
+struct D3D11_SAMPLER_DESC { D3D11_FILTER Filter; D3D11_TEXTURE_ADDRESS_MODE AddressU, AddressV, AddressW; FLOAT MipLODBias; UINT MaxAnisotropy; D3D11_COMPARISON_FUNC ComparisonFunc; FLOAT BorderColor[4]; FLOAT MinLOD, MaxLOD; };
+struct D3D11_RENDER_TARGET_BLEND_DESC { BOOL BlendEnable; D3D11_BLEND SrcBlend, DestBlend; D3D11_BLEND_OP BlendOp; D3D11_BLEND SrcBlendAlpha, DestBlendAlpha; D3D11_BLEND_OP BlendOpAlpha; BYTE RenderTargetWriteMask; };
+struct D3D11_BLEND_DESC { BOOL AlphaToCoverageEnable; BOOL IndependentBlendEnable; D3D11_RENDER_TARGET_BLEND_DESC RenderTarget[8]; };
+struct D3D11_RASTERIZER_DESC { D3D11_FILL_MODE FillMode; D3D11_CULL_MODE CullMode; BOOL FrontCounterClockwise; INT DepthBias; FLOAT DepthBiasClamp, SlopeScaledDepthBias; BOOL DepthClipEnable, ScissorEnable, MultisampleEnable, AntialiasedLineEnable; };
+struct D3D11_VIEWPORT { FLOAT TopLeftX, TopLeftY, Width, Height, MinDepth, MaxDepth; };
+typedef struct { long left, top, right, bottom; } D3D11_RECT;
+struct D3D11_BOX { UINT left, top, front, right, bottom, back; };
+struct D3D11_TEX2D_SRV { UINT MostDetailedMip; UINT MipLevels; };
+struct D3D11_SHADER_RESOURCE_VIEW_DESC { DXGI_FORMAT Format; UINT ViewDimension; union { D3D11_TEX2D_SRV Texture2D; }; };
+struct D3D11_TEX2D_RTV { UINT MipSlice; };
+struct D3D11_RENDER_TARGET_VIEW_DESC { DXGI_FORMAT Format; UINT ViewDimension; union { D3D11_TEX2D_RTV Texture2D; }; };
+struct D3D11_TEX2D_UAV { UINT MipSlice; };
+struct D3D11_BUFFER_UAV { UINT FirstElement, NumElements, Flags; };
+struct D3D11_UNORDERED_ACCESS_VIEW_DESC { DXGI_FORMAT Format; UINT ViewDimension; union { D3D11_BUFFER_UAV Buffer; D3D11_TEX2D_UAV Texture2D; }; };
+struct D3D11_QUERY_DESC { D3D11_QUERY Query; UINT MiscFlags; };
+struct D3D11_QUERY_DATA_TIMESTAMP_DISJOINT { UINT64 Frequency; BOOL Disjoint; };
+struct ID3D11Device;
+struct ID3D11DeviceChild : IUnknown { virtual void STDMETHODCALLTYPE GetDevice(ID3D11Device**) = 0; };
+struct ID3D11Resource : ID3D11DeviceChild {};
+struct ID3D11Buffer : ID3D11Resource {};
+struct ID3D11Texture2D : ID3D11Resource { virtual void STDMETHODCALLTYPE GetDesc(D3D11_TEXTURE2D_DESC*) = 0; };
+struct ID3D11View : ID3D11DeviceChild { virtual void STDMETHODCALLTYPE GetResource(ID3D11Resource**) = 0; };
+struct ID3D11RenderTargetView : ID3D11View {};
+struct ID3D11DepthStencilView : ID3D11View {};
+struct ID3D11ShaderResourceView : ID3D11View {};
+struct ID3D11UnorderedAccessView : ID3D11View {};
+struct ID3D11VertexShader : ID3D11DeviceChild {};
+struct ID3D11PixelShader : ID3D11DeviceChild {};
+struct ID3D11ComputeShader : ID3D11DeviceChild {};
+struct ID3D11InputLayout : ID3D11DeviceChild {};
+struct ID3D11SamplerState : ID3D11DeviceChild {};
+struct ID3D11BlendState : ID3D11DeviceChild {};
+struct ID3D11RasterizerState : ID3D11DeviceChild {};
+struct ID3D11ClassLinkage; struct ID3D11ClassInstance;
+struct ID3D11Asynchronous : ID3D11DeviceChild { virtual UINT STDMETHODCALLTYPE GetDataSize() = 0; };
+struct ID3D11Query : ID3D11Asynchronous {};
+struct ID3D11Predicate : ID3D11Query {};
+struct ID3D11DeviceContext : ID3D11DeviceChild {
+ virtual void STDMETHODCALLTYPE OMGetRenderTargets(UINT, ID3D11RenderTargetView**, ID3D11DepthStencilView**) = 0;
+ virtual void STDMETHODCALLTYPE OMSetRenderTargets(UINT, ID3D11RenderTargetView* const*, ID3D11DepthStencilView*) = 0;
+ virtual void STDMETHODCALLTYPE OMSetBlendState(ID3D11BlendState*, const FLOAT[4], UINT) = 0;
+ virtual void STDMETHODCALLTYPE OMGetBlendState(ID3D11BlendState**, FLOAT[4], UINT*) = 0;
+ virtual void STDMETHODCALLTYPE RSGetViewports(UINT*, D3D11_VIEWPORT*) = 0;
+ virtual void STDMETHODCALLTYPE RSSetViewports(UINT, const D3D11_VIEWPORT*) = 0;
+ virtual void STDMETHODCALLTYPE RSSetScissorRects(UINT, const D3D11_RECT*) = 0;
+ virtual void STDMETHODCALLTYPE RSGetScissorRects(UINT*, D3D11_RECT*) = 0;
+ virtual void STDMETHODCALLTYPE RSSetState(ID3D11RasterizerState*) = 0;
+ virtual void STDMETHODCALLTYPE RSGetState(ID3D11RasterizerState**) = 0;
+ virtual HRESULT STDMETHODCALLTYPE Map(ID3D11Resource*, UINT, D3D11_MAP, UINT, D3D11_MAPPED_SUBRESOURCE*) = 0;
+ virtual void STDMETHODCALLTYPE Unmap(ID3D11Resource*, UINT) = 0;
+ virtual void STDMETHODCALLTYPE IASetVertexBuffers(UINT, UINT, ID3D11Buffer* const*, const UINT*, const UINT*) = 0;
+ virtual void STDMETHODCALLTYPE IASetInputLayout(ID3D11InputLayout*) = 0;
+ virtual void STDMETHODCALLTYPE IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY) = 0;
+ virtual void STDMETHODCALLTYPE VSSetShader(ID3D11VertexShader*, ID3D11ClassInstance* const*, UINT) = 0;
+ virtual void STDMETHODCALLTYPE PSSetShader(ID3D11PixelShader*, ID3D11ClassInstance* const*, UINT) = 0;
+ virtual void STDMETHODCALLTYPE CSSetShader(ID3D11ComputeShader*, ID3D11ClassInstance* const*, UINT) = 0;
+ virtual void STDMETHODCALLTYPE PSSetConstantBuffers(UINT, UINT, ID3D11Buffer* const*) = 0;
+ virtual void STDMETHODCALLTYPE VSSetConstantBuffers(UINT, UINT, ID3D11Buffer* const*) = 0;
+ virtual void STDMETHODCALLTYPE CSSetConstantBuffers(UINT, UINT, ID3D11Buffer* const*) = 0;
+ virtual void STDMETHODCALLTYPE PSSetSamplers(UINT, UINT, ID3D11SamplerState* const*) = 0;
+ virtual void STDMETHODCALLTYPE CSSetSamplers(UINT, UINT, ID3D11SamplerState* const*) = 0;
+ virtual void STDMETHODCALLTYPE PSSetShaderResources(UINT, UINT, ID3D11ShaderResourceView* const*) = 0;
+ virtual void STDMETHODCALLTYPE CSSetShaderResources(UINT, UINT, ID3D11ShaderResourceView* const*) = 0;
+ virtual void STDMETHODCALLTYPE CSSetUnorderedAccessViews(UINT, UINT, ID3D11UnorderedAccessView* const*, const UINT*) = 0;
+ virtual void STDMETHODCALLTYPE Draw(UINT, UINT) = 0;
+ virtual void STDMETHODCALLTYPE DrawInstanced(UINT, UINT, UINT, UINT) = 0;
+ virtual void STDMETHODCALLTYPE Dispatch(UINT, UINT, UINT) = 0;
+ virtual void STDMETHODCALLTYPE CopySubresourceRegion(ID3D11Resource*, UINT, UINT, UINT, UINT, ID3D11Resource*, UINT, const D3D11_BOX*) = 0;
+ virtual void STDMETHODCALLTYPE CopyResource(ID3D11Resource*, ID3D11Resource*) = 0;
+ virtual void STDMETHODCALLTYPE GenerateMips(ID3D11ShaderResourceView*) = 0;
+ virtual void STDMETHODCALLTYPE Begin(ID3D11Asynchronous*) = 0;
+ virtual void STDMETHODCALLTYPE End(ID3D11Asynchronous*) = 0;
+ virtual HRESULT STDMETHODCALLTYPE GetData(ID3D11Asynchronous*, void*, UINT, UINT) = 0;
+ virtual void STDMETHODCALLTYPE SetPredication(ID3D11Predicate*, BOOL) = 0;
+ virtual void STDMETHODCALLTYPE ClearRenderTargetView(ID3D11RenderTargetView*, const FLOAT[4]) = 0;
+ virtual void STDMETHODCALLTYPE ClearUnorderedAccessViewUint(ID3D11UnorderedAccessView*, const UINT[4]) = 0;
+};
+struct ID3D11Device : IUnknown {
+ virtual HRESULT STDMETHODCALLTYPE CreateBuffer(const D3D11_BUFFER_DESC*, const D3D11_SUBRESOURCE_DATA*, ID3D11Buffer**) = 0;
+ virtual HRESULT STDMETHODCALLTYPE CreateTexture2D(const D3D11_TEXTURE2D_DESC*, const D3D11_SUBRESOURCE_DATA*, ID3D11Texture2D**) = 0;
+ virtual HRESULT STDMETHODCALLTYPE CreateShaderResourceView(ID3D11Resource*, const D3D11_SHADER_RESOURCE_VIEW_DESC*, ID3D11ShaderResourceView**) = 0;
+ virtual HRESULT STDMETHODCALLTYPE CreateUnorderedAccessView(ID3D11Resource*, const D3D11_UNORDERED_ACCESS_VIEW_DESC*, ID3D11UnorderedAccessView**) = 0;
+ virtual HRESULT STDMETHODCALLTYPE CreateRenderTargetView(ID3D11Resource*, const D3D11_RENDER_TARGET_VIEW_DESC*, ID3D11RenderTargetView**) = 0;
+ virtual HRESULT STDMETHODCALLTYPE CreateInputLayout(const D3D11_INPUT_ELEMENT_DESC*, UINT, const void*, SIZE_T, ID3D11InputLayout**) = 0;
+ virtual HRESULT STDMETHODCALLTYPE CreateVertexShader(const void*, SIZE_T, ID3D11ClassLinkage*, ID3D11VertexShader**) = 0;
+ virtual HRESULT STDMETHODCALLTYPE CreatePixelShader(const void*, SIZE_T, ID3D11ClassLinkage*, ID3D11PixelShader**) = 0;
+ virtual HRESULT STDMETHODCALLTYPE CreateComputeShader(const void*, SIZE_T, ID3D11ClassLinkage*, ID3D11ComputeShader**) = 0;
+ virtual HRESULT STDMETHODCALLTYPE CreateBlendState(const D3D11_BLEND_DESC*, ID3D11BlendState**) = 0;
+ virtual HRESULT STDMETHODCALLTYPE CreateRasterizerState(const D3D11_RASTERIZER_DESC*, ID3D11RasterizerState**) = 0;
+ virtual HRESULT STDMETHODCALLTYPE CreateSamplerState(const D3D11_SAMPLER_DESC*, ID3D11SamplerState**) = 0;
+ virtual HRESULT STDMETHODCALLTYPE CreateQuery(const D3D11_QUERY_DESC*, ID3D11Query**) = 0;
+ virtual HRESULT STDMETHODCALLTYPE CreatePredicate(const D3D11_QUERY_DESC*, ID3D11Predicate**) = 0;
+ virtual D3D_FEATURE_LEVEL STDMETHODCALLTYPE GetFeatureLevel() = 0;
+ virtual void STDMETHODCALLTYPE GetImmediateContext(ID3D11DeviceContext**) = 0;
+};
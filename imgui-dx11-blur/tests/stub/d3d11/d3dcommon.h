@@ -0,0 +1,9 @@
+#pragma once
+// The part of <d3dcommon.h> the blur headers use.
+#include "win32_types.h"
+struct ID3D10Blob : IUnknown { virtual void* STDMETHODCALLTYPE GetBufferPointer() = 0; virtual SIZE_T STDMETHODCALLTYPE GetBufferSize() = 0; };
+typedef ID3D10Blob ID3DBlob;
+struct D3D_SHADER_MACRO { LPCSTR Name; LPCSTR Definition; };
+struct ID3DInclude;
+enum D3D_FEATURE_LEVEL { D3D_FEATURE_LEVEL_10_0 = 0xa000, D3D_FEATURE_LEVEL_10_1 = 0xa100, D3D_FEATURE_LEVEL_11_0 = 0xb000 };
+enum D3D_PRIMITIVE_TOPOLOGY { D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP = 5, D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST = 4 };
@@ -0,0 +1,7 @@
+#pragma once
+// The part of <d3dcompiler.h> the blur headers use; fake_d3d11.cpp defines the functions.
+#include "d3dcommon.h"
+#define D3DCOMPILE_ENABLE_STRICTNESS (1 << 11)
+#define D3DCOMPILE_OPTIMIZATION_LEVEL3 (1 << 15)
+HRESULT D3DCompile(LPCVOID, SIZE_T, LPCSTR, const D3D_SHADER_MACRO*, ID3DInclude*, LPCSTR, LPCSTR, UINT, UINT, ID3DBlob**, ID3DBlob**);
+HRESULT D3DCreateBlob(SIZE_T, ID3DBlob**);
@@ -0,0 +1,20 @@
+#pragma once
+// Win32 types and COM's IUnknown as far as the D3D11 stubs need them.
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+typedef int32_t HRESULT; typedef unsigned int UINT; typedef int INT; typedef int BOOL; typedef uint64_t UINT64; typedef unsigned long ULONG; typedef float FLOAT; typedef void* HANDLE; typedef unsigned char BYTE; typedef size_t SIZE_T; typedef const char* LPCSTR; typedef const void* LPCVOID; typedef unsigned long DWORD;
+#define TRUE 1
+#define FALSE 0
+#define S_OK 0
+#define S_FALSE 1
+#define SUCCEEDED(hr) (((HRESULT)(hr)) >= 0)
+#define FAILED(hr) (((HRESULT)(hr)) < 0)
+#define E_FAIL ((HRESULT)0x80004005)
+#define E_OUTOFMEMORY ((HRESULT)0x8007000E)
+#define E_INVALIDARG ((HRESULT)0x80070057)
+#define E_NOINTERFACE ((HRESULT)0x80004002)
+#define STDMETHODCALLTYPE
+struct GUID { unsigned long d1; unsigned short d2, d3; unsigned char d4[8]; };
+typedef GUID IID; typedef const IID& REFIID;
+struct IUnknown { virtual HRESULT STDMETHODCALLTYPE QueryInterface(REFIID, void**) = 0; virtual ULONG STDMETHODCALLTYPE AddRef() = 0; virtual ULONG STDMETHODCALLTYPE Release() = 0; };
@@ -0,0 +1,138 @@
+#pragma once
+// The part of Dear ImGui's API the blur headers use, so they build without the imgui submodule; fake_imgui.cpp
+// implements it. Draw lists own their buffers like the real ones, so commands can be added and replayed.
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+typedef unsigned int ImU32;
+typedef unsigned int ImGuiID;
+typedef void* ImTextureID;
+typedef int ImGuiWindowFlags;
+typedef int ImGuiCond;
+typedef unsigned short ImDrawIdx;
+
+struct ImVec2 {
+    float x, y;
+    constexpr ImVec2() : x(0.0f), y(0.0f) {}
+    constexpr ImVec2(float x, float y) : x(x), y(y) {}
+};
+
+struct ImVec4 {
+    float x, y, z, w;
+    constexpr ImVec4() : x(0.0f), y(0.0f), z(0.0f), w(0.0f) {}
+    constexpr ImVec4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+};
+
+#define IM_COL32(R, G, B, A) (((ImU32)(A) << 24) | ((ImU32)(B) << 16) | ((ImU32)(G) << 8) | ((ImU32)(R)))
+#define IM_ASSERT(x) ((void)0)
+
+// Trivially copyable elements only, like ImGui's.
+template <typename T>
+struct ImVector {
+    int Size = 0;
+    int Capacity = 0;
+    T* Data = nullptr;
+
+    ImVector() = default;
+    ImVector(const ImVector&) = delete;
+    ImVector& operator=(const ImVector&) = delete;
+    ~ImVector() { free(Data); }
+
+    T& operator[](int i) { return Data[i]; }
+    const T& operator[](int i) const { return Data[i]; }
+    T* begin() { return Data; }
+    T* end() { return Data + Size; }
+    const T* begin() const { return Data; }
+    const T* end() const { return Data + Size; }
+    bool empty() const { return Size == 0; }
+    T& back() { return Data[Size - 1]; }
+    void clear() { Size = 0; }
+
+    void push_back(const T& value) {
+        if (Size == Capacity) {
+            Capacity = Capacity ? Capacity * 2 : 8;
+            Data = static_cast<T*>(realloc(static_cast<void*>(Data), sizeof(T) * Capacity));
+        }
+        memcpy(static_cast<void*>(&Data[Size++]), &value, sizeof(T));
+    }
+};
+
+struct ImDrawList;
+struct ImDrawCmd;
+typedef void (*ImDrawCallback)(const ImDrawList* parent_list, const ImDrawCmd* cmd);
+#define ImDrawCallback_ResetRenderState (ImDrawCallback)(-8)
+
+struct ImDrawVert {
+    ImVec2 pos;
+    ImVec2 uv;
+    ImU32 col;
+};
+
+struct ImDrawCmd {
+    ImVec4 ClipRect;
+    ImTextureID TextureId;
+    unsigned int VtxOffset;
+    unsigned int IdxOffset;
+    unsigned int ElemCount;
+    ImDrawCallback UserCallback;
+    void* UserCallbackData;
+    ImTextureID GetTexID() const { return TextureId; }
+};
+
+struct ImDrawList {
+    ImVector<ImDrawCmd> CmdBuffer;
+    ImVector<ImDrawIdx> IdxBuffer;
+    ImVector<ImDrawVert> VtxBuffer;
+
+    void AddImageRounded(ImTextureID texture, const ImVec2& p_min, const ImVec2& p_max, const ImVec2& uv_min, const ImVec2& uv_max,
+        ImU32 col, float rounding, int flags = 0);
+    void AddImage(ImTextureID texture, const ImVec2& p_min, const ImVec2& p_max, const ImVec2& uv_min = ImVec2(0, 0),
+        const ImVec2& uv_max = ImVec2(1, 1), ImU32 col = 0xFFFFFFFF);
+    void AddRectFilled(const ImVec2& p_min, const ImVec2& p_max, ImU32 col, float rounding = 0.0f, int flags = 0);
+    void AddCallback(ImDrawCallback callback, void* callback_data);
+};
+
+struct ImDrawData {
+    bool Valid;
+    int CmdListsCount;
+    int TotalIdxCount;
+    int TotalVtxCount;
+    ImDrawList** CmdLists;
+    ImVec2 DisplayPos;
+    ImVec2 DisplaySize;
+    ImVec2 FramebufferScale;
+};
+
+struct ImGuiIO {
+    float Framerate;
+    ImVec2 DisplaySize;
+    float DeltaTime;
+};
+
+enum { ImGuiTreeNodeFlags_DefaultOpen = 1 << 5 };
+enum { ImGuiTableFlags_RowBg = 1 << 6 };
+
+namespace ImGui {
+    ImGuiIO& GetIO();
+    ImDrawData* GetDrawData();
+    double GetTime();
+    int GetFrameCount();
+    ImDrawList* GetBackgroundDrawList();
+    ImDrawList* GetForegroundDrawList();
+
+    // Declared for blur_panel.hpp; the fake does not implement them.
+    bool Begin(const char* name, bool* p_open = nullptr, ImGuiWindowFlags flags = 0);
+    void End();
+    void Text(const char* fmt, ...);
+    void TextUnformatted(const char* text, const char* text_end = nullptr);
+    bool CollapsingHeader(const char* label, int flags = 0);
+    bool BeginTable(const char* id, int columns, int flags = 0);
+    void EndTable();
+    void TableSetupColumn(const char* label, int flags = 0, float width = 0.0f);
+    void TableHeadersRow();
+    bool TableNextColumn();
+    void PlotLines(const char* label, const float* values, int count, int offset = 0, const char* overlay = nullptr,
+        float scale_min = 3.4e38f, float scale_max = 3.4e38f, ImVec2 size = ImVec2(0, 0), int stride = sizeof(float));
+}
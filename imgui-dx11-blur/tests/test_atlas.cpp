@@ -0,0 +1,124 @@
+#include "check.hpp"
+#include "scene.hpp"
+
+#include "blur_atlas.hpp"
+
+#include <random>
+
+namespace {
+
+    bool overlap(const blur::atlas_rect& a, const blur::atlas_rect& b, int padding) {
+        return a.x < b.x + b.width + padding && b.x < a.x + a.width + padding && a.y < b.y + b.height + padding &&
+            b.y < a.y + a.height + padding;
+    }
+
+    void random_sizes(blur::atlas_rect* sizes, int count, unsigned seed) {
+        std::mt19937 rng(seed);
+        for (int i = 0; i < count; i++) sizes[i] = { 0, 0, 50 + static_cast<int>(rng() % 400), 40 + static_cast<int>(rng() % 300) };
+    }
+
+}
+
+TEST(pack_keeps_padded_aligned_slots_apart) {
+    blur::atlas_rect sizes[50], rects[50];
+    random_sizes(sizes, 50, 7);
+
+    for (int alignment : { 1, 8, 64 }) {
+        blur::atlas_layout layout;
+        int width = 0, height = 0;
+        REQUIRE(layout.pack(sizes, rects, 50, alignment, width, height));
+        for (int i = 0; i < 50; i++) {
+            const blur::atlas_rect& a = rects[i];
+            CHECK(a.width == sizes[i].width && a.height == sizes[i].height);
+            CHECK(a.x >= 0 && a.y >= 0 && a.x + a.width < width && a.y + a.height < height);
+            CHECK(a.x % alignment == 0 && a.y % alignment == 0);
+            for (int j = 0; j < i; j++) {
+                if (!CHECK(!overlap(a, rects[j], 1))) std::fprintf(stderr, "  slots %d and %d, alignment %d\n", i, j, alignment);
+            }
+        }
+    }
+}
+
+TEST(level_rects_of_aligned_slots_stay_disjoint) {
+    blur::atlas_rect sizes[50], rects[50];
+    random_sizes(sizes, 50, 11);
+    blur::atlas_layout layout;
+    int width = 0, height = 0;
+    REQUIRE(layout.pack(sizes, rects, 50, 64, width, height));
+
+    for (int level = 1; level <= 6; level++) {
+        for (int i = 0; i < 50; i++) {
+            for (int j = 0; j < i; j++) CHECK(!overlap(blur::level_rect(rects[i], level), blur::level_rect(rects[j], level), 0));
+        }
+    }
+}
+
+TEST(insert_after_pack_uses_free_space_only) {
+    blur::atlas_rect sizes[8], rects[8];
+    random_sizes(sizes, 8, 3);
+    blur::atlas_layout layout;
+    int width = 0, height = 0;
+    REQUIRE(layout.pack(sizes, rects, 8, 8, width, height));
+
+    int inserted = 0;
+    blur::atlas_rect rect;
+    while (layout.fits(64, 48)) {
+        REQUIRE(layout.insert(64, 48, rect));
+        for (int i = 0; i < 8; i++) CHECK(!overlap(rect, rects[i], 1));
+        inserted++;
+    }
+    CHECK(inserted > 0);
+    CHECK(!layout.insert(64, 48, rect));
+}
+
+TEST(fits_does_not_place_anything) {
+    blur::skyline_packer packer;
+    packer.reset(64, 64);
+    blur::atlas_rect a, b;
+
+    CHECK(packer.fits(64, 64));
+    CHECK(!packer.fits(65, 1));
+    CHECK_EQ(packer.used_height(), 0);
+    REQUIRE(packer.pack(64, 64, a));
+    CHECK(a.x == 0 && a.y == 0);
+    CHECK(!packer.fits(1, 1));
+    CHECK(!packer.pack(1, 1, b));
+
+    packer.reset(64, 64);
+    REQUIRE(packer.pack(40, 10, a));
+    CHECK(packer.fits(24, 64));
+    CHECK(!packer.fits(25, 64));
+    CHECK_EQ(packer.used_height(), 10);
+}
+
+// place_region checks both atlases with fits() before inserting into either, so neither keeps a slot alone.
+TEST(fits_agrees_with_insert) {
+    std::mt19937 rng(5);
+    blur::atlas_layout layout;
+    blur::atlas_rect size = { 0, 0, 300, 200 }, rect;
+    int width = 1024, height = 512;
+    REQUIRE(layout.pack(&size, &rect, 1, 8, width, height));
+
+    int used = layout.used_height();
+    for (int i = 0; i < 200; i++) {
+        int w = 1 + static_cast<int>(rng() % 500), h = 1 + static_cast<int>(rng() % 300);
+        bool fits = layout.fits(w, h);
+        CHECK_EQ(layout.used_height(), used);
+        CHECK_EQ(layout.insert(w, h, rect), fits);
+        used = layout.used_height();
+    }
+}
+
+TEST(fifty_windows_allocate_nothing_once_settled) {
+    fake::scene s(50, [](blur::blur_params& p, int index) {
+        p.live = true;
+        p.window_pos = ImVec2(10.0f + 125.0f * (index % 10), 10.0f + 140.0f * (index / 10));
+        p.window_size = ImVec2(60.0f + 6.0f * (index % 10), 50.0f + 15.0f * (index / 10));
+    });
+    s.run(30);
+
+    fake::log().reset_counts();
+    s.run(120);
+    CHECK_EQ(fake::log().creates(), 0L);
+    CHECK_EQ(fake::log().copies(), 50L * 120);
+}
@@ -0,0 +1,322 @@
+#include "check.hpp"
+
+#include "blur_cpu.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+
+namespace {
+
+    // A smooth pattern with some noise, different per channel, like a busy backdrop.
+    struct test_image {
+        int width;
+        int height;
+        std::vector<uint8_t> pixels;
+
+        test_image(int width, int height, unsigned seed = 1) : width(width), height(height), pixels(static_cast<size_t>(width) * height * 4) {
+            std::mt19937 rng(seed);
+            for (int y = 0; y < height; y++) {
+                for (int x = 0; x < width; x++) {
+                    for (int c = 0; c < 4; c++) {
+                        double value = 128.0 + 100.0 * std::sin(x * 0.02 + c) * std::cos(y * 0.03) + rng() % 20;
+                        pixels[(static_cast<size_t>(y) * width + x) * 4 + c] = static_cast<uint8_t>(value);
+                    }
+                }
+            }
+        }
+
+        blur::cpu::image_view view() { return { pixels.data(), width, height, width * 4 }; }
+        blur::cpu::const_image_view const_view() const { return { pixels.data(), width, height, width * 4 }; }
+    };
+
+}
+
+TEST(psnr_of_identical_and_mismatched_images) {
+    test_image a(64, 32), b(64, 32), c(32, 64);
+    CHECK(std::isinf(blur::cpu::psnr(a.const_view(), b.const_view())));
+    CHECK_EQ(blur::cpu::psnr(a.const_view(), c.const_view()), 0.0);
+
+    // One channel of one texel off by 255: MSE = 255^2 / (64 * 32 * 4).
+    b.pixels[0] = static_cast<uint8_t>(a.pixels[0] ^ 0xFF);
+    double expected = 10.0 * std::log10(64.0 * 32.0 * 4.0 * 255.0 * 255.0 / ((a.pixels[0] - b.pixels[0]) * (a.pixels[0] - b.pixels[0])));
+    CHECK(std::fabs(blur::cpu::psnr(a.const_view(), b.const_view()) - expected) < 1e-9);
+}
+
+// Each factor against the full-resolution blur, radius 16 over an odd-sized 1000x601 image. Measured when this was
+// written: 54.7, 54.0 and 48.3 dB for factors 2, 4 and 8.
+TEST(downsampled_blur_stays_above_psnr_floor) {
+    const struct { int factor; double min_db; } floors[] = { { 2, 52.0 }, { 4, 51.0 }, { 8, 45.0 } };
+
+    test_image source(1000, 601), full(1000, 601), reduced(1000, 601);
+    blur::cpu::cpu_blur_renderer renderer(1);
+    blur::kernel_desc kernel;
+    kernel.radius = 16;
+    REQUIRE(renderer.process(source.const_view(), full.view(), 1.0f, kernel));
+
+    for (const auto& floor : floors) {
+        REQUIRE(renderer.process_downsampled(source.const_view(), reduced.view(), 1.0f, floor.factor, kernel));
+        double db = blur::cpu::psnr(full.const_view(), reduced.const_view());
+        std::printf("  factor %d: %.1f dB\n", floor.factor, db);
+        if (!CHECK(db >= floor.min_db)) std::fprintf(stderr, "  factor %d below %.1f dB\n", floor.factor, floor.min_db);
+    }
+
+    // Factor 1 is the full-resolution path itself.
+    REQUIRE(renderer.process_downsampled(source.const_view(), reduced.view(), 1.0f, 1, kernel));
+    CHECK(std::isinf(blur::cpu::psnr(full.const_view(), reduced.const_view())));
+}
+
+TEST(downsampled_blur_keeps_a_flat_image_flat) {
+    test_image source(301, 157), result(301, 157);
+    std::fill(source.pixels.begin(), source.pixels.end(), 77);
+    blur::cpu::cpu_blur_renderer renderer(1);
+
+    for (int factor : { 2, 4, 8 }) {
+        REQUIRE(renderer.process_downsampled(source.const_view(), result.view(), 1.0f, factor));
+        CHECK(std::isinf(blur::cpu::psnr(source.const_view(), result.const_view())));
+    }
+}
+
+TEST(changed_texels_threshold_edges) {
+    const int width = 64, height = 48;
+    std::vector<uint8_t> a(width * height * 4, 100), b(a);
+    blur::cpu::const_image_view current(a.data(), width, height, width * 4), reference(b.data(), width, height, width * 4);
+
+    CHECK_EQ(blur::cpu::changed_texels(current, reference, width, height, 0.0f), uint64_t(0));
+
+    // One texel two steps brighter in green: above a 1.5 step threshold, below a 2.5 step one.
+    b[(10 * width + 10) * 4 + 1] = 102;
+    CHECK_EQ(blur::cpu::changed_texels(current, reference, width, height, 1.5f / 255.0f), uint64_t(1));
+    CHECK_EQ(blur::cpu::changed_texels(current, reference, width, height, 2.5f / 255.0f), uint64_t(0));
+
+    // Alpha is not compared.
+    b[(10 * width + 10) * 4 + 3] = 0;
+    CHECK_EQ(blur::cpu::changed_texels(current, reference, width, height, 2.5f / 255.0f), uint64_t(0));
+
+    // On a grid of half the size the texel is averaged with three unchanged ones.
+    CHECK_EQ(blur::cpu::changed_texels(current, reference, width / 2, height / 2, 0.4f / 255.0f), uint64_t(1));
+    CHECK_EQ(blur::cpu::changed_texels(current, reference, width / 2, height / 2, 0.6f / 255.0f), uint64_t(0));
+
+    blur::cpu::const_image_view smaller(b.data(), width / 2, height, width * 4);
+    CHECK_EQ(blur::cpu::changed_texels(current, smaller, width, height, 0.0f), uint64_t(0));
+}
+
+TEST(change_tester_blurs_first_and_changed_captures) {
+    const int width = 64, height = 48;
+    std::vector<uint8_t> image(width * height * 4, 50);
+    blur::cpu::const_image_view capture(image.data(), width, height, width * 4);
+    blur::cpu::change_tester tester;
+    const float threshold = 3.0f / 255.0f;
+
+    CHECK(tester.test(capture, width, height, threshold));
+    CHECK(!tester.test(capture, width, height, threshold));
+
+    // A single texel past the threshold is enough.
+    image[(20 * width + 30) * 4] = 60;
+    CHECK(tester.test(capture, width, height, threshold));
+    CHECK(!tester.test(capture, width, height, threshold));
+
+    // A change below the threshold is skipped, and the reference stays at the last blurred capture.
+    image[(20 * width + 30) * 4] = 62;
+    CHECK(!tester.test(capture, width, height, threshold));
+
+    // Threshold 0 always blurs; so does a capture of another size or one after reset().
+    CHECK(tester.test(capture, width, height, 0.0f));
+    blur::cpu::const_image_view cropped(image.data(), width / 2, height, width * 4);
+    CHECK(tester.test(cropped, width / 2, height, threshold));
+    tester.reset();
+    CHECK(tester.test(cropped, width / 2, height, threshold));
+}
+
+// A change creeping by one step a frame adds up against the last blurred capture instead of slipping through.
+TEST(change_tester_catches_creeping_changes) {
+    const int width = 64, height = 48;
+    std::vector<uint8_t> image(width * height * 4, 50);
+    blur::cpu::const_image_view capture(image.data(), width, height, width * 4);
+    blur::cpu::change_tester tester;
+    const float threshold = 3.0f / 255.0f;
+
+    CHECK(tester.test(capture, width, height, threshold));
+    int blurs = 0;
+    for (int frame = 0; frame < 20; frame++) {
+        for (size_t i = 0; i < image.size(); i += 4) image[i]++;
+        blurs += tester.test(capture, width, height, threshold);
+    }
+    CHECK_EQ(blurs, 5);
+}
+
+// Linear mode merges tap pairs into one bilinear fetch each: at blur_strength 1 it is the discrete kernel in half the
+// fetches, up to rounding.
+TEST(linear_kernel_matches_discrete) {
+    blur::kernel_desc discrete, linear;
+    discrete.radius = linear.radius = 4;
+    linear.sampling = blur::kernel_sampling::linear;
+
+    blur::kernel_table discrete_table = blur::make_kernel_table(discrete);
+    blur::kernel_table linear_table = blur::make_kernel_table(linear);
+    CHECK_EQ(1 + 2 * (discrete_table.tap_count - 1), 2 * discrete.radius + 1);
+    CHECK_EQ(1 + 2 * (linear_table.tap_count - 1), linear.radius + 1);
+
+    float total = linear_table.taps[0].weight;
+    for (int i = 1; i < linear_table.tap_count; i++) total += 2.0f * linear_table.taps[i].weight;
+    CHECK(std::fabs(total - 1.0f) < 1e-5f);
+
+    test_image source(97, 61), a(97, 61), b(97, 61);
+    blur::cpu::cpu_blur_renderer renderer(1);
+    REQUIRE(renderer.process_reference(source.const_view(), a.view(), 1.0f, discrete));
+    REQUIRE(renderer.process_reference(source.const_view(), b.view(), 1.0f, linear));
+
+    int max_difference = 0;
+    for (size_t i = 0; i < a.pixels.size(); i++) max_difference = std::max(max_difference, std::abs(a.pixels[i] - b.pixels[i]));
+    CHECK(max_difference <= 1);
+}
+
+// Every SIMD variant the host runs must give the scalar kernels' bytes: same order of multiply-adds, same rounding.
+// Odd widths and a 1-row image reach the scalar tails.
+TEST(simd_row_kernels_match_scalar) {
+    const blur::cpu::kernel_isa variants[] = { blur::cpu::kernel_isa::sse2, blur::cpu::kernel_isa::avx2, blur::cpu::kernel_isa::neon };
+    const struct { int width, height; } sizes[] = { { 203, 67 }, { 64, 64 }, { 7, 1 } };
+
+    for (const auto& size : sizes) {
+        test_image source(size.width, size.height), expected(size.width, size.height), result(size.width, size.height);
+        blur::cpu::cpu_blur_renderer renderer(1, 32);
+
+        for (int radius : { 1, 4, 16 }) {
+            for (float blur_strength : { 1.0f, 2.5f }) {
+                blur::kernel_desc kernel;
+                kernel.radius = radius;
+                REQUIRE(blur::cpu::force_kernel_isa(blur::cpu::kernel_isa::scalar));
+                REQUIRE(renderer.process(source.const_view(), expected.view(), blur_strength, kernel));
+
+                for (blur::cpu::kernel_isa isa : variants) {
+                    if (!blur::cpu::force_kernel_isa(isa)) continue;
+                    CHECK(blur::cpu::active_kernel_isa() == isa);
+                    REQUIRE(renderer.process(source.const_view(), result.view(), blur_strength, kernel));
+                    if (!CHECK(result.pixels == expected.pixels)) {
+                        std::fprintf(stderr, "  %s, %dx%d, radius %d, strength %.1f\n", blur::cpu::kernel_isa_name(isa), size.width,
+                            size.height, radius, blur_strength);
+                    }
+                }
+            }
+        }
+    }
+
+    blur::cpu::reset_kernel_isa();
+    CHECK(blur::cpu::active_kernel_isa() == blur::cpu::detect_kernel_isa());
+}
+
+TEST(dual_kawase_keeps_flat_images_flat_and_smooths_noise) {
+    test_image flat(300, 170), result(300, 170);
+    std::fill(flat.pixels.begin(), flat.pixels.end(), 77);
+    blur::cpu::cpu_blur_renderer renderer(1);
+    REQUIRE(renderer.process_dual_kawase(flat.const_view(), result.view(), 3));
+    CHECK(result.pixels == flat.pixels);
+
+    // White noise: every level averages it further, so its spread around the mean shrinks with each iteration.
+    test_image noise(256, 256);
+    std::mt19937 rng(5);
+    for (uint8_t& value : noise.pixels) value = static_cast<uint8_t>(rng());
+    auto deviation = [](const std::vector<uint8_t>& pixels) {
+        double sum = 0.0, squares = 0.0;
+        for (uint8_t value : pixels) {
+            sum += value;
+            squares += static_cast<double>(value) * value;
+        }
+        double mean = sum / pixels.size();
+        return std::sqrt(squares / pixels.size() - mean * mean);
+    };
+
+    test_image smoothed(256, 256);
+    double previous = deviation(noise.pixels);
+    for (int iterations = 1; iterations <= 4; iterations++) {
+        REQUIRE(renderer.process_dual_kawase(noise.const_view(), smoothed.view(), iterations));
+        double current = deviation(smoothed.pixels);
+        std::printf("  %d iterations: deviation %.1f\n", iterations, current);
+        CHECK(current < previous * 0.6);
+        previous = current;
+    }
+}
+
+TEST(dual_kawase_levels_follow_the_radius) {
+    test_image source(300, 170), result(300, 170);
+    blur::cpu::cpu_blur_renderer renderer(1);
+
+    for (float radius : { 1.0f, 4.0f, 9.0f, 40.0f, 1000.0f }) {
+        int iterations = blur::kawase_iterations(radius);
+        REQUIRE(renderer.process_dual_kawase(source.const_view(), result.view(), iterations));
+        const std::vector<blur::cpu::kawase_level_timing>& levels = renderer.kawase_timings();
+        REQUIRE(static_cast<int>(levels.size()) == iterations);
+
+        int width = 300, height = 170;
+        for (const blur::cpu::kawase_level_timing& level : levels) {
+            width = std::max(1, width / 2);
+            height = std::max(1, height / 2);
+            CHECK_EQ(level.width, width);
+            CHECK_EQ(level.height, height);
+            CHECK(level.down_seconds > 0.0 && level.up_seconds > 0.0);
+        }
+    }
+    CHECK_EQ(blur::kawase_iterations(4.0f), 2);
+    CHECK_EQ(blur::kawase_iterations(9.0f), 4);
+    CHECK_EQ(blur::kawase_iterations(1000.0f), blur::max_kawase_iterations);
+}
+
+// The compute path keeps the horizontal result in float where the two passes round it to UNORM, hence one step.
+// Sizes that are not multiples of the tile cover the clamped apron at the right and bottom edges.
+TEST(compute_emulation_matches_separable_passes) {
+    test_image source(83, 45), temp(83, 45), expected(83, 45), result(83, 45);
+
+    for (int radius : { 1, 4, 8 }) {
+        blur::kernel_desc desc;
+        desc.radius = radius;
+        blur::pixel_kernel kernel = blur::make_pixel_kernel(1.0f, desc);
+        REQUIRE(blur::fits_compute_apron(kernel));
+
+        REQUIRE(blur::cpu::horizontal_pass(source.const_view(), temp.view(), 1.0f, desc));
+        REQUIRE(blur::cpu::vertical_pass(temp.const_view(), expected.view(), 1.0f, desc));
+        REQUIRE(blur::cpu::emulate_compute_blur(source.const_view(), result.view(), kernel));
+
+        int max_difference = 0;
+        for (size_t i = 0; i < expected.pixels.size(); i++) {
+            max_difference = std::max(max_difference, std::abs(expected.pixels[i] - result.pixels[i]));
+        }
+        if (!CHECK(max_difference <= 1)) std::fprintf(stderr, "  radius %d: %d steps\n", radius, max_difference);
+    }
+
+    // Radius 8 at strength 1.5 reaches 12 texels, past the 8 texel apron; the output is left alone.
+    blur::kernel_desc desc;
+    desc.radius = 8;
+    blur::pixel_kernel kernel = blur::make_pixel_kernel(1.5f, desc);
+    CHECK(!blur::fits_compute_apron(kernel));
+    std::fill(result.pixels.begin(), result.pixels.end(), 1);
+    CHECK(!blur::cpu::emulate_compute_blur(source.const_view(), result.view(), kernel));
+    CHECK(std::all_of(result.pixels.begin(), result.pixels.end(), [](uint8_t value) { return value == 1; }));
+}
+
+// The resolved pyramid against a separable Gaussian of the same sigma. Measured when this was written: 50.1, 52.7,
+// 50.4 and 42.3 dB for sigmas 1, 2, 4 and 8.
+TEST(resolved_pyramid_approximates_the_gaussian) {
+    const struct { float sigma; double min_db; } floors[] = { { 1.0f, 48.0 }, { 2.0f, 50.0 }, { 4.0f, 48.0 }, { 8.0f, 40.0 } };
+
+    test_image source(640, 360), gaussian(640, 360), resolved(640, 360);
+    blur::cpu::cpu_blur_renderer renderer(1);
+    REQUIRE(renderer.build_pyramid(source.const_view()));
+    CHECK_EQ(static_cast<int>(renderer.pyramid().size()), blur::pyramid_levels(640, 360));
+
+    for (const auto& floor : floors) {
+        blur::kernel_desc kernel;
+        kernel.sigma = floor.sigma;
+        kernel.radius = static_cast<int>(std::ceil(3.0f * floor.sigma));
+        REQUIRE(renderer.process(source.const_view(), gaussian.view(), 1.0f, kernel));
+        REQUIRE(renderer.resolve_pyramid(resolved.view(), floor.sigma));
+
+        double db = blur::cpu::psnr(gaussian.const_view(), resolved.const_view());
+        std::printf("  sigma %.0f: lod %.2f, %.1f dB\n", floor.sigma, blur::pyramid_lod(floor.sigma), db);
+        if (!CHECK(db >= floor.min_db)) std::fprintf(stderr, "  sigma %.0f below %.1f dB\n", floor.sigma, floor.min_db);
+    }
+
+    // Sigma 0 resolves level 0, the source itself.
+    REQUIRE(renderer.resolve_pyramid(resolved.view(), 0.0f));
+    CHECK(resolved.pixels == source.pixels);
+}
@@ -0,0 +1,152 @@
+#include "check.hpp"
+#include "scene.hpp"
+
+#include "blur_device_cache.hpp"
+
+namespace {
+
+    // Builds one vertex shader per device, so the fake's log shows every create and destroy.
+    struct shader_builder {
+        using device = ID3D11Device;
+        using value = ID3D11VertexShader*;
+
+        bool fail = false;
+        int created = 0;
+        int destroyed = 0;
+
+        bool create(ID3D11Device* key, ID3D11VertexShader*& out) {
+            if (fail) return false;
+            created++;
+            return SUCCEEDED(key->CreateVertexShader("", 1, nullptr, &out));
+        }
+
+        void destroy(ID3D11VertexShader*& shader) {
+            if (!shader) return;
+            destroyed++;
+            shader->Release();
+            shader = nullptr;
+        }
+    };
+
+    using shader_cache = blur::device_cache<shader_builder>;
+
+}
+
+TEST(switching_devices_finds_the_cached_entry) {
+    fake::device a, b;
+    {
+        shader_cache cache;
+        ID3D11VertexShader** on_a = cache.acquire(&a, 0.0);
+        REQUIRE(on_a && *on_a);
+        cache.release(&a, 0.0);
+
+        ID3D11VertexShader** on_b = cache.acquire(&b, 1.0);
+        REQUIRE(on_b && *on_b && *on_b != *on_a);
+        cache.release(&b, 1.0);
+
+        CHECK(cache.acquire(&a, 2.0) == on_a);
+        cache.release(&a, 2.0);
+
+        CHECK_EQ(cache.stats().misses, uint64_t(2));
+        CHECK_EQ(cache.stats().hits, uint64_t(1));
+        CHECK_EQ(cache.stats().entries, size_t(2));
+        CHECK_EQ(cache.builder().created, 2);
+        CHECK_EQ(fake::log().alive(&a, "vertex shader"), 1L);
+        CHECK_EQ(fake::log().alive(&b, "vertex shader"), 1L);
+    }
+    CHECK_EQ(fake::log().alive(&a), 0L);
+    CHECK_EQ(fake::log().alive(&b), 0L);
+    CHECK_EQ(a.external_refs(), 1ul);
+    CHECK_EQ(b.external_refs(), 1ul);
+}
+
+TEST(evict_releases_the_device_once) {
+    fake::device a;
+    shader_cache cache;
+    ULONG before = a.external_refs();
+
+    REQUIRE(cache.acquire(&a, 0.0));
+    CHECK_EQ(a.external_refs(), before + 1);
+    CHECK(!cache.evict(&a));
+    CHECK_EQ(a.external_refs(), before + 1);
+
+    cache.release(&a, 0.0);
+    CHECK(cache.evict(&a));
+    CHECK_EQ(a.external_refs(), before);
+    CHECK(cache.evict(&a));
+    CHECK_EQ(a.external_refs(), before);
+
+    CHECK_EQ(cache.stats().evictions, uint64_t(1));
+    CHECK_EQ(cache.builder().destroyed, 1);
+    CHECK_EQ(fake::log().alive(&a), 0L);
+}
+
+TEST(trim_releases_idle_devices_once) {
+    fake::device a, b;
+    shader_cache cache;
+    cache.set_idle_timeout(5.0);
+    ULONG before = a.external_refs();
+
+    REQUIRE(cache.acquire(&a, 0.0));
+    REQUIRE(cache.acquire(&b, 0.0));
+    cache.release(&a, 10.0);
+
+    cache.trim(14.0);
+    CHECK_EQ(a.external_refs(), before + 1);
+    cache.trim(15.5);
+    CHECK_EQ(a.external_refs(), before);
+    cache.trim(100.0);
+    CHECK_EQ(a.external_refs(), before);
+
+    // b is still in use, however long ago it was acquired.
+    CHECK_EQ(b.external_refs(), before + 1);
+    CHECK_EQ(cache.stats().evictions, uint64_t(1));
+    CHECK_EQ(cache.stats().entries, size_t(1));
+    cache.release(&b, 100.0);
+}
+
+TEST(failed_create_caches_nothing) {
+    fake::device a;
+    shader_cache cache;
+    cache.builder().fail = true;
+
+    CHECK(!cache.acquire(&a, 0.0));
+    CHECK_EQ(a.external_refs(), 1ul);
+    CHECK_EQ(cache.stats().entries, size_t(0));
+    CHECK_EQ(cache.users(&a), 0);
+
+    cache.builder().fail = false;
+    CHECK(cache.acquire(&a, 1.0));
+    CHECK_EQ(cache.stats().misses, uint64_t(2));
+    cache.release(&a, 1.0);
+}
+
+TEST(renderer_switching_back_creates_no_pipeline) {
+    fake::device* b = new fake::device();
+    {
+        fake::scene s(1, [](blur::blur_params& p, int) { p.live = true; });
+        fake::device* a = s.device;
+        s.renderer.reset_pipeline_stats();
+        s.run(30);
+        s.device = b;
+        s.run(30);
+
+        fake::log().reset_counts();
+        s.device = a;
+        s.run(30);
+        s.device = b;
+        s.run(30);
+
+        CHECK_EQ(fake::log().call("D3DCompile"), 0L);
+        for (const char* kind : { "vertex shader", "pixel shader", "compute shader", "input layout", "blend state",
+                 "sampler state", "rasterizer state" }) {
+            if (!CHECK_EQ(fake::log().created[kind], 0L)) std::fprintf(stderr, "  %s\n", kind);
+        }
+        CHECK_EQ(s.renderer.pipeline_stats().misses, uint64_t(2));
+        CHECK_EQ(s.renderer.pipeline_stats().hits, uint64_t(2));
+        CHECK_EQ(s.renderer.pipeline_stats().entries, size_t(2));
+    }
+    CHECK_EQ(fake::log().alive(b), 0L);
+    CHECK_EQ(b->external_refs(), 1ul);
+    b->Release();
+}
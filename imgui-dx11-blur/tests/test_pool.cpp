@@ -0,0 +1,189 @@
+#include "check.hpp"
+
+#include "blur_pool.hpp"
+
+#include <vector>
+
+namespace {
+
+    // Hands out increasing ids and records what it was asked for; fail_next makes the next create fail.
+    struct stub_allocator {
+        using resource = int;
+
+        struct created_texture {
+            int id;
+            int width;
+            int height;
+            unsigned bind_flags;
+        };
+
+        std::vector<created_texture>* created = nullptr;
+        std::vector<int>* destroyed = nullptr;
+        bool* fail_next = nullptr;
+        int next_id = 1;
+
+        bool create(int width, int height, unsigned bind_flags, resource& out) {
+            if (fail_next && *fail_next) {
+                *fail_next = false;
+                return false;
+            }
+            out = next_id++;
+            created->push_back({ out, width, height, bind_flags });
+            return true;
+        }
+
+        void destroy(resource& value) {
+            if (value != 0) destroyed->push_back(value);
+            value = 0;
+        }
+
+        bool same(const resource& a, const resource& b) const { return a == b; }
+    };
+
+    struct pool_fixture {
+        std::vector<stub_allocator::created_texture> created;
+        std::vector<int> destroyed;
+        bool fail_next = false;
+        blur::texture_pool<stub_allocator> pool;
+
+        pool_fixture() : pool(make_allocator()) {}
+
+        stub_allocator make_allocator() {
+            stub_allocator allocator;
+            allocator.created = &created;
+            allocator.destroyed = &destroyed;
+            allocator.fail_next = &fail_next;
+            return allocator;
+        }
+    };
+
+}
+
+TEST(bucket_sizes_round_up_in_quarter_octaves) {
+    CHECK_EQ(blur::pool_bucket_size(0), 0);
+    CHECK_EQ(blur::pool_bucket_size(1), 16);
+    CHECK_EQ(blur::pool_bucket_size(16), 16);
+    CHECK_EQ(blur::pool_bucket_size(17), 32);
+    CHECK_EQ(blur::pool_bucket_size(400), 448);
+    CHECK_EQ(blur::pool_bucket_size(448), 448);
+    CHECK_EQ(blur::pool_bucket_size(449), 512);
+    CHECK_EQ(blur::pool_bucket_size(1792), 1792);
+    CHECK_EQ(blur::pool_bucket_size(1793), 2048);
+
+    for (int size = 1; size <= 5000; size++) {
+        int bucket = blur::pool_bucket_size(size);
+        if (!CHECK(bucket >= size && bucket % 16 == 0 && bucket - size < bucket / 4 + 16)) std::fprintf(stderr, "  size %d\n", size);
+    }
+}
+
+TEST(acquire_counts_hits_and_misses) {
+    pool_fixture f;
+    int a = 0, b = 0, c = 0;
+    REQUIRE(f.pool.acquire(400, 300, 1, a));
+    REQUIRE(f.pool.acquire(400, 300, 1, b));
+    CHECK(a != b);
+    CHECK_EQ(f.pool.stats().misses, uint64_t(2));
+    CHECK_EQ(f.pool.stats().in_use, size_t(2));
+    CHECK_EQ(f.created[0].width, 448);
+    CHECK_EQ(f.created[0].height, 320);
+
+    f.pool.release(a, 1.0);
+    CHECK_EQ(f.pool.stats().idle, size_t(1));
+
+    // Other bind flags do not share textures.
+    REQUIRE(f.pool.acquire(400, 300, 3, c));
+    CHECK(c != a);
+    CHECK_EQ(f.pool.stats().misses, uint64_t(3));
+
+    REQUIRE(f.pool.acquire(400, 300, 1, c));
+    CHECK_EQ(c, a);
+    CHECK_EQ(f.pool.stats().hits, uint64_t(1));
+    CHECK_EQ(f.pool.stats().in_use, size_t(3));
+    CHECK_EQ(f.pool.stats().idle, size_t(0));
+
+    // Releasing something the pool did not hand out, or twice, changes nothing.
+    f.pool.release(99, 2.0);
+    f.pool.release(b, 2.0);
+    f.pool.release(b, 2.0);
+    CHECK_EQ(f.pool.stats().in_use, size_t(2));
+    CHECK_EQ(f.pool.stats().idle, size_t(1));
+
+    f.pool.reset_stats();
+    CHECK_EQ(f.pool.stats().hits + f.pool.stats().misses + f.pool.stats().evictions, uint64_t(0));
+    CHECK_EQ(f.pool.stats().in_use, size_t(2));
+}
+
+// A window dragged a few pixels at a time keeps reusing its texture while it stays within one bucket.
+TEST(resizes_within_a_bucket_reuse_the_texture) {
+    pool_fixture f;
+    int texture = 0;
+    REQUIRE(f.pool.acquire(400, 300, 1, texture));
+    int first = texture;
+
+    double time = 0.0;
+    for (int width = 401; width <= 448; width++) {
+        f.pool.release(texture, time);
+        REQUIRE(f.pool.acquire(width, 300 + (width - 400) / 3, 1, texture));
+        CHECK_EQ(texture, first);
+        time += 1.0 / 60.0;
+    }
+    CHECK_EQ(f.created.size(), size_t(1));
+    CHECK_EQ(f.pool.stats().hits, uint64_t(48));
+
+    // Past the bucket a new texture is made and the old one waits for trim.
+    f.pool.release(texture, time);
+    REQUIRE(f.pool.acquire(449, 300, 1, texture));
+    CHECK(texture != first);
+    CHECK_EQ(f.created.back().width, 512);
+    CHECK_EQ(f.pool.stats().idle, size_t(1));
+}
+
+TEST(trim_evicts_after_the_idle_timeout) {
+    pool_fixture f;
+    f.pool.set_idle_timeout(2.0);
+    int a = 0, b = 0, c = 0;
+    REQUIRE(f.pool.acquire(100, 100, 1, a));
+    REQUIRE(f.pool.acquire(200, 200, 1, b));
+    REQUIRE(f.pool.acquire(300, 300, 1, c));
+    f.pool.release(a, 10.0);
+    f.pool.release(b, 11.0);
+
+    f.pool.trim(12.0);
+    CHECK_EQ(f.pool.stats().evictions, uint64_t(0));
+
+    // Exactly at the timeout is still kept.
+    f.pool.trim(13.0);
+    CHECK(f.destroyed == std::vector<int>({ a }));
+    CHECK_EQ(f.pool.stats().evictions, uint64_t(1));
+    CHECK_EQ(f.pool.stats().idle, size_t(1));
+
+    // Textures in use are never trimmed.
+    f.pool.trim(100.0);
+    CHECK(f.destroyed == std::vector<int>({ a, b }));
+    CHECK_EQ(f.pool.stats().evictions, uint64_t(2));
+    CHECK_EQ(f.pool.stats().idle, size_t(0));
+    CHECK_EQ(f.pool.stats().in_use, size_t(1));
+
+    // An evicted size is a miss again.
+    int d = 0;
+    REQUIRE(f.pool.acquire(100, 100, 1, d));
+    CHECK(d != a);
+    CHECK_EQ(f.pool.stats().misses, uint64_t(4));
+}
+
+TEST(failed_create_and_clear) {
+    pool_fixture f;
+    int a = 0, b = 0;
+    f.fail_next = true;
+    CHECK(!f.pool.acquire(100, 100, 1, a));
+    CHECK_EQ(f.pool.stats().misses, uint64_t(1));
+    CHECK_EQ(f.pool.stats().in_use, size_t(0));
+
+    REQUIRE(f.pool.acquire(100, 100, 1, a));
+    REQUIRE(f.pool.acquire(100, 100, 1, b));
+    f.pool.release(b, 0.0);
+    f.pool.clear();
+    CHECK_EQ(f.destroyed.size(), size_t(2));
+    CHECK_EQ(f.pool.stats().in_use, size_t(0));
+    CHECK_EQ(f.pool.stats().idle, size_t(0));
+}
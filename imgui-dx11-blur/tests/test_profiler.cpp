@@ -0,0 +1,124 @@
+#include "check.hpp"
+
+#include "blur_profiler.hpp"
+
+#include <thread>
+
+namespace {
+
+    using blur::stats::cpu_timer;
+    using blur::stats::counter;
+
+    // Every word holds the same value, so a copy torn by the writer shows up as a mismatch.
+    struct record {
+        uint64_t words[16];
+
+        explicit record(uint64_t value = 0) {
+            for (uint64_t& word : words) word = value;
+        }
+
+        bool whole() const {
+            for (uint64_t word : words) {
+                if (word != words[0]) return false;
+            }
+            return true;
+        }
+    };
+
+    blur::stats::cpu_frame frame_with(cpu_timer timer, double ms) {
+        blur::stats::cpu_frame frame;
+        frame.timer_ms[static_cast<int>(timer)] = ms;
+        return frame;
+    }
+
+}
+
+TEST(read_recent_returns_newest_first) {
+    blur::stats::frame_ring<record, 8> ring;
+    record out[8];
+    CHECK_EQ(ring.read_recent(out, 8), size_t(0));
+
+    for (uint64_t i = 1; i <= 5; i++) ring.push(record(i));
+    REQUIRE(ring.read_recent(out, 8) == 5);
+    for (uint64_t i = 0; i < 5; i++) CHECK_EQ(out[i].words[0], 5 - i);
+    REQUIRE(ring.read_recent(out, 2) == 2);
+    CHECK_EQ(out[1].words[0], uint64_t(4));
+}
+
+TEST(read_recent_after_wrapping_keeps_the_last_capacity) {
+    blur::stats::frame_ring<record, 8> ring;
+    record out[16];
+    for (uint64_t i = 1; i <= 8 * 3 + 5; i++) {
+        ring.push(record(i));
+        size_t count = ring.read_recent(out, 16);
+        REQUIRE(count == std::min<size_t>(i, 8));
+        for (size_t n = 0; n < count; n++) CHECK_EQ(out[n].words[0], i - n);
+    }
+    CHECK_EQ(ring.pushed(), uint64_t(29));
+}
+
+// A reader racing the writer gets consecutive whole values, newest first, however far behind it falls.
+TEST(read_recent_never_tears_under_a_writer) {
+    blur::stats::frame_ring<record, 16> ring;
+    std::atomic<bool> done{ false };
+    std::thread writer([&] {
+        for (uint64_t i = 1; !done; i++) ring.push(record(i));
+    });
+
+    record out[16];
+    bool ok = true;
+    for (long read = 0; (read < 20000 || ring.pushed() < 100000) && ok; read++) {
+        size_t count = ring.read_recent(out, 16);
+        for (size_t n = 0; n < count && ok; n++) {
+            ok = CHECK(out[n].whole()) && (n == 0 || CHECK_EQ(out[n].words[0] + 1, out[n - 1].words[0]));
+        }
+    }
+    done = true;
+    writer.join();
+    CHECK_EQ(ring.read_recent(out, 16), size_t(16));
+}
+
+TEST(end_frame_pushes_and_counts_frames_over_budget) {
+    blur::stats::frame_profiler profiler;
+    profiler.set_budget(blur::stats::frame_budget().limit(counter::resources_created, 0).limit(counter::passes, 2));
+
+    profiler.count(counter::passes, 2);
+    profiler.end_frame(1);
+    profiler.count(counter::resources_created);
+    profiler.count(counter::passes, 3);
+    {
+        blur::stats::scoped_timer timer(profiler, cpu_timer::map);
+    }
+    profiler.end_frame(2);
+
+    blur::stats::cpu_frame frames[4];
+    REQUIRE(profiler.recent(frames, 4) == 2);
+    CHECK_EQ(frames[0].frame, uint64_t(1));
+    CHECK_EQ(frames[0].over_budget, (1u << static_cast<int>(counter::resources_created)) | (1u << static_cast<int>(counter::passes)));
+    CHECK_EQ(frames[0].timer_calls[static_cast<int>(cpu_timer::map)], 1);
+    CHECK_EQ(frames[1].over_budget, 0u);
+    CHECK_EQ(profiler.frames_over_budget(), uint64_t(1));
+    CHECK_EQ(profiler.current().frame, uint64_t(2));
+    CHECK_EQ(profiler.current().counters[static_cast<int>(counter::passes)], uint64_t(0));
+
+    profiler.set_budget(blur::stats::frame_budget());
+    CHECK_EQ(profiler.frames_over_budget(), uint64_t(0));
+}
+
+// Nearest rank: of 200 frames the 198th smallest, of 50 the largest. Frames a timer did not run in count as 0.
+TEST(summarize_uses_nearest_rank_p99) {
+    blur::stats::cpu_frame frames[200];
+    for (int i = 0; i < 200; i++) frames[i] = frame_with(cpu_timer::blur, 200 - i);
+
+    blur::stats::summary s = blur::stats::summarize(frames, 200, cpu_timer::blur);
+    CHECK_EQ(s.samples, 200);
+    CHECK_EQ(s.p99_ms, 198.0);
+    CHECK_EQ(s.min_ms, 1.0);
+    CHECK_EQ(s.avg_ms, 100.5);
+    CHECK_EQ(s.last_ms, 200.0);
+    CHECK_EQ(blur::stats::summarize(frames + 150, 50, cpu_timer::blur).p99_ms, 50.0);
+
+    frames[3] = frame_with(cpu_timer::capture, 5.0);
+    CHECK_EQ(blur::stats::summarize(frames, 200, cpu_timer::blur).min_ms, 0.0);
+    CHECK_EQ(blur::stats::summarize(frames, 0, cpu_timer::blur).samples, 0);
+}
@@ -0,0 +1,219 @@
+#include "check.hpp"
+#include "scene.hpp"
+
+namespace {
+
+    using fake::configure_fn;
+    using fake::scene;
+
+    constexpr int settle_frames = 30;
+    constexpr int measured_frames = 120;
+
+    struct expectation {
+        const char* name;
+        int windows;
+        configure_fn configure;
+        long passes_per_frame;          // draws plus dispatches
+        long copies_per_frame;
+    };
+
+    void live(blur::blur_params& p, int) { p.live = true; }
+
+    // Whether the list draws a texture, which only the composite does.
+    bool composited(const ImDrawList* list) {
+        for (const ImDrawCmd& cmd : list->CmdBuffer) {
+            if (!cmd.UserCallback && cmd.TextureId) return true;
+        }
+        return false;
+    }
+
+    const expectation expectations[] = {
+        { "static gaussian", 1, nullptr, 0, 0 },
+        { "live gaussian", 1, live, 2, 1 },
+        { "live gaussian, 3 windows", 3, live, 6, 3 },
+        { "live dual kawase", 1, [](blur::blur_params& p, int) { p.live = true; p.mode = blur::blur_mode::dual_kawase; }, 4, 1 },
+        { "live downsample 2", 1, [](blur::blur_params& p, int) { p.live = true; p.downsample = 2; }, 3, 1 },
+        { "live compute", 1, [](blur::blur_params& p, int) { p.live = true; p.use_compute = true; }, 1, 1 },
+        { "shared backdrop", 2, [](blur::blur_params& p, int) { p.live = true; p.shared_backdrop = true; }, 2, 1 },
+    };
+
+}
+
+TEST(steady_state_creates_nothing) {
+    for (const expectation& e : expectations) {
+        scene s(e.windows, e.configure);
+        s.run(settle_frames);
+
+        fake::log().reset_counts();
+        s.run(measured_frames);
+        std::printf("  %-26s %ld passes, %ld copies in %d frames\n", e.name, fake::log().draws() + fake::log().call("Dispatch"),
+            fake::log().copies(), measured_frames);
+
+        if (!CHECK_EQ(fake::log().creates(), 0L)) std::fprintf(stderr, "  in %s\n", e.name);
+        if (!CHECK_EQ(fake::log().draws() + fake::log().call("Dispatch"), e.passes_per_frame * measured_frames)) std::fprintf(stderr, "  in %s\n", e.name);
+        if (!CHECK_EQ(fake::log().copies(), e.copies_per_frame * measured_frames)) std::fprintf(stderr, "  in %s\n", e.name);
+
+        s.build();
+        for (ImDrawList* list : s.windows) {
+            if (!CHECK(composited(list))) std::fprintf(stderr, "  in %s\n", e.name);
+        }
+        fake::render_frame();
+    }
+}
+
+TEST(profiler_counts_what_the_device_sees) {
+    scene s(2, live);
+    s.run(settle_frames);
+
+    fake::log().reset_counts();
+    s.run(measured_frames);
+    long device_calls = 0;
+    for (const auto& entry : fake::log().calls) {
+        if (entry.first != "D3DCompile") device_calls += entry.second;
+    }
+    long passes = fake::log().draws() + fake::log().call("Dispatch");
+    long copies = fake::log().copies();
+
+    // The next frame's first render() closes the last measured frame before it issues any call.
+    s.build();
+
+    blur::stats::cpu_frame frames[blur::stats::profiler_frames];
+    size_t count = s.renderer.profiler().recent(frames, measured_frames);
+    REQUIRE(count == static_cast<size_t>(measured_frames));
+
+    uint64_t totals[blur::stats::counter_count] = {};
+    for (size_t i = 0; i < count; i++) {
+        for (int c = 0; c < blur::stats::counter_count; c++) totals[c] += frames[i].counters[c];
+    }
+    CHECK_EQ(totals[static_cast<int>(blur::stats::counter::d3d_calls)], static_cast<uint64_t>(device_calls));
+    CHECK_EQ(totals[static_cast<int>(blur::stats::counter::passes)], static_cast<uint64_t>(passes));
+    CHECK_EQ(totals[static_cast<int>(blur::stats::counter::captures)], static_cast<uint64_t>(copies));
+    CHECK_EQ(totals[static_cast<int>(blur::stats::counter::resources_created)], uint64_t(0));
+    fake::render_frame();
+}
+
+TEST(resize_goes_over_a_zero_creation_budget) {
+    scene s(1, live);
+    s.run(settle_frames);
+    s.renderer.set_frame_budget(blur::stats::frame_budget().limit(blur::stats::counter::resources_created, 0));
+
+    s.run(measured_frames);
+    CHECK_EQ(s.renderer.profiler().frames_over_budget(), 0ull);
+
+    s.configure = [](blur::blur_params& p, int) { p.live = true; p.window_size = ImVec2(900.0f, 600.0f); };
+    s.run(10);
+    CHECK(s.renderer.profiler().frames_over_budget() > 0);
+}
+
+TEST(release_device_frees_every_object) {
+    for (const expectation& e : expectations) {
+        fake::device* device = nullptr;
+        {
+            scene s(e.windows, e.configure);
+            device = s.device;
+            device->AddRef();
+            s.run(settle_frames);
+            CHECK(fake::log().alive(device) > 0);
+        }
+        if (!CHECK_EQ(fake::log().alive(device), 0L)) std::fprintf(stderr, "  in %s\n", e.name);
+        CHECK_EQ(device->external_refs(), 1ul);
+        device->Release();
+    }
+    CHECK_EQ(fake::log().alive(), 0L);
+}
+
+// With a header from tools/bake_shaders.sh --strict, as CI builds, every shader is embedded and D3DCompile never runs.
+TEST(precompiled_shaders_skip_the_compiler) {
+    fake::log().reset_counts();
+    {
+        scene s(2, [](blur::blur_params& p, int index) {
+            p.live = true;
+            p.use_compute = index == 1;
+        });
+        s.run(5);
+    }
+#ifdef BLUR_HAS_PRECOMPILED_SHADERS
+    for (int id = 0; id < static_cast<int>(blur::shader_id::count); id++) {
+        if (!CHECK(blur::precompiled_shader(static_cast<blur::shader_id>(id)).size > 0)) {
+            std::fprintf(stderr, "  %s has no bytecode\n", blur::shader_sources[id].name);
+        }
+    }
+    CHECK_EQ(fake::log().call("D3DCompile"), 0L);
+#else
+    CHECK(blur::precompiled_shader(blur::shader_id::vertex).size == 0);
+    CHECK(fake::log().call("D3DCompile") > 0);
+#endif
+}
+
+TEST(first_image_follows_the_enable_delay) {
+    scene s(1, nullptr, false);
+    blur::blur_params p = s.params(0);
+
+    // Nothing is captured before delay_time has passed; the composite appears once the capture was blurred.
+    int frames = 0;
+    while (s.renderer.last_frame_counters().captures == 0 && frames < 60) {
+        s.frame();
+        frames++;
+    }
+    CHECK(frames >= static_cast<int>(p.delay_time * 60.0));
+    CHECK(frames < 60);
+}
+
+// Each window's blur runs in its own draw list ahead of its composite, so the composite shows this frame's backdrop.
+TEST(live_windows_blur_before_their_composite) {
+    scene s(3, live);
+    s.run(settle_frames);
+    s.build();
+
+    CHECK(fake::imgui().foreground.CmdBuffer.empty());
+    for (ImDrawList* list : s.windows) {
+        int callbacks = 0;
+        bool composited = false;
+        for (const ImDrawCmd& cmd : list->CmdBuffer) {
+            if (cmd.UserCallback) {
+                if (cmd.UserCallback != ImDrawCallback_ResetRenderState) callbacks++;
+            }
+            else if (cmd.TextureId) {
+                composited = callbacks >= 2;
+                break;
+            }
+        }
+        CHECK(composited);
+    }
+    fake::render_frame();
+}
+
+TEST(failed_passes_hide_the_region_until_reblurred) {
+    for (bool live_mode : { false, true }) {
+        scene s(1, live_mode ? live : nullptr);
+        s.run(settle_frames);
+
+        // A live region is recaptured and fails this frame; a static one was blurred long ago and keeps its image.
+        fake::log().fail_map = true;
+        s.run(2);
+        s.build();
+        CHECK_EQ(composited(s.windows[0]), !live_mode);
+        fake::render_frame();
+
+        fake::log().fail_map = false;
+        s.run(2);
+        s.build();
+        CHECK(composited(s.windows[0]));
+        fake::render_frame();
+    }
+}
+
+TEST(first_blur_failing_is_retried) {
+    fake::log().fail_map = true;
+    scene s(1);
+    s.run(settle_frames);
+    s.build();
+    CHECK(!composited(s.windows[0]));
+    fake::render_frame();
+
+    fake::log().fail_map = false;
+    s.run(2);
+    s.build();
+    CHECK(composited(s.windows[0]));
+    fake::render_frame();
+}
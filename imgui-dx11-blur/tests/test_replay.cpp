@@ -0,0 +1,120 @@
+#include "check.hpp"
+#include "fake_d3d11.hpp"
+
+#include "blur.hpp"
+
+#include <cstdio>
+
+namespace {
+
+    // ImGui_ImplDX11_RenderDrawData without the drawing: user callbacks run in list order and ResetRenderState
+    // only tells the backend to set its state up again.
+    void replay(ImDrawData* data) {
+        for (int n = 0; n < data->CmdListsCount; n++) {
+            const ImDrawList* list = data->CmdLists[n];
+            for (int i = 0; i < list->CmdBuffer.Size; i++) {
+                const ImDrawCmd& cmd = list->CmdBuffer[i];
+                if (cmd.UserCallback && cmd.UserCallback != ImDrawCallback_ResetRenderState) cmd.UserCallback(list, &cmd);
+            }
+        }
+    }
+
+    // A real ImGui context on the fake device, with two overlapping blurred windows drawing text over the blur.
+    struct app {
+        ImGuiContext* context = ImGui::CreateContext();
+        fake::device* device = new fake::device();
+        blur::blur_renderer renderer;
+
+        app() {
+            ImGuiIO& io = ImGui::GetIO();
+            io.DisplaySize = ImVec2(1280.0f, 720.0f);
+            io.DeltaTime = 1.0f / 60.0f;
+            io.IniFilename = nullptr;
+            // Without a title bar or border nothing is drawn before the blur, as in main.cpp.
+            ImGui::GetStyle().WindowBorderSize = 0.0f;
+            unsigned char* pixels = nullptr;
+            int width = 0, height = 0;
+            io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+        }
+
+        ~app() {
+            renderer.release_device(device);
+            device->Release();
+            ImGui::DestroyContext(context);
+        }
+
+        // ImGui::NewFrame up to ImGui::Render; replay() then stands in for the backend.
+        void build() {
+            ImGui::NewFrame();
+            for (int i = 0; i < 2; i++) {
+                char name[16];
+                std::snprintf(name, sizeof(name), "blurred %d", i);
+                ImGui::SetNextWindowPos(ImVec2(100.0f + 80.0f * i, 100.0f + 60.0f * i));
+                ImGui::SetNextWindowSize(ImVec2(300.0f, 200.0f));
+                ImGui::Begin(name, nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoBackground);
+
+                blur::blur_params params;
+                params.device = device;
+                params.draw_list = ImGui::GetWindowDrawList();
+                params.window_pos = ImGui::GetWindowPos();
+                params.window_size = ImGui::GetWindowSize();
+                params.live = true;
+                renderer.render(params, true);
+
+                ImGui::Text("frame %d", ImGui::GetFrameCount());
+                ImGui::End();
+            }
+            ImGui::Render();
+        }
+
+        void run(int frames) {
+            for (int i = 0; i < frames; i++) {
+                build();
+                replay(ImGui::GetDrawData());
+            }
+        }
+    };
+
+}
+
+TEST(replayed_frames_settle_without_creating) {
+    app a;
+    a.run(30);
+
+    fake::log().reset_counts();
+    a.run(60);
+    CHECK_EQ(fake::log().creates(), 0L);
+    CHECK_EQ(fake::log().copies(), 2L * 60);
+    CHECK_EQ(fake::log().draws(), 2L * 2 * 60);
+}
+
+// The windows' lists are the only ones with blur callbacks, and in each the capture and the blur come before the
+// first thing ImGui draws, the composite.
+TEST(each_window_blurs_before_drawing) {
+    app a;
+    a.run(30);
+    a.build();
+
+    ImDrawData* data = ImGui::GetDrawData();
+    int blurred_lists = 0;
+    for (int n = 0; n < data->CmdListsCount; n++) {
+        const ImDrawList* list = data->CmdLists[n];
+        int callbacks = 0;
+        bool drawn_after_blur = false;
+        for (int i = 0; i < list->CmdBuffer.Size; i++) {
+            const ImDrawCmd& cmd = list->CmdBuffer[i];
+            if (cmd.UserCallback) {
+                if (cmd.UserCallback != ImDrawCallback_ResetRenderState) callbacks++;
+            }
+            else if (cmd.ElemCount > 0) {
+                drawn_after_blur = callbacks >= 2;
+                break;
+            }
+        }
+        if (callbacks == 0) continue;
+        blurred_lists++;
+        CHECK(drawn_after_blur);
+    }
+    CHECK_EQ(blurred_lists, 2);
+    replay(data);
+}
@@ -0,0 +1,146 @@
+#include "check.hpp"
+
+#include "blur_schedule.hpp"
+
+// A frame loop at 60 Hz; time is only ever what the test passes in.
+namespace {
+
+    struct fake_clock {
+        double time = 100.0;
+        double advance() { return time += 1.0 / 60.0; }
+    };
+
+}
+
+TEST(capture_waits_for_the_delay_then_captures_once) {
+    blur::capture_schedule schedule;
+    fake_clock clock;
+
+    CHECK(!schedule.begin_frame(false, clock.time, 0.0));
+    CHECK(!schedule.has_image());
+
+    // Enabled with a 0.09 s delay: the capture is queued 6 frames later, at 0.1 s.
+    CHECK(!schedule.begin_frame(true, clock.time, 0.09));
+    int frames = 0;
+    while (!schedule.begin_frame(true, clock.advance(), 0.09)) frames++;
+    CHECK_EQ(frames, 5);
+    CHECK(schedule.scheduled());
+    CHECK(schedule.has_image());
+
+    schedule.on_capture(true);
+    CHECK(schedule.captured());
+    for (int i = 0; i < 10; i++) CHECK(!schedule.begin_frame(true, clock.advance(), 0.09));
+    CHECK(schedule.has_image());
+}
+
+TEST(first_frame_captures_without_a_delay) {
+    blur::capture_schedule schedule;
+    fake_clock clock;
+    CHECK(schedule.begin_frame(true, clock.time, 0.0));
+    CHECK(schedule.has_image());
+    schedule.on_capture(true);
+    CHECK(!schedule.begin_frame(true, clock.advance(), 0.0));
+}
+
+TEST(unrun_capture_is_requeued_and_failed_one_waits) {
+    blur::capture_schedule schedule;
+    fake_clock clock;
+    REQUIRE(schedule.begin_frame(true, clock.time, 0.0));
+
+    // The draw list was not rendered: the callback never ran, so the next frame queues it again.
+    CHECK(schedule.begin_frame(true, clock.advance(), 0.0));
+
+    // A failed capture leaves nothing to draw and, as before the callback existed, is not retried by itself;
+    // blur_renderer invalidates the schedule when it wants another try.
+    schedule.on_capture(false);
+    CHECK(!schedule.captured());
+    CHECK(!schedule.has_image());
+    CHECK(!schedule.begin_frame(true, clock.advance(), 0.0));
+    schedule.invalidate();
+    CHECK(schedule.begin_frame(true, clock.advance(), 0.0));
+    schedule.on_capture(true);
+    CHECK(schedule.captured());
+}
+
+TEST(disable_invalidate_and_refresh) {
+    blur::capture_schedule schedule;
+    fake_clock clock;
+    CHECK(!schedule.refresh());
+    CHECK(!schedule.begin_frame(true, clock.time, 0.04));
+    while (!schedule.begin_frame(true, clock.advance(), 0.04)) {}
+    schedule.on_capture(true);
+
+    // Live refreshes go through scheduled_, one at a time, and keep the old image on failure.
+    CHECK(!schedule.begin_frame(true, clock.advance(), 0.04));
+    CHECK(schedule.refresh());
+    CHECK(!schedule.refresh());
+    schedule.on_capture(false);
+    CHECK(schedule.captured());
+    CHECK(schedule.has_image());
+
+    // Invalidating recaptures on the next frame without waiting for the delay again.
+    schedule.invalidate();
+    CHECK(!schedule.has_image());
+    CHECK(schedule.begin_frame(true, clock.advance(), 0.04));
+    schedule.on_capture(true);
+
+    // Disabling forgets the capture; enabling again restarts the delay from that frame.
+    CHECK(!schedule.begin_frame(false, clock.advance(), 0.04));
+    CHECK(!schedule.has_image());
+    CHECK(!schedule.captured());
+    CHECK(!schedule.begin_frame(true, clock.advance(), 0.04));
+    CHECK(!schedule.begin_frame(true, clock.advance(), 0.04));
+    CHECK(!schedule.begin_frame(true, clock.advance(), 0.04));
+    CHECK(schedule.begin_frame(true, clock.advance(), 0.04));
+}
+
+TEST(refresh_interval_gates_frames) {
+    blur::refresh_policy policy;
+    int refreshes = 0;
+    for (int frame = 1; frame <= 30; frame++) {
+        bool refresh = policy.should_refresh(3, 0.0);
+        CHECK_EQ(refresh, frame % 3 == 0);
+        refreshes += refresh;
+    }
+    CHECK_EQ(refreshes, 10);
+    CHECK_EQ(policy.stats().refreshes, uint64_t(10));
+    CHECK_EQ(policy.stats().skipped_interval, uint64_t(20));
+    CHECK_EQ(policy.stats().skipped_budget, uint64_t(0));
+
+    // Intervals below 1 refresh every frame.
+    blur::refresh_policy every_frame;
+    for (int frame = 0; frame < 5; frame++) CHECK(every_frame.should_refresh(0, 0.0));
+}
+
+TEST(refresh_budget_spends_measured_cost) {
+    blur::refresh_policy policy;
+
+    // Until a cost is measured the budget does not hold refreshes back.
+    CHECK(policy.should_refresh(1, 1.0));
+    CHECK(policy.should_refresh(1, 1.0));
+
+    // A 3 ms blur on a 1 ms per frame budget runs every third frame.
+    policy.record_cost(3.0);
+    CHECK_EQ(policy.cost_ms(), 3.0);
+    policy.reset_stats();
+    int refreshes = 0;
+    for (int frame = 0; frame < 30; frame++) refreshes += policy.should_refresh(1, 1.0);
+    CHECK_EQ(refreshes, 10);
+    CHECK_EQ(policy.stats().skipped_budget, uint64_t(20));
+    CHECK_EQ(policy.stats().skipped_interval, uint64_t(0));
+
+    // A blur costing more than the budget still runs once the bucket is full at its cost.
+    policy.record_cost(19.0);
+    CHECK_EQ(policy.cost_ms(), 7.0);
+    policy.reset_stats();
+    for (int frame = 0; frame < 70; frame++) policy.should_refresh(1, 1.0);
+    CHECK_EQ(policy.stats().refreshes, uint64_t(10));
+
+    // Interval and budget together: the interval is checked first.
+    blur::refresh_policy both;
+    both.record_cost(2.0);
+    for (int frame = 0; frame < 12; frame++) both.should_refresh(4, 1.0);
+    CHECK_EQ(both.stats().refreshes, uint64_t(3));
+    CHECK_EQ(both.stats().skipped_interval, uint64_t(9));
+    CHECK_EQ(both.stats().skipped_budget, uint64_t(0));
+}
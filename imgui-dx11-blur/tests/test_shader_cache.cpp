@@ -0,0 +1,183 @@
+#include "check.hpp"
+
+#include "blur_shader_cache.hpp"
+
+namespace {
+
+    namespace fs = std::filesystem;
+
+    // A pack file in its own temporary directory, removed again at the end of the test.
+    struct temp_pack {
+        fs::path dir = fs::temp_directory_path() / "blur_test_shader_cache";
+        std::string path = (dir / "sub" / "shaders.bin").string();
+
+        temp_pack() { fs::remove_all(dir); }
+        ~temp_pack() { fs::remove_all(dir); }
+    };
+
+    std::vector<unsigned char> blob(size_t size, unsigned char value) { return std::vector<unsigned char>(size, value); }
+
+    bool holds(blur::shader_cache& cache, uint64_t key, const std::vector<unsigned char>& expected) {
+        blur::shader_bytecode bytecode = cache.find(key);
+        return bytecode.size == expected.size() && std::memcmp(bytecode.data, expected.data(), expected.size()) == 0;
+    }
+
+    // Header is 24 bytes and each entry record 24, followed by its blob padded to 8.
+    constexpr size_t header_bytes = 24;
+    constexpr size_t record_bytes = 24;
+
+}
+
+TEST(keys_separate_sources_entry_points_and_defines) {
+    uint64_t plain = blur::shader_cache_key("src", "main", "ps_5_0");
+    CHECK(plain != blur::shader_cache_key("src", "main", "ps_5_0", { { "RADIUS", "8" } }));
+    CHECK(plain != blur::shader_cache_key("sr", "cmain", "ps_5_0"));
+    CHECK(blur::shader_cache_key("s", "m", "t", { { "AB", "C" } }) != blur::shader_cache_key("s", "m", "t", { { "A", "BC" } }));
+}
+
+TEST(saved_pack_loads_back) {
+    temp_pack pack;
+    std::vector<unsigned char> a = blob(40, 1), b = blob(13, 2);
+    {
+        blur::shader_cache cache(pack.path);
+        CHECK(cache.load());
+        CHECK_EQ(cache.entry_count(), size_t(0));
+        cache.insert(1, a.data(), a.size());
+        cache.insert(2, b.data(), b.size());
+        REQUIRE(cache.save());
+        CHECK(!cache.dirty());
+    }
+
+    blur::shader_cache cache(pack.path);
+    REQUIRE(cache.load());
+    CHECK_EQ(cache.entry_count(), size_t(2));
+    CHECK_EQ(cache.size_bytes(), size_t(53));
+    CHECK(holds(cache, 1, a));
+    CHECK(holds(cache, 2, b));
+    CHECK(!cache.find(3).data);
+    CHECK_EQ(cache.stats().hits, uint64_t(2));
+    CHECK_EQ(cache.stats().misses, uint64_t(1));
+    CHECK(!fs::exists(pack.path + ".tmp"));
+}
+
+TEST(entry_with_a_bad_checksum_is_dropped) {
+    temp_pack pack;
+    std::vector<unsigned char> a = blob(40, 1), b = blob(40, 2);
+    {
+        blur::shader_cache cache(pack.path);
+        cache.insert(1, a.data(), a.size());
+        REQUIRE(cache.save());
+        cache.insert(2, b.data(), b.size());
+        REQUIRE(cache.save());
+    }
+
+    // Flip a byte in the first blob of the file, whichever key that is.
+    {
+        std::fstream file(pack.path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(header_bytes + record_bytes + 3);
+        file.put(77);
+    }
+
+    blur::shader_cache cache(pack.path);
+    REQUIRE(cache.load());
+    CHECK_EQ(cache.entry_count(), size_t(1));
+    CHECK_EQ(cache.stats().corrupt_entries, uint64_t(1));
+    CHECK(cache.dirty());
+    CHECK(holds(cache, 1, a) != holds(cache, 2, b));
+
+    // The next save writes the pack without it.
+    REQUIRE(cache.save());
+    blur::shader_cache reloaded(pack.path);
+    REQUIRE(reloaded.load());
+    CHECK_EQ(reloaded.entry_count(), size_t(1));
+    CHECK_EQ(reloaded.stats().corrupt_entries, uint64_t(0));
+}
+
+TEST(truncated_pack_keeps_the_entries_before_the_cut) {
+    temp_pack pack;
+    {
+        blur::shader_cache cache(pack.path);
+        for (uint64_t key = 1; key <= 3; key++) {
+            std::vector<unsigned char> data = blob(40, static_cast<unsigned char>(key));
+            cache.insert(key, data.data(), data.size());
+        }
+        REQUIRE(cache.save());
+    }
+
+    // Into the last blob: two entries survive.
+    fs::resize_file(pack.path, fs::file_size(pack.path) - 10);
+    {
+        blur::shader_cache cache(pack.path);
+        REQUIRE(cache.load());
+        CHECK_EQ(cache.entry_count(), size_t(2));
+        CHECK_EQ(cache.stats().corrupt_entries, uint64_t(1));
+    }
+
+    // Into the second record: one survives, and both entries after it are counted.
+    fs::resize_file(pack.path, header_bytes + record_bytes + 40 + 8);
+    {
+        blur::shader_cache cache(pack.path);
+        REQUIRE(cache.load());
+        CHECK_EQ(cache.entry_count(), size_t(1));
+        CHECK_EQ(cache.stats().corrupt_entries, uint64_t(2));
+    }
+
+    // Into the header: unusable, and nothing is loaded.
+    fs::resize_file(pack.path, header_bytes - 4);
+    blur::shader_cache cache(pack.path);
+    CHECK(!cache.load());
+    CHECK_EQ(cache.entry_count(), size_t(0));
+}
+
+TEST(unusable_header_fails_but_a_missing_file_does_not) {
+    temp_pack pack;
+    blur::shader_cache cache(pack.path);
+    CHECK(cache.load());
+
+    fs::create_directories(pack.dir / "sub");
+    {
+        std::ofstream file(pack.path, std::ios::binary);
+        file << "not a shader pack, just some text";
+    }
+    CHECK(!cache.load());
+    CHECK_EQ(cache.stats().corrupt_entries, uint64_t(1));
+}
+
+TEST(least_recently_used_entries_are_evicted_to_budget) {
+    temp_pack pack;
+    std::vector<unsigned char> a = blob(40, 1), b = blob(40, 2), c = blob(40, 3);
+    {
+        blur::shader_cache cache(pack.path, 100);
+        cache.insert(1, a.data(), a.size());
+        cache.insert(2, b.data(), b.size());
+        cache.find(1);
+        cache.insert(3, c.data(), c.size());
+
+        CHECK_EQ(cache.entry_count(), size_t(2));
+        CHECK_EQ(cache.stats().evictions, uint64_t(1));
+        CHECK(cache.size_bytes() <= cache.max_bytes());
+        CHECK(holds(cache, 1, a));
+        CHECK(!cache.find(2).data);
+
+        // A blob over the whole budget is not cached at all.
+        std::vector<unsigned char> big = blob(101, 4);
+        cache.insert(4, big.data(), big.size());
+        CHECK(!cache.find(4).data);
+        CHECK_EQ(cache.entry_count(), size_t(2));
+
+        // 3 was used after 1 by holds() above.
+        cache.find(3);
+        cache.set_max_bytes(50);
+        CHECK_EQ(cache.entry_count(), size_t(1));
+        CHECK(holds(cache, 3, c));
+        cache.set_max_bytes(100);
+        cache.insert(1, a.data(), a.size());
+        REQUIRE(cache.save());
+    }
+
+    // Use ticks are saved, so loading into a smaller budget evicts by them too.
+    blur::shader_cache cache(pack.path, 60);
+    REQUIRE(cache.load());
+    CHECK_EQ(cache.entry_count(), size_t(1));
+    CHECK(holds(cache, 1, a));
+}
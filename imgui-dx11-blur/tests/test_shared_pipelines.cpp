@@ -0,0 +1,117 @@
+#include "check.hpp"
+#include "fake_d3d11.hpp"
+#include "fake_imgui.hpp"
+
+#include "blur.hpp"
+
+#include <memory>
+
+namespace {
+
+    // count renderers on one device, each blurring its own window.
+    struct renderers {
+        fake::device* device = new fake::device();
+        std::vector<std::unique_ptr<blur::blur_renderer>> list;
+        std::vector<ImDrawList*> windows;
+
+        explicit renderers(int count) {
+            for (int i = 0; i < count; i++) {
+                list.emplace_back(new blur::blur_renderer());
+                windows.push_back(fake::add_window());
+            }
+        }
+
+        ~renderers() {
+            list.clear();
+            fake::remove_windows();
+            device->Release();
+        }
+
+        void run(int frames) {
+            for (int f = 0; f < frames; f++) {
+                fake::new_frame();
+                for (size_t i = 0; i < list.size(); i++) {
+                    blur::blur_params p{};
+                    p.device = device;
+                    p.draw_list = windows[i];
+                    p.window_pos = ImVec2(10.0f * i, 10.0f * i);
+                    p.window_size = ImVec2(100.0f, 100.0f);
+                    p.live = true;
+                    list[i]->render(p, true);
+                }
+                fake::render_frame();
+            }
+        }
+    };
+
+    struct pipeline_counts {
+        long compiles;
+        long shaders;
+        long states;
+    };
+
+    pipeline_counts created() {
+        fake::recorder& log = fake::log();
+        return { log.call("D3DCompile"), log.created["vertex shader"] + log.created["pixel shader"] + log.created["compute shader"],
+            log.created["input layout"] + log.created["blend state"] + log.created["sampler state"] + log.created["rasterizer state"] };
+    }
+
+}
+
+TEST(renderers_on_one_device_build_one_pipeline) {
+    fake::log().reset_counts();
+    pipeline_counts single;
+    {
+        renderers one(1);
+        one.run(5);
+        single = created();
+    }
+    REQUIRE(single.shaders > 0);
+
+    for (int count : { 2, 8, 32 }) {
+        fake::log().reset_counts();
+        renderers many(count);
+        many.list[0]->reset_pipeline_stats();
+        many.run(5);
+
+        pipeline_counts shared = created();
+        CHECK_EQ(shared.compiles, single.compiles);
+        CHECK_EQ(shared.shaders, single.shaders);
+        CHECK_EQ(shared.states, single.states);
+        CHECK_EQ(many.list[0]->pipeline_stats().misses, uint64_t(1));
+        CHECK_EQ(many.list[0]->pipeline_stats().hits, static_cast<uint64_t>(count - 1));
+    }
+}
+
+TEST(last_release_device_removes_the_entry) {
+    renderers many(4);
+    many.run(5);
+    REQUIRE(many.list[0]->pipeline_stats().entries == 1);
+
+    for (size_t i = 0; i + 1 < many.list.size(); i++) {
+        CHECK(!many.list[i]->release_device(many.device));
+        CHECK_EQ(many.list[i]->pipeline_stats().entries, size_t(1));
+        CHECK(fake::log().alive(many.device, "vertex shader") > 0);
+    }
+    CHECK(many.list.back()->release_device(many.device));
+    CHECK_EQ(many.list[0]->pipeline_stats().entries, size_t(0));
+    CHECK_EQ(fake::log().alive(many.device), 0L);
+    CHECK_EQ(many.device->external_refs(), 1ul);
+}
+
+TEST(shader_defines_keep_a_private_pipeline) {
+    renderers many(3);
+    many.list[2]->set_shader_defines({ { "SAMPLES", "9" } });
+    many.list[0]->reset_pipeline_stats();
+    many.run(5);
+
+    CHECK_EQ(many.list[0]->pipeline_stats().misses, uint64_t(1));
+    CHECK_EQ(many.list[0]->pipeline_stats().hits, uint64_t(1));
+    CHECK_EQ(many.list[2]->pipeline_stats().misses, uint64_t(1));
+    CHECK_EQ(many.list[2]->pipeline_stats().hits, uint64_t(0));
+
+    CHECK(many.list[2]->release_device(many.device));
+    CHECK(!many.list[0]->release_device(many.device));
+    CHECK(many.list[1]->release_device(many.device));
+    CHECK_EQ(fake::log().alive(many.device), 0L);
+}
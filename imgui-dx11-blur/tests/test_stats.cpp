@@ -0,0 +1,262 @@
+#include "check.hpp"
+
+#include "blur_stats.hpp"
+
+namespace {
+
+    using blur::stats::stage;
+
+    // A timestamp_ring source whose clock advances by one tick per timestamp. Slots read back only once marked
+    // ready, and a slot can be marked disjoint.
+    struct stub_source {
+        bool is_available = true;
+        uint64_t clock = 0;
+        uint64_t ticks[blur::stats::timestamp_frames][blur::stats::max_frame_timestamps] = {};
+        bool issued[blur::stats::timestamp_frames][blur::stats::max_frame_timestamps] = {};
+        bool ready[blur::stats::timestamp_frames] = {};
+        bool disjoint[blur::stats::timestamp_frames] = {};
+        int frames_begun = 0;
+        int frames_ended = 0;
+        int reads = 0;
+
+        bool available() const { return is_available; }
+
+        bool begin_frame(int slot) {
+            frames_begun++;
+            ready[slot] = false;
+            disjoint[slot] = false;
+            for (bool& value : issued[slot]) value = false;
+            return true;
+        }
+
+        bool timestamp(int slot, int index) {
+            ticks[slot][index] = ++clock;
+            issued[slot][index] = true;
+            return true;
+        }
+
+        void end_frame(int) { frames_ended++; }
+
+        bool read(int slot, int count, uint64_t* out, uint64_t& frequency, bool& is_disjoint) {
+            reads++;
+            if (!ready[slot]) return false;
+            for (int i = 0; i < count; i++) out[i] = ticks[slot][i];
+            frequency = 1000;
+            is_disjoint = disjoint[slot];
+            return true;
+        }
+
+        void finish_all() {
+            for (bool& value : ready) value = true;
+        }
+    };
+
+    using ring = blur::stats::timestamp_ring<stub_source>;
+
+    int slot_of(uint64_t frame) { return static_cast<int>(frame % blur::stats::timestamp_frames); }
+
+    // One range per stage given, each ticks long; consecutive ranges are one tick apart.
+    void record(ring& r, std::initializer_list<stage> stages, uint64_t ticks = 1) {
+        for (stage value : stages) {
+            int pair = r.begin(value);
+            r.source().clock += ticks - 1;
+            r.end(pair);
+        }
+    }
+
+}
+
+TEST(collect_sums_each_stage_in_milliseconds) {
+    ring r;
+    record(r, { stage::capture, stage::horizontal, stage::vertical, stage::horizontal }, 3);
+    r.next_frame();
+    r.source().finish_all();
+
+    blur::stats::frame_timing timing;
+    std::vector<blur::stats::gpu_range> ranges;
+    REQUIRE(r.collect(timing, &ranges));
+    CHECK_EQ(timing.frame, uint64_t(0));
+    CHECK_EQ(timing.runs[static_cast<int>(stage::horizontal)], 2);
+    CHECK_EQ(timing.stage_ms[static_cast<int>(stage::horizontal)], 6.0);
+    CHECK_EQ(timing.stage_ms[static_cast<int>(stage::capture)], 3.0);
+    CHECK_EQ(timing.total_ms, 12.0);
+    REQUIRE(ranges.size() == 4);
+    CHECK(ranges[1].kind == stage::horizontal && ranges[1].begin_ms == 4.0 && ranges[1].end_ms == 7.0);
+    CHECK_EQ(r.source().frames_begun, 1);
+    CHECK_EQ(r.source().frames_ended, 1);
+
+    CHECK(!r.collect(timing));
+}
+
+TEST(unavailable_source_times_nothing) {
+    ring r;
+    r.source().is_available = false;
+    CHECK_EQ(r.begin(stage::capture), -1);
+    r.end(-1);
+    r.next_frame();
+    blur::stats::frame_timing timing;
+    CHECK(!r.collect(timing));
+    CHECK_EQ(r.source().frames_begun, 0);
+}
+
+// Frames are read back oldest first without waiting; a slot still pending when the ring comes back to it is lost.
+TEST(slot_still_pending_is_dropped) {
+    ring r;
+    for (int frame = 0; frame < blur::stats::timestamp_frames; frame++) {
+        record(r, { stage::capture });
+        r.next_frame();
+        blur::stats::frame_timing timing;
+        CHECK(!r.collect(timing));
+    }
+    CHECK_EQ(r.dropped(), uint64_t(1));
+
+    // Frame 0 was dropped, so the oldest left is frame 1.
+    record(r, { stage::capture });
+    r.next_frame();
+    CHECK_EQ(r.dropped(), uint64_t(2));
+    r.source().finish_all();
+    blur::stats::frame_timing timing;
+    REQUIRE(r.collect(timing));
+    CHECK_EQ(timing.frame, uint64_t(2));
+    REQUIRE(r.collect(timing));
+    CHECK_EQ(timing.frame, uint64_t(3));
+    CHECK(!r.collect(timing));
+}
+
+// The oldest frame not being ready holds back newer ones that are.
+TEST(collect_reads_in_frame_order) {
+    ring r;
+    record(r, { stage::capture });
+    r.next_frame();
+    record(r, { stage::composite });
+    r.next_frame();
+    r.source().ready[slot_of(1)] = true;
+
+    blur::stats::frame_timing timing;
+    CHECK(!r.collect(timing));
+    r.source().ready[slot_of(0)] = true;
+    REQUIRE(r.collect(timing));
+    CHECK_EQ(timing.frame, uint64_t(0));
+    REQUIRE(r.collect(timing));
+    CHECK_EQ(timing.frame, uint64_t(1));
+}
+
+TEST(disjoint_frame_is_skipped) {
+    ring r;
+    record(r, { stage::capture });
+    r.next_frame();
+    record(r, { stage::kawase });
+    r.next_frame();
+    r.source().finish_all();
+    r.source().disjoint[slot_of(0)] = true;
+
+    blur::stats::frame_timing timing;
+    REQUIRE(r.collect(timing));
+    CHECK_EQ(timing.frame, uint64_t(1));
+    CHECK_EQ(timing.runs[static_cast<int>(stage::kawase)], 1);
+    CHECK_EQ(r.disjoint(), uint64_t(1));
+    CHECK(!r.collect(timing));
+}
+
+TEST(ranges_past_the_frame_capacity_overflow) {
+    const int max_pairs = blur::stats::max_frame_timestamps / 2;
+    ring r;
+    for (int i = 0; i < max_pairs; i++) CHECK(r.begin(stage::horizontal) >= 0);
+    CHECK_EQ(r.begin(stage::vertical), -1);
+    CHECK_EQ(r.begin(stage::vertical), -1);
+    CHECK_EQ(r.overflow(), uint64_t(2));
+    r.next_frame();
+    r.source().finish_all();
+
+    // The 128 that fit still end in next_frame() but, left open, are not reported.
+    CHECK(r.source().issued[0][blur::stats::max_frame_timestamps - 1]);
+    blur::stats::frame_timing timing;
+    REQUIRE(r.collect(timing));
+    CHECK_EQ(timing.runs[static_cast<int>(stage::horizontal)], 0);
+
+    for (int i = 0; i < max_pairs; i++) r.end(r.begin(stage::horizontal));
+    r.next_frame();
+    r.source().finish_all();
+    REQUIRE(r.collect(timing));
+    CHECK_EQ(timing.runs[static_cast<int>(stage::horizontal)], max_pairs);
+    CHECK_EQ(r.overflow(), uint64_t(2));
+}
+
+// A range that is never ended gets its end timestamp in next_frame(), so the frame's queries are complete, but no time.
+TEST(ranges_never_ended_are_not_reported) {
+    ring r;
+    r.begin(stage::capture);
+    record(r, { stage::vertical }, 4);
+    r.begin(stage::composite);
+    r.next_frame();
+    r.source().finish_all();
+    for (int index = 0; index < 6; index++) CHECK(r.source().issued[0][index]);
+
+    blur::stats::frame_timing timing;
+    std::vector<blur::stats::gpu_range> ranges;
+    REQUIRE(r.collect(timing, &ranges));
+    CHECK_EQ(timing.runs[static_cast<int>(stage::capture)], 0);
+    CHECK_EQ(timing.runs[static_cast<int>(stage::composite)], 0);
+    CHECK_EQ(timing.stage_ms[static_cast<int>(stage::vertical)], 4.0);
+    CHECK_EQ(timing.total_ms, 4.0);
+    REQUIRE(ranges.size() == 1);
+    CHECK_EQ(ranges[0].begin_ms, 0.0);
+
+    // Ending one twice, or after its frame, changes nothing.
+    int pair = r.begin(stage::capture);
+    r.end(pair);
+    uint64_t clock = r.source().clock;
+    r.end(pair);
+    r.next_frame();
+    r.end(pair);
+    CHECK_EQ(r.source().clock, clock);
+}
+
+TEST(reset_forgets_pending_frames) {
+    ring r;
+    record(r, { stage::capture });
+    r.next_frame();
+    r.reset();
+    r.source().finish_all();
+    blur::stats::frame_timing timing;
+    CHECK(!r.collect(timing));
+    CHECK_EQ(r.source().reads, 0);
+}
+
+TEST(rolling_window_summary_after_wrapping) {
+    blur::stats::rolling_window window(200);
+    CHECK_EQ(window.summarize().samples, 0);
+
+    // 1..300: the window keeps 101..300.
+    for (int i = 1; i <= 300; i++) window.add(i);
+    blur::stats::summary s = window.summarize();
+    CHECK_EQ(s.samples, 200);
+    CHECK_EQ(s.last_ms, 300.0);
+    CHECK_EQ(s.min_ms, 101.0);
+    CHECK_EQ(s.avg_ms, 200.5);
+    // Nearest rank: ceil(0.99 * 200) = 198th smallest.
+    CHECK_EQ(s.p99_ms, 298.0);
+
+    blur::stats::rolling_window single(1);
+    single.add(5.0);
+    single.add(7.0);
+    CHECK_EQ(single.summarize().p99_ms, 7.0);
+}
+
+TEST(gpu_timings_skip_stages_that_did_not_run) {
+    blur::stats::gpu_timings timings;
+    blur::stats::frame_timing frame;
+    frame.stage_ms[static_cast<int>(stage::capture)] = 1.0;
+    frame.runs[static_cast<int>(stage::capture)] = 1;
+    frame.total_ms = 1.0;
+    timings.add(frame);
+    frame.runs[static_cast<int>(stage::capture)] = 0;
+    frame.stage_ms[static_cast<int>(stage::capture)] = 0.0;
+    frame.total_ms = 0.5;
+    timings.add(frame);
+
+    CHECK_EQ(timings.frames(), uint64_t(2));
+    CHECK_EQ(timings.stage_summary(stage::capture).samples, 1);
+    CHECK_EQ(timings.stage_summary(stage::capture).avg_ms, 1.0);
+    CHECK_EQ(timings.total().avg_ms, 0.75);
+}
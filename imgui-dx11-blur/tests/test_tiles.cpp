@@ -0,0 +1,241 @@
+#include "check.hpp"
+
+#include "blur_tiles.hpp"
+
+#include <random>
+
+namespace {
+
+    bool covers(const blur::atlas_rect& outer, const blur::atlas_rect& inner) {
+        return outer.x <= inner.x && outer.y <= inner.y && outer.x + outer.width >= inner.x + inner.width &&
+            outer.y + outer.height >= inner.y + inner.height;
+    }
+
+    bool inside(const blur::atlas_rect& rect, int width, int height) {
+        return rect.x >= 0 && rect.y >= 0 && rect.x + rect.width <= width && rect.y + rect.height <= height;
+    }
+
+    bool covered(const blur::atlas_rect* rects, int count, const blur::atlas_rect& tile) {
+        for (int i = 0; i < count; i++) {
+            if (covers(rects[i], tile)) return true;
+        }
+        return false;
+    }
+
+    // A grid of tiles that each hash one triangle inside themselves, so changing a value dirties exactly that tile.
+    struct tile_grid {
+        blur::tile_tracker tracker;
+        std::vector<uint64_t> values;
+
+        tile_grid(int width, int height, int tile_size) {
+            tracker.reset(width, height, tile_size);
+            values.assign(static_cast<size_t>(tracker.tiles_x()) * tracker.tiles_y(), 1);
+        }
+
+        int finish(int apron, blur::atlas_rect* rects, int max_count) {
+            int size = tracker.tile_size();
+            tracker.begin(0);
+            for (int ty = 0; ty < tracker.tiles_y(); ty++) {
+                for (int tx = 0; tx < tracker.tiles_x(); tx++) {
+                    float x = static_cast<float>(tx * size), y = static_cast<float>(ty * size);
+                    tracker.add_triangle(x + 1.0f, y + 1.0f, x + 2.0f, y + 2.0f, values[static_cast<size_t>(ty) * tracker.tiles_x() + tx]);
+                }
+            }
+            return tracker.finish(apron, rects, max_count);
+        }
+
+        blur::atlas_rect tile(int tx, int ty) const {
+            int size = tracker.tile_size();
+            return { tx * size, ty * size, std::min(size, tracker.width() - tx * size), std::min(size, tracker.height() - ty * size) };
+        }
+    };
+
+    // Just the members tile_tracker::add_draw_commands reads.
+    struct vec2 {
+        float x, y;
+    };
+
+    struct vec4 {
+        float x, y, z, w;
+    };
+
+    struct vertex {
+        vec2 pos;
+    };
+
+    struct draw_command {
+        vec4 ClipRect;
+        void* TextureId;
+        unsigned VtxOffset;
+        unsigned IdxOffset;
+        unsigned ElemCount;
+        void (*UserCallback)();
+    };
+
+    template <typename T>
+    struct buffer {
+        int Size;
+        const T* Data;
+    };
+
+    struct draw_list {
+        buffer<draw_command> CmdBuffer;
+        buffer<uint16_t> IdxBuffer;
+        buffer<vertex> VtxBuffer;
+    };
+
+}
+
+TEST(expand_rect_grows_by_apron_and_clamps_at_the_edge) {
+    blur::atlas_rect r = blur::expand_rect({ 100, 80, 32, 32 }, 10, 400, 300);
+    CHECK(r.x == 90 && r.y == 70 && r.width == 52 && r.height == 52);
+
+    r = blur::expand_rect({ 0, 5, 32, 32 }, 10, 400, 300);
+    CHECK(r.x == 0 && r.y == 0 && r.width == 42 && r.height == 47);
+
+    r = blur::expand_rect({ 380, 280, 20, 20 }, 10, 400, 300);
+    CHECK(r.x == 370 && r.y == 270 && r.width == 30 && r.height == 30);
+
+    r = blur::expand_rect({ 500, 10, 10, 10 }, 4, 400, 300);
+    CHECK_EQ(r.width, 0);
+}
+
+TEST(merge_rects_joins_touching_rects) {
+    // A chain where each rect touches only the next, so the first union has to reach the last.
+    blur::atlas_rect rects[] = { { 0, 0, 10, 10 }, { 100, 0, 10, 10 }, { 10, 0, 10, 10 }, { 20, 10, 80, 5 } };
+    CHECK_EQ(blur::merge_rects(rects, 4, 4), 1);
+    CHECK(rects[0].x == 0 && rects[0].y == 0 && rects[0].width == 110 && rects[0].height == 15);
+
+    blur::atlas_rect apart[] = { { 0, 0, 10, 10 }, { 11, 0, 10, 10 } };
+    CHECK_EQ(blur::merge_rects(apart, 2, 4), 2);
+}
+
+TEST(merge_rects_down_to_max_count_covers_every_input) {
+    std::mt19937 rng(9);
+    for (int round = 0; round < 200; round++) {
+        blur::atlas_rect rects[16], input[16];
+        int count = 1 + static_cast<int>(rng() % 16);
+        for (int i = 0; i < count; i++) {
+            rects[i] = input[i] = { static_cast<int>(rng() % 1000), static_cast<int>(rng() % 1000), 1 + static_cast<int>(rng() % 60),
+                1 + static_cast<int>(rng() % 60) };
+        }
+        int max_count = 1 + static_cast<int>(rng() % 4);
+        int merged = blur::merge_rects(rects, count, max_count);
+        CHECK(merged >= 1 && merged <= std::min(count, max_count));
+        for (int i = 0; i < count; i++) CHECK(covered(rects, merged, input[i]));
+    }
+}
+
+TEST(finish_reports_everything_first_and_nothing_when_unchanged) {
+    tile_grid grid(200, 100, 32);
+    blur::atlas_rect rects[blur::max_dirty_rects];
+    REQUIRE(grid.finish(8, rects, blur::max_dirty_rects) == 1);
+    CHECK(rects[0].x == 0 && rects[0].y == 0 && rects[0].width == 200 && rects[0].height == 100);
+    CHECK_EQ(grid.tracker.dirty_tiles(), 7 * 4);
+
+    CHECK_EQ(grid.finish(8, rects, blur::max_dirty_rects), 0);
+    CHECK_EQ(grid.tracker.dirty_tiles(), 0);
+
+    grid.tracker.invalidate();
+    CHECK_EQ(grid.finish(8, rects, blur::max_dirty_rects), 1);
+}
+
+TEST(one_dirty_tile_grows_by_the_apron) {
+    tile_grid grid(320, 320, 32);
+    blur::atlas_rect rects[blur::max_dirty_rects];
+    grid.finish(8, rects, blur::max_dirty_rects);
+
+    grid.values[3 * 10 + 4]++;
+    REQUIRE(grid.finish(8, rects, blur::max_dirty_rects) == 1);
+    CHECK_EQ(grid.tracker.dirty_tiles(), 1);
+    CHECK(rects[0].x == 4 * 32 - 8 && rects[0].y == 3 * 32 - 8 && rects[0].width == 48 && rects[0].height == 48);
+
+    // The corner tiles' aprons stop at the region, including the partial tiles of a size that is not a multiple.
+    tile_grid odd(300, 210, 32);
+    odd.finish(8, rects, blur::max_dirty_rects);
+    odd.values.front()++;
+    odd.values.back()++;
+    REQUIRE(odd.finish(8, rects, blur::max_dirty_rects) == 2);
+    for (int i = 0; i < 2; i++) CHECK(inside(rects[i], 300, 210));
+    CHECK(covered(rects, 2, { 0, 0, 40, 40 }));
+    CHECK(covered(rects, 2, { 9 * 32 - 8, 6 * 32 - 8, 300 - (9 * 32 - 8), 210 - (6 * 32 - 8) }));
+}
+
+TEST(runs_stack_into_one_rect) {
+    tile_grid grid(320, 320, 32);
+    blur::atlas_rect rects[blur::max_dirty_rects];
+    grid.finish(0, rects, blur::max_dirty_rects);
+
+    for (int ty = 2; ty < 6; ty++) {
+        for (int tx = 1; tx < 4; tx++) grid.values[ty * 10 + tx]++;
+    }
+    REQUIRE(grid.finish(0, rects, blur::max_dirty_rects) == 1);
+    CHECK_EQ(grid.tracker.dirty_tiles(), 12);
+    CHECK(rects[0].x == 32 && rects[0].y == 64 && rects[0].width == 96 && rects[0].height == 128);
+}
+
+// Random dirty patterns: at most max_count rects, inside the region, covering every dirty tile grown by the apron.
+TEST(dirty_rects_cover_every_dirty_tile) {
+    std::mt19937 rng(4);
+    tile_grid grid(1000, 700, 32);
+    blur::atlas_rect rects[blur::max_dirty_rects];
+    grid.finish(12, rects, blur::max_dirty_rects);
+
+    for (int round = 0; round < 300; round++) {
+        std::vector<size_t> dirty;
+        int changes = 1 + static_cast<int>(rng() % 40);
+        for (int i = 0; i < changes; i++) {
+            size_t index = rng() % grid.values.size();
+            if (round % 3 == 0) index = std::min(index, grid.values.size() - 1 - rng() % 4);
+            grid.values[index]++;
+            dirty.push_back(index);
+        }
+
+        int count = grid.finish(12, rects, blur::max_dirty_rects);
+        CHECK(count >= 1 && count <= blur::max_dirty_rects);
+        for (int i = 0; i < count; i++) CHECK(inside(rects[i], 1000, 700));
+        for (size_t index : dirty) {
+            int tx = static_cast<int>(index % grid.tracker.tiles_x()), ty = static_cast<int>(index / grid.tracker.tiles_x());
+            blur::atlas_rect tile = blur::expand_rect(grid.tile(tx, ty), 12, 1000, 700);
+            if (!CHECK(covered(rects, count, tile))) std::fprintf(stderr, "  round %d, tile %d,%d\n", round, tx, ty);
+        }
+    }
+}
+
+// A moved triangle dirties the tiles under its old and new bounds; whatever its clip rect hides dirties nothing.
+TEST(draw_commands_dirty_old_and_new_bounds) {
+    vertex vertices[3] = { { { 110.0f, 110.0f } }, { { 120.0f, 110.0f } }, { { 110.0f, 120.0f } } };
+    uint16_t indices[3] = { 0, 1, 2 };
+    draw_command cmd = { { 100.0f, 100.0f, 420.0f, 420.0f }, nullptr, 0, 0, 3, nullptr };
+    draw_list list = { { 1, &cmd }, { 3, indices }, { 3, vertices } };
+
+    blur::tile_tracker tracker;
+    tracker.reset(320, 320, 32);
+    blur::atlas_rect rects[blur::max_dirty_rects];
+    auto frame = [&] {
+        tracker.begin(0);
+        tracker.add_draw_commands(list, 1, 100.0f, 100.0f);
+        return tracker.finish(0, rects, blur::max_dirty_rects);
+    };
+    frame();
+    CHECK_EQ(frame(), 0);
+
+    for (vertex& v : vertices) v.pos.x += 200.0f;
+    REQUIRE(frame() == 2);
+    CHECK_EQ(tracker.dirty_tiles(), 2);
+    CHECK(covered(rects, 2, { 0, 0, 32, 32 }));
+    CHECK(covered(rects, 2, { 6 * 32, 0, 32, 32 }));
+
+    // Beyond the clip rect the same move changes nothing.
+    cmd.ClipRect.z = 250.0f;
+    frame();
+    for (vertex& v : vertices) v.pos.y += 40.0f;
+    CHECK_EQ(frame(), 0);
+
+    // Commands from cmd_end on are not hashed, so dropping the last one dirties its tiles.
+    cmd.ClipRect.z = 420.0f;
+    frame();
+    tracker.begin(0);
+    tracker.add_draw_commands(list, 0, 100.0f, 100.0f);
+    CHECK_EQ(tracker.finish(0, rects, blur::max_dirty_rects), 1);
+}
@@ -0,0 +1,72 @@
+#include "check.hpp"
+
+#include "blur_trace.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+    std::string read_file(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        std::stringstream text;
+        text << file.rdbuf();
+        return text.str();
+    }
+
+    size_t occurrences(const std::string& text, const std::string& pattern) {
+        size_t count = 0;
+        for (size_t at = text.find(pattern); at != std::string::npos; at = text.find(pattern, at + 1)) count++;
+        return count;
+    }
+
+    const std::string trace_path = "test_trace.json";
+
+}
+
+TEST(trace_is_balanced_per_thread) {
+    blur::trace::start();
+    {
+        BLUR_TRACE_SCOPE("outer");
+        BLUR_TRACE_SCOPE("quoted \"name\"");
+    }
+    std::thread([] { BLUR_TRACE_SCOPE("worker"); }).join();
+    {
+        BLUR_TRACE_SCOPE("open when stopped");
+        blur::trace::stop();
+        BLUR_TRACE_SCOPE("after stop");
+    }
+    blur::trace::start();
+    blur::trace::record_gpu("gpu", 1000, 5000);
+    REQUIRE(blur::trace::write_chrome_trace(trace_path));
+
+    std::string json = read_file(trace_path);
+    CHECK_EQ(occurrences(json, "\"ph\":\"B\""), size_t(4));
+    CHECK_EQ(occurrences(json, "\"ph\":\"E\""), size_t(4));
+    CHECK_EQ(occurrences(json, "\"ph\":\"X\""), size_t(1));
+    CHECK_EQ(occurrences(json, "quoted \\\"name\\\""), size_t(2));
+    CHECK_EQ(occurrences(json, "after stop"), size_t(0));
+    CHECK_EQ(occurrences(json, "\"tid\":2}"), size_t(2));
+
+    // A write clears what it wrote.
+    REQUIRE(blur::trace::write_chrome_trace(trace_path));
+    CHECK_EQ(occurrences(read_file(trace_path), "\"ph\":\"B\""), size_t(0));
+    blur::trace::stop();
+    std::remove(trace_path.c_str());
+}
+
+TEST(events_past_the_limit_are_dropped_and_counted_per_start) {
+    blur::trace::start(blur::trace::chunk_events);
+    for (size_t i = 0; i < blur::trace::chunk_events / 2 + 10; i++) {
+        BLUR_TRACE_SCOPE("event");
+    }
+    CHECK_EQ(blur::trace::dropped_events(), uint64_t(20));
+    REQUIRE(blur::trace::write_chrome_trace(trace_path));
+    CHECK_EQ(occurrences(read_file(trace_path), "\"ph\":\"E\""), blur::trace::chunk_events / 2);
+
+    blur::trace::start();
+    CHECK_EQ(blur::trace::dropped_events(), uint64_t(0));
+    blur::trace::stop();
+    std::remove(trace_path.c_str());
+}
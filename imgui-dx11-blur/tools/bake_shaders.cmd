@@ -0,0 +1,31 @@
+@echo off
+rem Windows counterpart of bake_shaders.sh, run by the project's custom build step on blur_shaders.hpp: compiles
+rem its HLSL to DXBC with fxc and writes imgui-dx11-blur\blur_shaders_bytecode.hpp. Needs cl and fxc on PATH, as
+rem they are inside a Visual Studio build. A shader fxc rejects fails the build, since D3DCompile would reject it too.
+setlocal
+
+set "tools_dir=%~dp0"
+set "project_dir=%tools_dir%..\imgui-dx11-blur"
+set "work_dir=%TEMP%\blur_bake_%RANDOM%%RANDOM%"
+mkdir "%work_dir%" || exit /b 1
+
+cl /nologo /EHsc /std:c++17 /O1 /Fo"%work_dir%\bake_shaders.obj" /Fe"%work_dir%\bake_shaders.exe" "%tools_dir%bake_shaders.cpp" >nul || goto fail
+"%work_dir%\bake_shaders.exe" dump "%work_dir%" || goto fail
+"%work_dir%\bake_shaders.exe" list > "%work_dir%\shaders.txt" || goto fail
+
+rem /Ges matches the D3DCOMPILE_ENABLE_STRICTNESS blur_renderer compiles with at runtime.
+for /f "usebackq tokens=1,2" %%a in ("%work_dir%\shaders.txt") do (
+    fxc /nologo /Ges /T %%b /E main /Fo "%work_dir%\%%a.dxbc" "%work_dir%\%%a.hlsl" >nul || (
+        echo bake_shaders.cmd: fxc failed on %%a ^(%%b^) 1>&2
+        goto fail
+    )
+)
+
+"%work_dir%\bake_shaders.exe" embed "%work_dir%" "%project_dir%\blur_shaders_bytecode.hpp" || goto fail
+echo bake_shaders.cmd: wrote %project_dir%\blur_shaders_bytecode.hpp
+rmdir /s /q "%work_dir%"
+exit /b 0
+
+:fail
+rmdir /s /q "%work_dir%"
+exit /b 1
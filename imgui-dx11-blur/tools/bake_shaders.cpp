@@ -0,0 +1,119 @@
+// Offline half of the shader pipeline, driven by bake_shaders.sh (vkd3d-shader) or bake_shaders.cmd (fxc):
+//   bake_shaders list                  prints "name target" for every shader_id
+//   bake_shaders dump <dir>            writes <dir>/<name>.hlsl
+//   bake_shaders embed <dir> <header>  validates <dir>/<name>.dxbc and writes blur_shaders_bytecode.hpp
+// Shaders without a .dxbc are emitted as empty entries and compiled at runtime by blur_renderer.
+
+#define BLUR_RUNTIME_SHADER_COMPILE
+#include "../imgui-dx11-blur/blur_shaders.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+    bool read_file(const std::string& path, std::vector<unsigned char>& data) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) return false;
+        data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return true;
+    }
+
+    bool write_file(const std::string& path, const std::string& text) {
+        std::ofstream file(path, std::ios::binary);
+        if (!file) return false;
+        file << text;
+        return static_cast<bool>(file);
+    }
+
+    // DXBC container: "DXBC", a 16 byte checksum, version 1 and the total size, then the chunk offsets.
+    bool valid_dxbc(const std::vector<unsigned char>& data) {
+        if (data.size() < 32 || std::memcmp(data.data(), "DXBC", 4) != 0) return false;
+
+        auto read_u32 = [&](size_t offset) {
+            return static_cast<uint32_t>(data[offset]) | static_cast<uint32_t>(data[offset + 1]) << 8 |
+                static_cast<uint32_t>(data[offset + 2]) << 16 | static_cast<uint32_t>(data[offset + 3]) << 24;
+        };
+
+        uint32_t chunk_count = read_u32(28);
+        return read_u32(20) == 1 && read_u32(24) == data.size() && 32 + static_cast<size_t>(chunk_count) * 4 <= data.size();
+    }
+
+    int list() {
+        for (const blur::shader_source& shader : blur::shader_sources) std::printf("%s %s\n", shader.name, shader.target);
+        return 0;
+    }
+
+    int dump(const std::string& dir) {
+        for (const blur::shader_source& shader : blur::shader_sources) {
+            if (!write_file(dir + "/" + shader.name + ".hlsl", shader.source)) {
+                std::fprintf(stderr, "bake_shaders: cannot write %s/%s.hlsl\n", dir.c_str(), shader.name);
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    int embed(const std::string& dir, const std::string& header) {
+        std::ostringstream out;
+        out << "// Generated by tools/bake_shaders from blur_shaders.hpp. Do not edit.\n";
+        out << "#ifndef BLUR_SHADERS_BYTECODE_HPP\n#define BLUR_SHADERS_BYTECODE_HPP\n\n";
+        out << "namespace blur {\nnamespace precompiled {\n\n";
+
+        char hash[32];
+        std::snprintf(hash, sizeof(hash), "0x%016llxull", static_cast<unsigned long long>(blur::hash_shader_sources()));
+        out << "    inline constexpr uint64_t source_hash = " << hash << ";\n\n";
+
+        std::vector<bool> present;
+        for (const blur::shader_source& shader : blur::shader_sources) {
+            std::vector<unsigned char> data;
+            if (!read_file(dir + "/" + shader.name + ".dxbc", data)) {
+                std::fprintf(stderr, "bake_shaders: no bytecode for %s, it will be compiled at runtime\n", shader.name);
+                present.push_back(false);
+                continue;
+            }
+            if (!valid_dxbc(data)) {
+                std::fprintf(stderr, "bake_shaders: %s/%s.dxbc is not a valid DXBC container\n", dir.c_str(), shader.name);
+                return 1;
+            }
+
+            out << "    inline constexpr unsigned char " << shader.name << "[] = {";
+            for (size_t i = 0; i < data.size(); i++) {
+                out << (i % 16 ? " " : "\n        ") << static_cast<int>(data[i]) << ",";
+            }
+            out << "\n    };\n\n";
+            present.push_back(true);
+        }
+
+        out << "    inline constexpr shader_bytecode bytecode[] = {\n";
+        for (size_t i = 0; i < present.size(); i++) {
+            const char* name = blur::shader_sources[i].name;
+            if (present[i]) out << "        { " << name << ", sizeof(" << name << ") },\n";
+            else out << "        {},\n";
+        }
+        out << "    };\n\n}\n}\n\n#endif\n";
+
+        if (!write_file(header, out.str())) {
+            std::fprintf(stderr, "bake_shaders: cannot write %s\n", header.c_str());
+            return 1;
+        }
+        return 0;
+    }
+
+}
+
+int main(int argc, char** argv) {
+    std::string command = argc > 1 ? argv[1] : "";
+
+    if (command == "list" && argc == 2) return list();
+    if (command == "dump" && argc == 3) return dump(argv[2]);
+    if (command == "embed" && argc == 4) return embed(argv[2], argv[3]);
+
+    std::fprintf(stderr, "usage: bake_shaders list | dump <dir> | embed <dir> <header>\n");
+    return 2;
+}
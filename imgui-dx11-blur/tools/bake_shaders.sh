@@ -0,0 +1,40 @@
+#!/bin/sh
+# Compiles the HLSL in blur_shaders.hpp to DXBC with vkd3d-shader and writes
+# imgui-dx11-blur/blur_shaders_bytecode.hpp, which blur_renderer embeds instead of calling D3DCompile.
+#
+#   CXX             host compiler for the bake tool (default: c++)
+#   VKD3D_COMPILER  vkd3d-shader's compiler binary (default: vkd3d-compiler)
+#
+# A shader vkd3d cannot compile is left out of the header and falls back to D3DCompile at runtime;
+# pass --strict to fail instead, e.g. in CI.
+set -eu
+
+tools_dir=$(cd "$(dirname "$0")" && pwd)
+project_dir="$tools_dir/../imgui-dx11-blur"
+cxx=${CXX:-c++}
+vkd3d=${VKD3D_COMPILER:-vkd3d-compiler}
+strict=0
+[ "${1:-}" = "--strict" ] && strict=1
+
+work_dir=$(mktemp -d)
+trap 'rm -rf "$work_dir"' EXIT
+
+"$cxx" -std=c++17 -O1 -o "$work_dir/bake_shaders" "$tools_dir/bake_shaders.cpp"
+"$work_dir/bake_shaders" dump "$work_dir"
+
+status=0
+"$work_dir/bake_shaders" list > "$work_dir/shaders.txt"
+while read -r name target; do
+    if ! "$vkd3d" -x hlsl -b dxbc-tpf -p "$target" -e main -o "$work_dir/$name.dxbc" "$work_dir/$name.hlsl"; then
+        echo "bake_shaders.sh: $vkd3d failed on $name ($target)" >&2
+        rm -f "$work_dir/$name.dxbc"
+        status=1
+    fi
+done < "$work_dir/shaders.txt"
+
+if [ "$strict" -eq 1 ] && [ "$status" -ne 0 ]; then
+    exit 1
+fi
+
+"$work_dir/bake_shaders" embed "$work_dir" "$project_dir/blur_shaders_bytecode.hpp"
+echo "bake_shaders.sh: wrote $project_dir/blur_shaders_bytecode.hpp"